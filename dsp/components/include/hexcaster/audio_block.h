@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+
+namespace hexcaster {
+
+/**
+ * AudioBlock: non-owning view of planar multichannel audio -- one
+ * contiguous float array per channel, each numSamples long.
+ *
+ *   float left[128], right[128];
+ *   AudioBlock block{ { left, right }, 2, 128 };
+ *   stage.processChannels(block);
+ *
+ * Planar rather than interleaved: every channel is still a plain mono
+ * buffer, so a stage can run its mono kernel over each plane, or load
+ * sample i of every channel into the lanes of one ChannelLanes vector
+ * (loadLanes()/storeLanes()).
+ */
+struct AudioBlock {
+    static constexpr int kMaxChannels = 8;
+
+    float* channels[kMaxChannels] = {};
+    int    numChannels = 0;
+    int    numSamples  = 0;
+
+    /** One-channel view of a mono buffer. */
+    static AudioBlock mono(float* buffer, int numSamples)
+    {
+        AudioBlock block;
+        block.channels[0] = buffer;
+        block.numChannels = 1;
+        block.numSamples  = numSamples;
+        return block;
+    }
+
+    /** Samples [offset, offset + n) of every channel. */
+    AudioBlock slice(int offset, int n) const
+    {
+        AudioBlock block = *this;
+        for (int c = 0; c < numChannels; ++c) block.channels[c] += offset;
+        block.numSamples = n;
+        return block;
+    }
+};
+
+/**
+ * One channel per lane (GCC/Clang vector extension -- SSE/AVX or NEON).
+ * ChannelLanes<4> is a single 128-bit register; <8> covers kMaxChannels.
+ * ChannelMask<N> is what comparing two ChannelLanes<N> yields (-1 / 0).
+ */
+template <int N>
+struct ChannelVector {
+    // A member typedef: GCC drops vector_size on a dependent alias template.
+    typedef float Lanes __attribute__((vector_size(N * sizeof(float))));
+    typedef int   Mask  __attribute__((vector_size(N * sizeof(int))));
+};
+
+template <int N>
+using ChannelLanes = typename ChannelVector<N>::Lanes;
+
+template <int N>
+using ChannelMask = typename ChannelVector<N>::Mask;
+
+/**
+ * Transpose samples [offset, offset + n) of block into lanes: out[j][c] =
+ * channel c, sample offset + j. Lanes past numChannels are zero.
+ */
+template <int N>
+inline void loadLanes(const AudioBlock& block, int offset, int n, ChannelLanes<N>* out)
+{
+    for (int j = 0; j < n; ++j) out[j] = ChannelLanes<N>{};
+    const int channels = std::min(block.numChannels, N);
+    for (int c = 0; c < channels; ++c) {
+        const float* src = block.channels[c] + offset;
+        for (int j = 0; j < n; ++j) out[j][c] = src[j];
+    }
+}
+
+/** Inverse of loadLanes(): lanes past numChannels are dropped. */
+template <int N>
+inline void storeLanes(const ChannelLanes<N>* in, int offset, int n, const AudioBlock& block)
+{
+    const int channels = std::min(block.numChannels, N);
+    for (int c = 0; c < channels; ++c) {
+        float* dst = block.channels[c] + offset;
+        for (int j = 0; j < n; ++j) dst[j] = in[j][c];
+    }
+}
+
+} // namespace hexcaster
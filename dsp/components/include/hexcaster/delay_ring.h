@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+namespace hexcaster {
+
+/**
+ * DelayRing: fixed delay of whole frames (width floats each), for lookahead.
+ *
+ * The ring holds the last delay() input frames, oldest at pos_. process()
+ * swaps a run of n frames for the frames delay() earlier: the first
+ * k = min(n, delay()) outputs come from the ring, the rest are the run's
+ * own first n - k inputs, and its last k inputs take the ring slots just
+ * read. Everything moves with block memcpy (at most two spans per side),
+ * never per-sample modulo.
+ *
+ * Used by NoiseGate's and EnvelopeFollower's lookahead.
+ *
+ * Real-time safety:
+ *   process() and reset() are RT-safe. prepare() allocates and is not.
+ */
+class DelayRing {
+public:
+    /** Size for a delay of delayFrames frames of up to maxWidth floats. */
+    void prepare(int delayFrames, int maxWidth);
+
+    /** Fill the ring with silence. */
+    void reset();
+
+    int delay() const { return delay_; }
+
+    /**
+     * Delay frames[0 .. n) in place. width (<= maxWidth) must stay the same
+     * between resets; scratch holds n * width floats. No-op without delay.
+     */
+    void process(float* frames, int n, int width, float* scratch);
+
+private:
+    std::vector<float> ring_;
+    int                delay_ = 0;
+    int                pos_   = 0;   // oldest frame
+};
+
+} // namespace hexcaster
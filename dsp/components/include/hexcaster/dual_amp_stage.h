@@ -0,0 +1,118 @@
+#pragma once
+
+#include "hexcaster/processor_stage.h"
+#include "hexcaster/param_smoother.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace hexcaster {
+
+class NamStage;
+
+/**
+ * DualAmpStage: runs two NamStages on the same input and blends them.
+ *
+ *   out = (1 - mix) * ampA(in) + mix * ampB(in)
+ *
+ * Amp B runs on a dedicated worker thread, so on a multi-core machine the
+ * audio thread's critical path stays one model long: it hands the block to
+ * the worker, runs amp A itself, then waits for B and mixes.
+ *
+ * Like Pipeline, the stage does not own the amps -- the host does, and
+ * loads/selects their models directly (loadModel(), selectBankModel()).
+ * The amps must not also be added to a Pipeline.
+ *
+ * Per-block barrier:
+ *   Two sequence counters. The audio thread copies the input into B's
+ *   buffer and bumps blockSeq_; the worker runs B and stores the same
+ *   sequence number into doneSeq_. Each side spins for a bounded number of
+ *   iterations before falling back to a futex wait (std::atomic::wait), so
+ *   a worker that is already spinning picks the block up within
+ *   nanoseconds, while an idle one (audio stopped) costs no CPU.
+ *
+ * Mix:
+ *   Linear blend, smoothed per sample. mix 0 = amp A only, 1 = amp B only.
+ *   Both amps always run, so moving the mix never exposes a cold model.
+ *
+ * Real-time safety:
+ *   - process() is RT-safe: no allocation, no locks. It may block in
+ *     a futex wait for amp B, bounded by B's inference time.
+ *   - prepare() starts the worker (not RT-safe) and must not run
+ *     concurrently with process().
+ *   - setMix() may be called from any thread.
+ *
+ * Usage:
+ *   NamStage a, b;
+ *   DualAmpStage dual(a, b);
+ *   dual.setWorkerCpu(2);              // optional
+ *   dual.prepare(48000.f, 128);
+ *   a.loadModel("plexi.nam");
+ *   b.loadModel("recto.nam");
+ *   dual.setMix(0.5f);
+ *   // audio thread:
+ *   dual.process(buffer, numSamples);
+ */
+class DualAmpStage : public ProcessorStage {
+public:
+    DualAmpStage(NamStage& ampA, NamStage& ampB);
+    ~DualAmpStage() override;
+
+    DualAmpStage(const DualAmpStage&)            = delete;
+    DualAmpStage& operator=(const DualAmpStage&) = delete;
+
+    void prepare(float sampleRate, int maxBlockSize) override;
+    void process(float* buffer, int numSamples) override;
+    void reset() override;
+
+    /**
+     * Blend between amp A (0) and amp B (1). Clamped to [0, 1].
+     * Thread-safe: may be called from control thread.
+     */
+    void  setMix(float mix);
+    float getMix() const;
+
+    /**
+     * CPU to pin the amp B worker to, or -1 (default) to leave it to the
+     * scheduler. Call before prepare(); takes effect when the worker starts.
+     */
+    void setWorkerCpu(int cpu) { workerCpu_ = cpu; }
+
+    /**
+     * SCHED_FIFO priority for the worker, or 0 to keep the default policy.
+     * Default matches the ALSA audio thread. Call before prepare().
+     */
+    void setWorkerPriority(int priority) { workerPriority_ = priority; }
+
+    /** True once prepare() has started the worker thread. */
+    bool workerRunning() const { return worker_.joinable(); }
+
+    static constexpr int kDefaultWorkerPriority = 70;
+
+private:
+    NamStage& ampA_;
+    NamStage& ampB_;
+
+    std::atomic<float> targetMix_{ 0.5f };
+    ParamSmoother      mixSmoother_;
+
+    // Pre-allocated in prepare(): amp B's in-place buffer.
+    std::vector<float> bufferB_;
+
+    // --- Barrier (audio thread <-> worker) ---
+    alignas(64) std::atomic<uint32_t> blockSeq_{ 0 };  // audio -> worker
+    alignas(64) std::atomic<uint32_t> doneSeq_{ 0 };   // worker -> audio
+    int                               blockSamples_ = 0;  // published by blockSeq_
+    std::atomic<bool>                 stopWorker_{ false };
+
+    std::thread worker_;
+    int         workerCpu_      = -1;
+    int         workerPriority_ = kDefaultWorkerPriority;
+
+    void startWorker();
+    void stopWorkerThread();
+    void workerLoop(uint32_t seen);
+};
+
+} // namespace hexcaster
@@ -1,6 +1,10 @@
 #pragma once
 
-#include "hexcaster/processor_stage.h"
+#include "hexcaster/delay_ring.h"
+#include "hexcaster/eq.h"
+
+#include <cstdint>
+#include <vector>
 
 namespace hexcaster {
 
@@ -18,10 +22,36 @@ namespace hexcaster {
  * NOT a ProcessorStage (does not modify the audio buffer in-place).
  * Called by BloomController prior to the pipeline's stage chain.
  *
- * Implementation: to be added in Phase 1.
+ * Implementation -- block-oriented detector:
+ *   Detector filters: each biquad runs kFilterLanes samples at a time in
+ *   state-space form. The kFilterLanes outputs are a fixed linear map of
+ *   the kFilterLanes inputs plus the two state values (matrices derived
+ *   from the coefficients in prepare()), so a chunk is a handful of
+ *   independent multiply-adds the compiler vectorizes instead of a serial
+ *   DF2T recurrence. The remainder of a block runs the scalar recurrence.
+ *
+ *   Level detection: the filtered signal is reduced kDetectChunk samples at
+ *   a time -- vector max of |x| (Peak) or vector sum of x^2 (Rms, averaged
+ *   over a 10 ms window before the square root) -- and the attack/release
+ *   ballistics run once per chunk on the result.
+ *
+ *   Output: process() returns the envelope at the end of the block. If an
+ *   envelope buffer is passed it is filled per sample, interpolated
+ *   linearly between chunk values.
+ *
+ * Lookahead:
+ *   With lookaheadMs > 0 the envelope is meant to lead the audio it acts
+ *   on: the caller runs delayAudio() on that audio path, which delays it
+ *   by latencySamples() through a DelayRing allocated in prepare().
+ *
+ * Real-time safety:
+ *   process(), delayAudio() and reset() are RT-safe: no allocation, no
+ *   transcendental calls. prepare() allocates and is not.
  */
 class EnvelopeFollower {
 public:
+    enum class Detector : uint8_t { Peak, Rms };
+
     struct Config {
         float attackMs       = 5.f;
         float releaseMs      = 100.f;
@@ -29,8 +59,12 @@ public:
         float lpfCutoffHz    = 6000.f;
         bool  enableLpf      = false;
         int   lookaheadMs    = 0;   // 0 = disabled
+        Detector detector    = Detector::Peak;
     };
 
+    static constexpr int kFilterLanes = 8;    // samples per state-space step
+    static constexpr int kDetectChunk = 16;   // samples per ballistics step
+
     EnvelopeFollower() = default;
 
     void prepare(float sampleRate, int maxBlockSize, const Config& config);
@@ -38,13 +72,73 @@ public:
     /**
      * Analyse a block of audio and return the current envelope value [0,1].
      * Does NOT modify the input buffer.
+     * If envelopeOut is non-null it receives numSamples per-sample values.
      * Real-time safe.
      */
-    float process(const float* buffer, int numSamples);
+    float process(const float* buffer, int numSamples, float* envelopeOut = nullptr);
 
     void reset();
 
-    // Not yet implemented
+    /**
+     * Change attack/release after prepare(). No allocation; recomputes the
+     * ballistics tables (2 * kDetectChunk exp calls), so call only when a
+     * value actually changed. Audio thread.
+     */
+    void setBallistics(float attackMs, float releaseMs);
+
+    /** Envelope value after the last process() call. */
+    float value() const { return envelope_; }
+
+    /** Delay delayAudio() applies (lookahead), in samples. */
+    int latencySamples() const { return lookaheadSamples_; }
+
+    /**
+     * Delay an audio block in place by latencySamples() so the envelope
+     * leads it. No-op without lookahead. Real-time safe.
+     */
+    void delayAudio(float* buffer, int numSamples);
+
+    /**
+     * One biquad evaluated kFilterLanes samples per step (see class
+     * comment): the detector's filters. Public so it can be checked against
+     * a plain DF2T.
+     */
+    struct BlockBiquad {
+        static constexpr int N = kFilterLanes;
+
+        BiquadCoeffs c;
+        float h[N][N]  = {};   // x[k] -> y[j]  (lower triangular)
+        float p[2][N]  = {};   // state m -> y[j]
+        float sx[2][N] = {};   // x[k] -> next state m
+        float ss[2][2] = {};   // state m' -> next state m
+        float z1 = 0.f, z2 = 0.f;
+
+        void design(const BiquadCoeffs& coeffs);
+
+        /** Filter in[0 .. n) into out (may alias), carrying z1/z2 across calls. */
+        void run(const float* in, float* out, int n);
+    };
+
+private:
+    Config config_;
+    float  sampleRate_ = 48000.f;
+
+    BlockBiquad hpf_;
+    BlockBiquad lpf_;
+
+    // Ballistics per detection chunk; index = chunk length - 1
+    float attackCoeff_[kDetectChunk]  = {};
+    float releaseCoeff_[kDetectChunk] = {};
+    float rmsCoeff_[kDetectChunk]     = {};
+
+    float envelope_ = 0.f;
+    float power_    = 0.f;   // Detector::Rms: averaged mean square
+
+    // Pre-allocated in prepare()
+    std::vector<float> detector_;    // filtered detection signal, one block
+    DelayRing          delay_;       // lookahead
+    std::vector<float> delayOut_;    // delayAudio() scratch, one block
+    int                lookaheadSamples_ = 0;
 };
 
 } // namespace hexcaster
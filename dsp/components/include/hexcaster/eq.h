@@ -1,11 +1,36 @@
 #pragma once
 
 #include "hexcaster/processor_stage.h"
+#include "hexcaster/param_smoother.h"
 
 #include <atomic>
+#include <cstdint>
 
 namespace hexcaster {
 
+/** Biquad response shapes (Audio EQ Cookbook). Off is an identity filter. */
+enum class BiquadType : uint8_t {
+    Off,
+    Peak,
+    LowShelf,
+    HighShelf,
+    LowPass,
+    HighPass,
+};
+
+/** Normalised biquad coefficients (a0 = 1). Default is identity. */
+struct BiquadCoeffs {
+    float b0 = 1.f, b1 = 0.f, b2 = 0.f;
+    float           a1 = 0.f, a2 = 0.f;
+};
+
+/**
+ * Audio EQ Cookbook coefficients. gainDb is ignored by the pass filters.
+ * Not for per-sample use (pow/cos/sin); call once per parameter change.
+ */
+BiquadCoeffs designBiquad(BiquadType type, float sampleRate,
+                          float freqHz, float gainDb, float q);
+
 /**
  * MidSweepEQ: single-band biquad peaking (bell) filter for post-NAM tone shaping.
  *
@@ -20,22 +45,66 @@ namespace hexcaster {
  * Implementation:
  *   Biquad Direct Form II Transposed (DF2T) -- numerically stable, two delay elements.
  *   Coefficients use the Audio EQ Cookbook peaking filter formulas.
- *   Coefficients are recomputed once per block only when a parameter has changed,
- *   avoiding redundant transcendental function calls during steady-state playback.
  *   At 0 dB gain the filter collapses to unity (A=1, alpha terms cancel) -- no
  *   separate bypass path needed.
  *
+ * Sweeps (expression pedal on EqSweepHz):
+ *   The transcendental parts of the design -- cos(w0)/sin(w0) over the sweep
+ *   range and A = 10^(dB/40) over the gain range -- are tabulated in
+ *   prepare() and linearly interpolated, so a coefficient update is a few
+ *   multiplies and one divide. Parameter changes are smoothed at control
+ *   rate (one step per kCoeffInterval samples), and within each interval
+ *   the coefficients are interpolated per sample toward the next set, so
+ *   a sweep is continuous rather than a staircase of coefficient jumps.
+ *   Once every parameter has settled the block runs with fixed coefficients.
+ *
+ * Multichannel (processChannels(), up to AudioBlock::kMaxChannels):
+ *   One set of coefficients, one filter state per channel. The channels
+ *   are the lanes of one vector (ChannelLanes: 4 lanes up to four channels,
+ *   8 beyond), so the recurrence -- serial in time -- runs once for all of
+ *   them, and a sweep designs its coefficients once rather than per
+ *   channel. The block is transposed into lanes kLaneChunk samples at a
+ *   time.
+ *
  * Real-time safety:
- *   process() is RT-safe: no allocation, no I/O.
+ *   process() is RT-safe: no allocation, no I/O, no transcendental calls.
  *   Parameter atomics are read at the top of each block, not per-sample.
  */
 class MidSweepEQ : public ProcessorStage {
 public:
+    // Parameter ranges (match ParamRegistry's EqGain_dB / EqSweepHz / EqQ).
+    static constexpr float kMinGainDb  = -12.f;
+    static constexpr float kMaxGainDb  =  12.f;
+    static constexpr float kMinSweepHz = 300.f;
+    static constexpr float kMaxSweepHz = 2500.f;
+    static constexpr float kMinQ       = 0.3f;
+    static constexpr float kMaxQ       = 3.f;
+
+    static constexpr int   kSweepTableSize = 256;  // intervals over the sweep range (~8.6 Hz)
+    static constexpr int   kGainTableSize  = 96;   // intervals over the gain range (0.25 dB)
+    static constexpr int   kCoeffInterval  = 16;   // samples per control-rate step
+    static constexpr float kSmoothingMs    = 20.f;
+
     MidSweepEQ() = default;
 
     void prepare(float sampleRate, int maxBlockSize) override;
     void process(float* buffer, int numSamples) override;
     void reset() override;
+    int  maxChannels() const override { return AudioBlock::kMaxChannels; }
+    void processChannels(const AudioBlock& block) override;
+
+    static constexpr int kLaneChunk = 64;   // samples per transposition (multiple of kCoeffInterval)
+
+    /**
+     * Flat: gain settled at 0 dB (the bell is unity whatever the sweep and
+     * Q) and the filter memory rung down below kIdentityStateEpsilon.
+     */
+    bool isIdentity() const override;
+
+    static constexpr float kIdentityStateEpsilon = 1e-6f;   // -120 dBFS
+
+    /** process() with outputGain applied in the same pass (StaticPipeline). */
+    void process(float* buffer, int numSamples, const OutputGain& outputGain);
 
     // Control thread setters (atomic -- safe to call any time)
     void setGainDb (float db);   // clamped to [-12, +12]
@@ -47,7 +116,19 @@ public:
     float getQ()       const;
 
 private:
-    void updateCoefficients();
+    // Peaking coefficients from the tables. Audio thread, RT-safe.
+    BiquadCoeffs designFromTables(float gainDb, float sweepHz, float q) const;
+
+    // Load the parameter atomics into the smoothers. Once per block.
+    void readTargets();
+
+    // Step the coefficients over numSamples (sweeping or settled) and call
+    // kernel(i, coeffs) for each sample i; the kernel owns the filter state.
+    template <typename Kernel>
+    void runFiltered(int numSamples, Kernel&& kernel);
+
+    template <int N>
+    void processLanes(const AudioBlock& block);
 
     // --- Atomic parameters (control thread) ---
     std::atomic<float> gainDb_ {  0.f   };
@@ -57,17 +138,187 @@ private:
     // --- Audio thread state ---
     float sampleRate_ = 48000.f;
 
-    // Biquad coefficients (normalised, a0 = 1)
-    float b0_ = 1.f, b1_ = 0.f, b2_ = 0.f;
-    float      a1_ = 0.f, a2_ = 0.f;
+    // Control-rate parameter smoothing (prepared at sampleRate / kCoeffInterval)
+    ParamSmoother gainSmoother_;
+    ParamSmoother sweepSmoother_;
+    ParamSmoother qSmoother_;
+
+    // Biquad coefficients (normalised, a0 = 1) currently in effect
+    BiquadCoeffs c_;
 
     // DF2T delay elements
     float z1_ = 0.f, z2_ = 0.f;
 
-    // Cached param values for change detection (avoid redundant coefficient recompute)
-    float cachedGainDb_  = 0.f;
-    float cachedSweepHz_ = 0.f;
-    float cachedQ_       = 0.f;
+    // Per-channel DF2T delay elements (processChannels())
+    float chZ1_[AudioBlock::kMaxChannels] = {};
+    float chZ2_[AudioBlock::kMaxChannels] = {};
+
+    // Design tables, filled in prepare() (sample-rate dependent)
+    float cosTable_[kSweepTableSize + 1] = {};
+    float sinTable_[kSweepTableSize + 1] = {};
+    float ampTable_[kGainTableSize + 1]  = {};
+};
+
+/**
+ * ParametricEQ: up to kMaxBands biquads in series, as one stage.
+ *
+ * Each band is independently Off, Peak, LowShelf, HighShelf, LowPass or
+ * HighPass with its own frequency, gain and Q. A chain of tone filters
+ * costs one virtual call and one pass over the buffer instead of one per
+ * filter (and one Pipeline slot of kMaxStages each).
+ *
+ * Implementation -- skewed cascade:
+ *   A cascade is serial per sample (band k needs band k-1's output), so
+ *   the bands are run as a wavefront instead: at step t, band k filters
+ *   sample t - k, taking as input what band k-1 produced on the previous
+ *   step. All bands then advance together as one kMaxBands-wide vector
+ *   (DF2T per lane, GCC vector extension -- SSE/AVX or NEON). Only the
+ *   first and last (bands - 1) steps of a block are partial; those mask
+ *   the state update per lane. The output is identical to the serial
+ *   cascade and there is no added latency.
+ *
+ *   Only bands up to the last non-Off one are part of the wavefront; with
+ *   every band Off, process() returns immediately.
+ *
+ * Real-time safety:
+ *   process() is RT-safe: no allocation, no I/O.
+ *   Band parameters are atomics read once per block; coefficients are only
+ *   recomputed for bands that changed.
+ *
+ * Usage:
+ *   ParametricEQ eq;
+ *   eq.setBand(0, BiquadType::HighPass, 80.f, 0.f, 0.707f);
+ *   eq.setBand(1, BiquadType::Peak, 800.f, 4.f, 1.f);
+ *   eq.setBand(2, BiquadType::LowPass, 6000.f, 0.f, 0.707f);
+ *   eq.prepare(48000.f, 128);
+ *   eq.process(buffer, 128);
+ */
+class ParametricEQ : public ProcessorStage {
+public:
+    static constexpr int kMaxBands = 8;
+
+    static constexpr float kMinFreqHz = 10.f;
+    static constexpr float kMinGainDb = -24.f;
+    static constexpr float kMaxGainDb =  24.f;
+    static constexpr float kMinQ      =  0.1f;
+    static constexpr float kMaxQ      = 10.f;
+
+    struct Band {
+        BiquadType type   = BiquadType::Off;
+        float      freqHz = 1000.f;
+        float      gainDb = 0.f;
+        float      q      = 0.707f;
+    };
+
+    ParametricEQ() = default;
+
+    void prepare(float sampleRate, int maxBlockSize) override;
+    void process(float* buffer, int numSamples) override;
+    void reset() override;
+
+    /**
+     * Every band Off. Off bands hold no state (it is zeroed when a band is
+     * switched off), so there is nothing left to ring down.
+     */
+    bool isIdentity() const override;
+
+    /**
+     * Configure one band (index in [0, kMaxBands)). Frequency is clamped to
+     * [kMinFreqHz, 0.49 * sampleRate] when coefficients are computed, gain
+     * and Q to their ranges here. Out-of-range indices are ignored.
+     * Thread-safe: may be called from control thread.
+     */
+    void setBand(int index, const Band& band);
+    void setBand(int index, BiquadType type, float freqHz, float gainDb, float q);
+
+    Band getBand(int index) const;
+
+private:
+    struct BandParams {
+        std::atomic<BiquadType> type  { BiquadType::Off };
+        std::atomic<float>      freqHz{ 1000.f };
+        std::atomic<float>      gainDb{ 0.f };
+        std::atomic<float>      q     { 0.707f };
+    };
+
+    void updateCoefficients(int index, const Band& band);
+
+    // --- Atomic parameters (control thread) ---
+    BandParams params_[kMaxBands];
+
+    // --- Audio thread state ---
+    float sampleRate_  = 48000.f;
+    int   activeBands_ = 0;          // last non-Off band + 1
+    Band  cached_[kMaxBands];
+    bool  cacheValid_  = false;
+
+    // Per-lane coefficients and DF2T state, lane k = band k.
+    alignas(32) float b0_[kMaxBands] = {};
+    alignas(32) float b1_[kMaxBands] = {};
+    alignas(32) float b2_[kMaxBands] = {};
+    alignas(32) float a1_[kMaxBands] = {};
+    alignas(32) float a2_[kMaxBands] = {};
+    alignas(32) float z1_[kMaxBands] = {};
+    alignas(32) float z2_[kMaxBands] = {};
+};
+
+/**
+ * ToneEQ: the hosts' post-NAM tone bands, as a ParametricEQ.
+ *
+ * Together with MidSweepEQ's mid bell these make the chain's five-band
+ * tone shaping:
+ *   band 0 -- low cut   (HighPass)    lowCutHz   [20, 300] Hz, default 20
+ *   band 1 -- bass      (LowShelf)    bassDb     [-12, +12] dB, default 0
+ *                                     bassHz     [60, 400] Hz, default 120
+ *   band 2 -- treble    (HighShelf)   trebleDb   [-12, +12] dB, default 0
+ *                                     trebleHz   [1500, 8000] Hz, default 3000
+ *   band 3 -- high cut  (LowPass)     highCutHz  [2000, 20000] Hz, default 20000
+ *
+ * A cut at the open end of its range and a shelf at 0 dB switch their band
+ * Off, so at the defaults the stage is an identity (and Pipeline skips it).
+ * The mid band stays with MidSweepEQ, whose sweep is smoothed and
+ * interpolated per sample for an expression pedal; ParametricEQ updates
+ * coefficients once per block.
+ *
+ * Setters are atomic (via ParametricEQ::setBand) and meant for one control
+ * thread: each one reads back and rewrites its band.
+ */
+class ToneEQ : public ParametricEQ {
+public:
+    // Parameter ranges (match ParamRegistry's EqLowCutHz ... EqHighCutHz).
+    static constexpr float kMinLowCutHz  =    20.f;
+    static constexpr float kMaxLowCutHz  =   300.f;
+    static constexpr float kMinShelfDb   =   -12.f;
+    static constexpr float kMaxShelfDb   =    12.f;
+    static constexpr float kMinBassHz    =    60.f;
+    static constexpr float kMaxBassHz    =   400.f;
+    static constexpr float kMinTrebleHz  =  1500.f;
+    static constexpr float kMaxTrebleHz  =  8000.f;
+    static constexpr float kMinHighCutHz =  2000.f;
+    static constexpr float kMaxHighCutHz = 20000.f;
+
+    static constexpr float kCutQ   = 0.707f;   // Butterworth
+    static constexpr float kShelfQ = 0.707f;   // shelf slope S = 1
+
+    // Band indices
+    static constexpr int kLowCutBand  = 0;
+    static constexpr int kBassBand    = 1;
+    static constexpr int kTrebleBand  = 2;
+    static constexpr int kHighCutBand = 3;
+
+    ToneEQ();
+
+    void setLowCutHz (float hz);   // clamped to [20, 300]; 20 = off
+    void setBassDb   (float db);   // clamped to [-12, +12]; 0 = off
+    void setBassHz   (float hz);   // clamped to [60, 400]
+    void setTrebleDb (float db);   // clamped to [-12, +12]; 0 = off
+    void setTrebleHz (float hz);   // clamped to [1500, 8000]
+    void setHighCutHz(float hz);   // clamped to [2000, 20000]; 20000 = off
+
+private:
+    void setCut    (int band, BiquadType type, float hz, float offHz);
+    void setShelf  (int band, BiquadType type, float db);
+    void setShelfHz(int band, float hz);
 };
 
 } // namespace hexcaster
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <vector>
 #include "hexcaster/processor_stage.h"
 #include "hexcaster/param_smoother.h"
 
@@ -10,7 +11,14 @@ namespace hexcaster {
  * GainStage: applies a smoothed linear gain to an audio buffer.
  *
  * - Gain is specified in dB externally; stored as linear internally.
- * - Transitions are smoothed per-sample to avoid clicks.
+ * - Transitions are smoothed per-sample to avoid clicks. The ramp is
+ *   computed a vector of samples at a time (ParamSmoother::multiplyBlock).
+ * - At steady state the smoother is settled: the block is a plain
+ *   multiply, or untouched at exactly unity gain (isIdentity(), so
+ *   Pipeline skips the call altogether).
+ * - Multichannel (processChannels()): the gain is the same for every
+ *   channel, so the ramp is computed once per block and each plane is
+ *   multiplied by it along time -- contiguous loads, no transposition.
  * - Safe limits are clamped at set time.
  * - No dynamic allocation. No denormals (gain floor enforced).
  *
@@ -31,6 +39,9 @@ public:
     void prepare(float sampleRate, int maxBlockSize) override;
     void process(float* buffer, int numSamples) override;
     void reset() override;
+    bool isIdentity() const override;
+    int  maxChannels() const override { return AudioBlock::kMaxChannels; }
+    void processChannels(const AudioBlock& block) override;
 
     /**
      * Set target gain in dB. Clamped to [kMinDb, kMaxDb].
@@ -47,9 +58,29 @@ public:
     float getGainDb() const;
     float getGainLinear() const;
 
+    /**
+     * Per-sample linear gains for the next process() call only, in place of
+     * the smoothed target (used by BloomController). gains must hold that
+     * call's numSamples values and stay valid until it returns. Afterwards
+     * the smoother continues from the last value, so dropping back to the
+     * target is click-free. Audio thread only.
+     */
+    void setGainTrajectory(const float* gains) { trajectory_ = gains; }
+
+    /**
+     * Advance exactly as process() would over numSamples (<= maxBlockSize),
+     * but return the gain instead of applying it, for a stage that applies
+     * it on its own output pass (StaticPipeline fusion). A ramp is rendered
+     * into a buffer owned by this stage, valid until the next call.
+     * Audio thread only.
+     */
+    OutputGain nextGain(int numSamples);
+
 private:
     std::atomic<float> targetGainLinear_;
     ParamSmoother      smoother_;
+    const float*       trajectory_ = nullptr;
+    std::vector<float> ramp_;   // nextGain() ramp, allocated in prepare()
 };
 
 } // namespace hexcaster
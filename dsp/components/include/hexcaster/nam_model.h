@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+// Forward-declare to avoid pulling NeuralAudio headers into consumer code
+namespace NeuralAudio { class NeuralModel; }
+
+namespace hexcaster {
+
+/**
+ * NamModel: one loaded .nam file, ready to run.
+ *
+ * Owns the NeuralAudio::NeuralModel together with what is derived from it
+ * at load time -- the recommended input/output calibration as linear gains
+ * and the source path -- so that nothing on the audio path needs to parse,
+ * allocate or call pow().
+ *
+ * A NamModel carries internal state (WaveNet receptive field, LSTM hidden
+ * state) and must only be processed by one thread at a time.
+ *
+ * Real-time safety:
+ *   - process() is RT-safe.
+ *   - load(), setMaxBlockSize() and warmUp() are NOT: control/init thread.
+ */
+class NamModel {
+public:
+    NamModel();
+    ~NamModel();
+
+    NamModel(const NamModel&)            = delete;
+    NamModel& operator=(const NamModel&) = delete;
+
+    /**
+     * Parse and build the model from a .nam file. Not real-time safe.
+     * If maxBlockSize > 0 the model is sized for it and warmed up on
+     * kWarmupSamples of silence, so its first real block is not a
+     * cold-state transient.
+     *
+     * Returns false on failure; errorMessage() has details.
+     */
+    bool load(const std::string& path, int maxBlockSize);
+
+    /** Resize NeuralAudio's internal buffers. Not real-time safe. */
+    void setMaxBlockSize(int maxBlockSize);
+
+    /** Run numSamples of silence through the model. Not real-time safe. */
+    void warmUp(int numSamples);
+
+    /**
+     * Run inference. input is scaled in place by the input calibration;
+     * output receives the calibrated model output. Real-time safe.
+     * numSamples must not exceed the size given to load()/setMaxBlockSize().
+     */
+    void process(float* input, float* output, int numSamples);
+
+    bool               isLoaded()         const { return model_ != nullptr; }
+    const std::string& path()             const { return path_; }
+    float              inputGainLinear()  const { return inputGainLinear_; }
+    float              outputGainLinear() const { return outputGainLinear_; }
+    const std::string& errorMessage()     const { return errorMsg_; }
+
+    /**
+     * Samples of input history the output of the model in a .nam file
+     * depends on, read from its config (WaveNet, ConvNet, Linear). 0 for
+     * recurrent models (LSTM, GRU), whose state has no finite horizon, and
+     * for files that can't be read. Not real-time safe (file I/O).
+     */
+    static int receptiveField(const std::string& path);
+
+    // Silence run through a newly loaded model.
+    // Longer than a standard NAM WaveNet's receptive field (~4k samples).
+    static constexpr int kWarmupSamples = 8192;
+
+private:
+    std::unique_ptr<NeuralAudio::NeuralModel> model_;
+    std::string path_;
+    std::string errorMsg_;
+    int         maxBlockSize_ = 0;
+
+    // Calibration offsets from the model (applied as linear gain)
+    float inputGainLinear_  = 1.f;
+    float outputGainLinear_ = 1.f;
+};
+
+} // namespace hexcaster
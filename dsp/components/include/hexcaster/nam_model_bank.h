@@ -0,0 +1,97 @@
+#pragma once
+
+#include "hexcaster/nam_model.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hexcaster {
+
+/**
+ * NamModelBank: a fixed set of NamModels loaded once and kept resident.
+ *
+ * Parsing a .nam file and building the network takes long enough on the
+ * Pi that loading on demand between songs is not practical. A bank parses
+ * every model up front -- at startup, or on a background thread while
+ * audio is already running -- sizes each for the host block size and warms
+ * it up. Switching is then just NamStage::selectBankModel(index): no file
+ * I/O, no parsing, no allocation beyond a small handoff record.
+ *
+ * Slots are indexed in the order the paths were given, which maps directly
+ * onto MIDI program numbers (0-127).
+ *
+ * Thread safety:
+ *   - load()/loadAsync() may be called once per bank.
+ *   - model(i) may be called from any thread at any time; it returns
+ *     nullptr until slot i has finished loading (or if it failed).
+ *   - The bank must outlive every NamStage that selects from it.
+ *   - A bank model has per-instance state, so a bank should feed a single
+ *     NamStage.
+ *
+ * Usage:
+ *   NamModelBank bank;
+ *   bank.loadAsync({ "clean.nam", "crunch.nam", "lead.nam" }, 128);
+ *   // ... later, from the MIDI thread:
+ *   nam.selectBankModel(bank, program);
+ */
+class NamModelBank {
+public:
+    static constexpr int kMaxModels = 128; // one per MIDI program
+
+    NamModelBank() = default;
+    ~NamModelBank();
+
+    NamModelBank(const NamModelBank&)            = delete;
+    NamModelBank& operator=(const NamModelBank&) = delete;
+
+    /**
+     * Load every path, in order, on the calling thread. Not real-time safe.
+     * Paths beyond kMaxModels are ignored. A slot that fails to load stays
+     * empty; the rest still load.
+     *
+     * Returns true if every model loaded; errorMessage() lists failures.
+     */
+    bool load(const std::vector<std::string>& paths, int maxBlockSize);
+
+    /**
+     * Same as load(), on a background thread. Returns immediately; slots
+     * become available through model() one by one as they finish.
+     */
+    void loadAsync(std::vector<std::string> paths, int maxBlockSize);
+
+    /**
+     * Block until a loadAsync() has finished.
+     * Returns true if every model loaded; errorMessage() lists failures.
+     */
+    bool wait();
+
+    /** Loaded model in slot index, or nullptr. Any thread. */
+    NamModel* model(int index) const;
+
+    /** Number of slots (paths given, capped at kMaxModels). */
+    int size() const { return size_.load(std::memory_order_acquire); }
+
+    /**
+     * Resize every loaded model. Not real-time safe; only while no NamStage
+     * is processing a bank model (i.e. with audio stopped).
+     */
+    void setMaxBlockSize(int maxBlockSize);
+
+    /** Load failures. Valid after load() or wait() has returned. */
+    const std::string& errorMessage() const { return errorMsg_; }
+
+private:
+    bool loadAll(const std::vector<std::string>& paths, int maxBlockSize);
+
+    std::unique_ptr<NamModel> owned_[kMaxModels];
+    std::atomic<NamModel*>    published_[kMaxModels] = {};
+    std::atomic<int>          size_{ 0 };
+    std::thread               loader_;
+    bool                      allLoaded_ = false;
+    std::string               errorMsg_;
+};
+
+} // namespace hexcaster
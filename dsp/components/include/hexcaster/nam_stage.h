@@ -1,34 +1,63 @@
 #pragma once
 
 #include "hexcaster/processor_stage.h"
+#include "hexcaster/spsc_queue.h"
 #include <atomic>
-#include <memory>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
-// Forward-declare to avoid pulling NeuralAudio headers into consumer code
-namespace NeuralAudio { class NeuralModel; }
-
 namespace hexcaster {
 
+class NamModel;
+class NamModelBank;
+
 /**
- * NamStage: ProcessorStage wrapper around NeuralAudio::NeuralModel.
+ * NamStage: ProcessorStage wrapper around a NamModel.
  *
  * Responsibilities:
  *   - Load a .nam model file at initialization time (never during process())
- *   - Delegate per-block inference to NeuralModel::Process()
- *   - Apply the model's recommended input/output dB adjustments
- *   - Expose a pending model path that can be set from the control thread
- *     and swapped safely between blocks (not sample-accurate, but safe)
+ *   - Delegate per-block inference to NamModel::process(), which applies
+ *     the model's recommended input/output dB adjustments
+ *   - Accept a new model from the control thread at any time and swap it
+ *     in between blocks (not sample-accurate, but glitch-free and RT-safe)
+ *   - Switch among the preloaded models of a NamModelBank by index
+ *
+ * Model handoff:
+ *   loadModel() builds a NamModel on the calling thread, wraps it in a Slot
+ *   and publishes it with an atomic pointer exchange. selectBankModel()
+ *   publishes a Slot that refers to a bank model without owning it. At the top of
+ *   process() the audio thread exchanges the pending pointer out and makes
+ *   it active. The outgoing Slot is pushed onto a fixed-size SPSC retire
+ *   queue; a background reclaimer thread pops and deletes it. The audio
+ *   thread never allocates, frees, or touches a std::string.
+ *
+ *   If loadModel() is called again before the audio thread has picked up
+ *   the previous pending model, the older one was never seen by the audio
+ *   thread and is deleted directly by the caller. If the retire queue is
+ *   full (reclaimer stalled), the swap simply waits for a later block.
+ *
+ * Crossfade:
+ *   A swap is not a hard cut. For crossfadeMs (default 50 ms) both the
+ *   outgoing and incoming model run on the same input and their outputs
+ *   are equal-power crossfaded; the outgoing slot is retired when the fade
+ *   ends. "No model" fades as a dry signal, so unloading fades to bypass.
+ *   The very first model loaded into a stage cuts in immediately.
+ *
+ *   So the fade doesn't start with a cold model's settling transient,
+ *   loadModel() warms the incoming model on silence (see NamModel) on the
+ *   calling thread before publishing it; bank models are warmed when the
+ *   bank loads. During a fade process()
+ *   costs roughly two model inferences; a new pending model is not picked
+ *   up until the current fade has finished.
  *
  * Real-time safety:
- *   - process() is RT-safe: no allocation, no file I/O, bounded time
- *   - loadModel() is NOT RT-safe: call from control/init thread only
- *   - pendingModelPath_ is checked at the top of process() -- if a new
- *     path has been set, the model is swapped before processing the block.
- *     This swap does allocate (std::unique_ptr swap), so it is not strictly
- *     RT-safe, but it is bounded and infrequent. A lock-free double-buffer
- *     can replace this later if needed.
+ *   - process() is RT-safe: no allocation, no file I/O, bounded time,
+ *     including on the block that swaps models
+ *   - loadModel()/unloadModel() are NOT RT-safe: control/init thread only
+ *   - prepare() must not run concurrently with process()
  *
  * Usage:
  *   NamStage nam;
@@ -60,36 +89,86 @@ public:
      */
     bool loadModel(const std::string& path);
 
+    /**
+     * Switch to the bank model in slot index. Not real-time safe, but does
+     * no file I/O or parsing -- cheap enough for a MIDI thread. The bank
+     * must outlive this stage.
+     *
+     * Returns false (and keeps the current model) if the slot is out of
+     * range or not loaded yet.
+     */
+    bool selectBankModel(const NamModelBank& bank, int index);
+
     /**
      * Unload the current model. Not real-time safe.
      * After this, process() will pass audio through unmodified.
      */
     void unloadModel();
 
+    /** True once the audio thread is running (or fading to) a model. Any thread. */
     bool hasModel() const;
-    const std::string& modelPath() const { return currentModelPath_; }
-
-private:
-    std::unique_ptr<NeuralAudio::NeuralModel> model_;
-    std::string currentModelPath_;
 
-    // Pending model set by control thread, swapped in at top of process()
-    std::unique_ptr<NeuralAudio::NeuralModel> pendingModel_;
-    std::string pendingModelPath_;
-    std::atomic<bool> modelPending_{ false };
-
-    // Working buffer for NeuralAudio output (pre-allocated in prepare())
-    std::vector<float> outputBuffer_;
+    /**
+     * Crossfade length for model swaps, in ms. Clamped to [0, kMaxCrossfadeMs];
+     * 0 = hard cut. Takes effect at the next swap.
+     * Thread-safe: may be called from control thread.
+     */
+    void  setCrossfadeMs(float ms);
+    float getCrossfadeMs() const;
 
-    int   maxBlockSize_ = 0;
-    float sampleRate_   = 0.f;
+    static constexpr float kDefaultCrossfadeMs = 50.f;
+    static constexpr float kMaxCrossfadeMs     = 500.f;
 
-    // Calibration offsets from the model (applied as linear gain)
-    float inputGainLinear_  = 1.f;
-    float outputGainLinear_ = 1.f;
+    /**
+     * Path of the most recently requested model (empty after unloadModel()).
+     * Control thread only; returned by value.
+     */
+    std::string modelPath() const;
 
+private:
+    // Handoff record: a model to run (owned, or borrowed from a bank).
+    struct Slot;
+
+    static constexpr std::size_t kRetireCapacity = 8;
+
+    // --- Audio thread state ---
+    Slot*              active_   = nullptr;
+    Slot*              incoming_ = nullptr;   // non-null while crossfading
+    int                fadeLength_ = 0;       // samples
+    int                fadePos_    = 0;
+
+    // Pre-allocated in prepare()
+    std::vector<float> inputBuffer_;          // calibrated model input
+    std::vector<float> outputBuffer_;         // NeuralAudio output (active)
+    std::vector<float> fadeBuffer_;           // incoming slot output during a fade
+
+    // --- Handoff ---
+    std::atomic<Slot*>                    pending_{ nullptr };
+    SpscQueue<Slot*, kRetireCapacity>     retired_;       // audio -> reclaimer
+    std::atomic<bool>                     hasModel_{ false };
+    std::atomic<float>                    crossfadeMs_{ kDefaultCrossfadeMs };
+
+    // --- Control thread state ---
+    mutable std::mutex      controlMutex_;  // serialises loaders, guards modelPath_
+    std::string             modelPath_;
+    int                     maxBlockSize_ = 0;
+    float                   sampleRate_   = 0.f;
+
+    // --- Reclaimer thread ---
+    std::thread             reclaimer_;
+    std::mutex              reclaimMutex_;
+    std::condition_variable reclaimCv_;
+    bool                    stopReclaimer_ = false;
+
+    void publish(Slot* slot);
     void applyPendingModel();
-    void updateCalibration();
+    void finishFade();
+    void runSlot(const Slot* slot, const float* in, float* out, int numSamples);
+    void updateModelBlockSize(Slot* slot, int maxBlockSize);
+    void processCrossfade(float* buffer, int numSamples);
+    void startReclaimer();
+    void reclaimerLoop();
+    void drainRetired();
 };
 
 } // namespace hexcaster
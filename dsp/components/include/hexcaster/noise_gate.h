@@ -1,5 +1,6 @@
 #pragma once
 
+#include "hexcaster/delay_ring.h"
 #include "hexcaster/processor_stage.h"
 
 #include <atomic>
@@ -14,6 +15,36 @@ namespace hexcaster {
  * to each sample. The gate gain transitions smoothly between open and
  * closed to avoid clicks.
  *
+ * Envelope:
+ *   Peak hold with exponential decay, env[n] = max(|x[n]|, r * env[n-1]).
+ *   Unrolled over kLanes samples this is env[j] = max over k <= j of
+ *   |x[k]| * r^(j-k), plus the carried-in envelope times r^(j+1) -- a
+ *   fixed triangle of multiplies and maxes with no serial dependency, so
+ *   the compiler vectorizes it.
+ *
+ * Block fast paths:
+ *   The buffer is handled in segments of up to kSegment samples. With the
+ *   segment's envelope known up front, most segments need no state machine:
+ *     - OPEN and the envelope never drops below threshold: untouched.
+ *     - HOLDING and the hold outlasts the segment: untouched.
+ *     - CLOSED and the envelope never reaches threshold: zeroed (memset).
+ *   Only segments with an actual transition run the per-sample ramp.
+ *
+ * Lookahead (optional, 0-5 ms):
+ *   Detection runs on the incoming signal while the gain is applied to a
+ *   copy delayed by the lookahead, so the gate is already opening when the
+ *   pick attack reaches it. The delay line is a DelayRing allocated in
+ *   prepare(). The stage then reports the lookahead as its
+ *   latencySamples().
+ *
+ * Multichannel (processChannels(), up to AudioBlock::kMaxChannels):
+ *   Each channel is gated on its own envelope, with its own state. The
+ *   channels are the lanes of one vector (4 lanes up to four channels, 8
+ *   beyond): the envelope recurrence runs for all of them at once, and the
+ *   state machine below becomes per-lane selects instead of branches. The
+ *   whole-segment fast paths apply when every channel qualifies (all open
+ *   and above threshold, or all closed and below).
+ *
  * State machine:
  *   CLOSED  -- gate gain ramps toward 0. Signal is muted.
  *   OPENING -- signal exceeded threshold; gain ramps toward 1.
@@ -27,12 +58,14 @@ namespace hexcaster {
  *   attackMs      -- time to fully open            [0.1, 10] ms, default 0.5
  *   releaseMs     -- time to fully close           [5, 500] ms, default 50
  *   holdMs        -- min open time after drop      [0, 500] ms, default 50
+ *   lookaheadMs   -- detection lead / added delay  [0, 5] ms, default 0
+ *                    (set before prepare(); not atomic)
  *
  * Real-time safety:
- *   process() is RT-safe: no allocation, no branching on hot path beyond
- *   the state machine enum comparison.
- *   Coefficients are recomputed at the top of each block from the atomics,
- *   not per-sample, so parameter changes take effect within one block (~10ms).
+ *   process() is RT-safe: no allocation, no I/O.
+ *   The atomics are read at the top of each block; coefficients are only
+ *   recomputed when one of them changed, so parameter changes take effect
+ *   within one block (~10ms).
  */
 class NoiseGate : public ProcessorStage {
 public:
@@ -41,6 +74,18 @@ public:
     void prepare(float sampleRate, int maxBlockSize) override;
     void process(float* buffer, int numSamples) override;
     void reset() override;
+    int  latencySamples() const override { return lookaheadSamples_; }
+    int  maxChannels() const override { return AudioBlock::kMaxChannels; }
+    void processChannels(const AudioBlock& block) override;
+
+    /** process() with outputGain applied in the same pass (StaticPipeline). */
+    void process(float* buffer, int numSamples, const OutputGain& outputGain);
+
+    /** Lookahead in ms, clamped to [0, kMaxLookaheadMs]. Call before prepare(). */
+    void  setLookaheadMs(float ms);
+    float getLookaheadMs() const { return lookaheadMs_; }
+
+    static constexpr float kMaxLookaheadMs = 5.f;
 
     // Control thread setters (atomic, safe to call any time)
     void setThresholdDb(float db);
@@ -56,10 +101,24 @@ public:
 private:
     enum class State : uint8_t { Closed, Opening, Open, Holding, Closing };
 
-    // Recompute coefficients from current atomic values.
-    // Called at the top of each block -- not RT-unsafe, just a few maths ops.
+    static constexpr int kLanes   = 8;
+    static constexpr int kSegment = 64;   // samples per envelope/fast-path decision
+
+    // Recompute coefficients from the atomic values, if any changed.
+    // Called at the top of each block.
     void updateCoefficients();
 
+    // env[i] for buffer[0..n), n <= kSegment; advances envelope_.
+    void computeEnvelope(const float* buffer, int n, float* env);
+
+    // Per-sample state machine and gain ramp over one segment; g, if set,
+    // is the segment's per-sample output gain, else k.
+    void processTransitions(float* buffer, const float* env, int n, const float* g, float k);
+
+    // processChannels() with N lanes (N = 4 or 8).
+    template <int N>
+    void processLanes(const AudioBlock& block);
+
     static float msToCoeff(float ms, float sampleRate);
     static float dbToLinear(float db);
 
@@ -76,12 +135,35 @@ private:
     float gateGain_       = 0.f;   // current applied gain (0 = closed, 1 = open)
     int   holdCounter_    = 0;     // samples remaining in hold
 
-    // Derived from atomics each block
+    // Lookahead delay line (allocated in prepare())
+    float     lookaheadMs_      = 0.f;
+    int       lookaheadSamples_ = 0;
+    DelayRing delay_;
+
+    // Per-channel state (processChannels()); State values as int lanes
+    int   chState_[AudioBlock::kMaxChannels]    = {};
+    int   chHold_[AudioBlock::kMaxChannels]     = {};
+    float chEnvelope_[AudioBlock::kMaxChannels] = {};
+    float chGain_[AudioBlock::kMaxChannels]     = {};
+    DelayRing chDelay_;   // lookahead frames of up to kMaxChannels floats
+
+    // Derived from the atomics when they change
     float thresholdLin_   = 0.f;
     float attackCoeff_    = 0.f;   // EMA coeff for opening (close to 0 = fast)
     float releaseCoeff_   = 0.f;   // EMA coeff for closing
     float envReleaseCoeff_= 0.f;   // EMA coeff for envelope follower decay
     int   holdSamples_    = 0;
+
+    // envDecay_[k][j] = r^(j-k) for j >= k, else 0; envCarry_[j] = r^(j+1)
+    float envDecay_[kLanes][kLanes] = {};
+    float envCarry_[kLanes]         = {};
+
+    // Atomic values the coefficients were derived from (change detection)
+    float cachedThresholdDb_ = 0.f;
+    float cachedAttackMs_    = 0.f;
+    float cachedReleaseMs_   = 0.f;
+    float cachedHoldMs_      = 0.f;
+    bool  coeffsValid_       = false;
 };
 
 } // namespace hexcaster
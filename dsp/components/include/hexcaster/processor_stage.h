@@ -1,7 +1,21 @@
 #pragma once
 
+#include "hexcaster/audio_block.h"
+
 namespace hexcaster {
 
+/**
+ * A gain for a stage to apply on its own output pass: perSample[i] for each
+ * sample when set, otherwise constant. StaticPipeline uses it to fold a
+ * GainStage into the stage before it (see GainStage::nextGain()).
+ */
+struct OutputGain {
+    const float* perSample = nullptr;
+    float        constant  = 1.f;
+
+    bool isUnity() const { return perSample == nullptr && constant == 1.f; }
+};
+
 /**
  * Abstract interface for all DSP processing stages.
  *
@@ -10,7 +24,11 @@ namespace hexcaster {
  * - process() must be real-time safe: no allocation, no blocking, no I/O.
  * - reset() clears internal state (filters, buffers) without reallocating.
  *
- * Stages are single-channel (mono). The pipeline manages channel routing.
+ * Stages are mono by default. A stage that can also run several channels
+ * at once -- each with its own state, sharing parameters -- overrides
+ * maxChannels() and processChannels(); Pipeline::setNumChannels() only
+ * accepts a layout every stage supports. A stage is run either mono or
+ * planar between two prepare()/reset() calls, not both.
  */
 class ProcessorStage {
 public:
@@ -29,17 +47,46 @@ public:
      * Process a block of audio in-place.
      * Real-time safe. Must complete in bounded time.
      *
-     * @param buffer        Pointer to interleaved float samples (in-place).
+     * @param buffer        Pointer to mono float samples (in-place).
      * @param numSamples    Number of samples to process (<= maxBlockSize).
      */
     virtual void process(float* buffer, int numSamples) = 0;
 
+    /**
+     * Channels processChannels() takes at once (<= AudioBlock::kMaxChannels).
+     * Default 1: mono only.
+     */
+    virtual int maxChannels() const { return 1; }
+
+    /**
+     * Process planar audio in place, block.numChannels <= maxChannels().
+     * Real-time safe, as process(). Default: process() on channel 0.
+     */
+    virtual void processChannels(const AudioBlock& block)
+    {
+        process(block.channels[0], block.numSamples);
+    }
+
     /**
      * Reset internal state (filter memories, envelope state, etc.)
      * without reallocating buffers.
      * Real-time safe.
      */
     virtual void reset() = 0;
+
+    /**
+     * Delay, in samples, this stage adds to the signal (e.g. lookahead).
+     * Valid after prepare(). Default: none.
+     */
+    virtual int latencySamples() const { return 0; }
+
+    /**
+     * True when process() would return the buffer unchanged (within float
+     * rounding) and may be skipped; Pipeline then bypasses the stage for
+     * that block. Audio thread, called right before process(). Must be
+     * cheap: it runs every block. Default: never.
+     */
+    virtual bool isIdentity() const { return false; }
 };
 
 } // namespace hexcaster
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdio>
+
+namespace hexcaster {
+
+/**
+ * RT-safety sanitizer (HEXCASTER_RT_SANITIZE builds only).
+ *
+ * An RtScope marks the calling thread as real-time for its lifetime:
+ * Pipeline::process(), StaticPipeline::process(), the pipeline segment
+ * workers, one iteration of the ALSA audio loop and the LV2 run() each
+ * hold one. Scopes nest.
+ *
+ * With -DHEXCASTER_RT_SANITIZE=ON the hexcaster_rtsan shared library
+ * interposes libc's
+ *   malloc, calloc, realloc, free, posix_memalign, aligned_alloc, memalign
+ *     (operator new/delete reach these too),
+ *   pthread_mutex_lock, pthread_create,
+ *   open, openat, fopen, close, read, write, printf/fprintf (+ _chk forms),
+ *   nanosleep, usleep.
+ * Any of them called on a thread inside an RtScope is counted and its
+ * backtrace recorded (the first kRtsanMaxRecords calls). Nothing aborts:
+ * the program keeps running and the report is printed to stderr at exit,
+ * or on demand with rtsanReport(). The interposers never allocate.
+ *
+ * Plugins: a host that dlopen()s the LV2 bundle keeps its own malloc, so
+ * run it with LD_PRELOAD=libhexcaster_rtsan.so.
+ *
+ * With the option off RtScope is an empty object and the query functions
+ * are constant: no code, no cost.
+ */
+class RtScope {
+public:
+#if HEXCASTER_RT_SANITIZE
+    RtScope();
+    ~RtScope();
+#else
+    RtScope() {}   // user-provided: a scope is not an "unused variable"
+#endif
+
+    RtScope(const RtScope&)            = delete;
+    RtScope& operator=(const RtScope&) = delete;
+};
+
+static constexpr int kRtsanMaxRecords = 32;
+static constexpr int kRtsanMaxFrames  = 24;
+
+#if HEXCASTER_RT_SANITIZE
+
+/** Violations counted since start (or the last rtsanClear()). Any thread. */
+int  rtsanViolationCount();
+
+/** Print the count and recorded backtraces. Not real-time safe. */
+void rtsanReport(std::FILE* out);
+
+/** Forget counted and recorded violations. Not real-time safe. */
+void rtsanClear();
+
+/** True on a thread currently inside an RtScope. */
+bool rtsanInScope();
+
+#else
+
+inline int  rtsanViolationCount()      { return 0; }
+inline void rtsanReport(std::FILE*)    {}
+inline void rtsanClear()               {}
+inline bool rtsanInScope()             { return false; }
+
+#endif
+
+} // namespace hexcaster
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace hexcaster {
+
+/**
+ * Helpers for the DSP worker threads that run alongside the audio thread.
+ *
+ * Both setters are best-effort and apply to the calling thread: they return
+ * false when the OS refuses (no RT limits, CPU offline) and the thread keeps
+ * running with its previous settings. Not real-time safe -- call once at
+ * thread start.
+ */
+
+/** SCHED_FIFO at the given priority (the ALSA audio thread uses 70). */
+bool setCurrentThreadRealtime(int priority);
+
+/** Restrict the calling thread to one CPU. cpu < 0 is a no-op (returns true). */
+bool pinCurrentThreadToCpu(int cpu);
+
+/**
+ * Spin-wait hint: tells the core we are busy-waiting (YIELD on aarch64,
+ * PAUSE on x86). Real-time safe.
+ */
+inline void cpuRelax()
+{
+#if defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * Wait until seq no longer holds old; return the new value.
+ *
+ * Spins for spinIterations first, then falls back to a futex wait
+ * (std::atomic::wait), so a waiter that is already spinning sees the
+ * change within nanoseconds while an idle one costs no CPU. Writers must
+ * call notify_one()/notify_all() after changing seq.
+ */
+inline uint32_t waitForChange(const std::atomic<uint32_t>& seq, uint32_t old,
+                              int spinIterations = 1 << 12)
+{
+    for (int i = 0; i < spinIterations; ++i) {
+        const uint32_t v = seq.load(std::memory_order_acquire);
+        if (v != old) return v;
+        cpuRelax();
+    }
+    for (;;) {
+        seq.wait(old, std::memory_order_acquire);
+        const uint32_t v = seq.load(std::memory_order_acquire);
+        if (v != old) return v;
+    }
+}
+
+} // namespace hexcaster
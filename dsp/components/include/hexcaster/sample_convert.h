@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace hexcaster {
+
+/**
+ * Device-side sample encodings (little-endian, as ALSA's *_LE formats).
+ * Int24 is S24_LE: 24 bits in the low three bytes of four. Int24Packed is
+ * S24_3LE: three bytes per sample, no padding.
+ */
+enum class SampleFormat { Float32, Int32, Int16, Int24, Int24Packed };
+
+int bytesPerSample(SampleFormat fmt);
+
+/**
+ * Where one device channel's samples are: sample i at data[i * stride]
+ * (stride in samples of the format -- 3-byte units for Int24Packed).
+ * Describes an interleaved buffer (stride = channel count) and a
+ * non-interleaved one (stride 1) alike.
+ */
+struct RawChannel {
+    void* data   = nullptr;
+    int   stride = 0;
+};
+
+/**
+ * CaptureConverter / PlaybackConverter: one device channel <-> one planar
+ * float buffer, with the kernel picked once for a format and stride.
+ *
+ *   CaptureConverter in;   in.setUp(SampleFormat::Int16, 2);     // open time
+ *   PlaybackConverter out; out.setUp(SampleFormat::Int16, 2, true);
+ *   in.convert(raw[0], left, n);                                  // per period
+ *   out.convert(left, raw[0], n);
+ *
+ * The kernels are templates over sample type and stride, instantiated for
+ * strides 1..8 (non-interleaved, and interleaved up to 8 channels): with a
+ * constant stride the compiler vectorizes the gather/scatter together with
+ * the conversion (SSE/AVX shuffles, NEON ld2/st2...). Any other stride
+ * takes a generic kernel. The dither generator runs kLanes xorshift states
+ * side by side on GCC/Clang vectors, like ChannelLanes; the dithered Int16
+ * kernel quantizes on those vectors too (its clamp keeps a per-sample loop
+ * scalar without -ffast-math) and then scatters at the stride.
+ *
+ * Scaling: integer formats are full scale at +-1.0 (x 32768, x 2^23,
+ * x 2^31), so Int16 and both 24-bit formats survive device -> float ->
+ * device bit-exact. The 24-bit formats go through a top-aligned Int32.
+ * Playback saturates out-of-range input to the format's limits instead of
+ * wrapping; Int16 rounds to nearest and, with dither on, adds TPDF dither
+ * (two uniform sources, +-1 LSB peak) from a per-converter xorshift state
+ * before rounding. Float32 passes through unchanged.
+ *
+ * setUp() is not real-time safe to race with convert(); convert() and
+ * silence() are RT-safe. One PlaybackConverter per output channel: the
+ * dither state is per channel, so channels get uncorrelated noise.
+ */
+class CaptureConverter {
+public:
+    /** Pick the kernel for fmt and the expected stride. */
+    void setUp(SampleFormat fmt, int stride);
+
+    /** raw -> dst[0 .. frames). Any raw.stride works; the set-up one is fastest. */
+    void convert(const RawChannel& raw, float* dst, int frames) const;
+
+private:
+    using Kernel = void (*)(const void* src, int stride, float* dst, int frames);
+
+    Kernel kernel_  = nullptr;
+    Kernel generic_ = nullptr;
+    int    stride_  = 0;
+};
+
+class PlaybackConverter {
+public:
+    static constexpr int kLanes = 8;
+
+    /**
+     * Pick the kernel for fmt and the expected stride. dither only affects
+     * Int16. seed selects the dither sequence (give each channel its own).
+     */
+    void setUp(SampleFormat fmt, int stride, bool dither, uint32_t seed = 1);
+
+    /** src[0 .. frames) -> raw, saturated (and dithered). */
+    void convert(const float* src, const RawChannel& raw, int frames);
+
+    /** Write frames of digital silence (no dither) to raw. */
+    void silence(const RawChannel& raw, int frames) const;
+
+private:
+    using Kernel = void (*)(const float* src, void* dst, int stride, int frames,
+                            uint32_t* ditherState);
+    using SilenceKernel = void (*)(void* dst, int stride, int frames);
+
+    Kernel        kernel_         = nullptr;
+    Kernel        generic_        = nullptr;
+    SilenceKernel silence_        = nullptr;
+    SilenceKernel genericSilence_ = nullptr;
+    int           stride_         = 0;
+
+    std::array<uint32_t, kLanes> ditherState_ = {};   // xorshift32, one per lane
+};
+
+} // namespace hexcaster
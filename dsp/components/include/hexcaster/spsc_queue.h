@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace hexcaster {
+
+/**
+ * SpscQueue: fixed-capacity single-producer / single-consumer ring.
+ *
+ * Real-time safety:
+ *   push() and pop() are wait-free: one relaxed load, one acquire load, one
+ *   release store each. No allocation after construction. Exactly one
+ *   thread may push and exactly one (possibly different) thread may pop.
+ *
+ * Capacity must be a power of two. T should be trivially copyable (pointers,
+ * small structs) -- elements are copied, not moved.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    /** Producer only. Returns false (and drops nothing) if the queue is full. */
+    bool push(const T& value)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+        items_[tail & kMask] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer only. Returns false if the queue is empty. */
+    bool pop(T& out)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        out = items_[head & kMask];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Producer side: true if the next push() would fail. */
+    bool full() const
+    {
+        return tail_.load(std::memory_order_relaxed)
+             - head_.load(std::memory_order_acquire) == Capacity;
+    }
+
+    /** Consumer side: true if the next pop() would fail. */
+    bool empty() const
+    {
+        return head_.load(std::memory_order_relaxed)
+            == tail_.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    static constexpr std::size_t kMask = Capacity - 1;
+
+    // Head and tail on separate cache lines so producer and consumer
+    // don't false-share.
+    alignas(64) std::atomic<std::size_t> head_{ 0 };
+    alignas(64) std::atomic<std::size_t> tail_{ 0 };
+    std::array<T, Capacity>              items_{};
+};
+
+} // namespace hexcaster
@@ -0,0 +1,46 @@
+#include "hexcaster/delay_ring.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace hexcaster {
+
+void DelayRing::prepare(int delayFrames, int maxWidth)
+{
+    delay_ = std::max(delayFrames, 0);
+    ring_.assign(static_cast<std::size_t>(delay_) * static_cast<std::size_t>(std::max(maxWidth, 1)), 0.f);
+    pos_ = 0;
+}
+
+void DelayRing::reset()
+{
+    std::fill(ring_.begin(), ring_.end(), 0.f);
+    pos_ = 0;
+}
+
+void DelayRing::process(float* frames, int n, int width, float* scratch)
+{
+    const int D = delay_;
+    if (D == 0) return;
+
+    const int         k     = std::min(n, D);
+    const std::size_t frame = static_cast<std::size_t>(width) * sizeof(float);
+    float*            ring  = ring_.data();
+
+    const int first = std::min(k, D - pos_);   // span before the wrap
+    std::memcpy(scratch,                 ring + pos_ * width, static_cast<std::size_t>(first)     * frame);
+    std::memcpy(scratch + first * width, ring,                static_cast<std::size_t>(k - first) * frame);
+    std::memcpy(scratch + k * width,     frames,              static_cast<std::size_t>(n - k)     * frame);
+
+    const float* tail = frames + (n - k) * width;
+    std::memcpy(ring + pos_ * width, tail,                 static_cast<std::size_t>(first)     * frame);
+    std::memcpy(ring,                tail + first * width, static_cast<std::size_t>(k - first) * frame);
+
+    pos_ += k;
+    if (pos_ >= D) pos_ -= D;
+
+    std::memcpy(frames, scratch, static_cast<std::size_t>(n) * frame);
+}
+
+} // namespace hexcaster
@@ -0,0 +1,126 @@
+#include "hexcaster/dual_amp_stage.h"
+#include "hexcaster/nam_stage.h"
+#include "hexcaster/rt_thread.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace hexcaster {
+
+static constexpr float kMixSmoothingMs = 10.f;
+
+DualAmpStage::DualAmpStage(NamStage& ampA, NamStage& ampB)
+    : ampA_(ampA), ampB_(ampB)
+{
+}
+
+DualAmpStage::~DualAmpStage()
+{
+    stopWorkerThread();
+}
+
+void DualAmpStage::prepare(float sampleRate, int maxBlockSize)
+{
+    // The worker only touches amp B and bufferB_ between a blockSeq_ bump
+    // and the matching doneSeq_, i.e. inside process(), so it is idle here.
+    ampA_.prepare(sampleRate, maxBlockSize);
+    ampB_.prepare(sampleRate, maxBlockSize);
+
+    bufferB_.assign(static_cast<std::size_t>(maxBlockSize), 0.f);
+
+    mixSmoother_.prepare(sampleRate, kMixSmoothingMs);
+    mixSmoother_.snap(targetMix_.load(std::memory_order_relaxed));
+
+    startWorker();
+}
+
+void DualAmpStage::process(float* buffer, int numSamples)
+{
+    std::memcpy(bufferB_.data(), buffer, static_cast<std::size_t>(numSamples) * sizeof(float));
+
+    if (worker_.joinable()) {
+        // Hand the block to the worker, run A here, then wait for B.
+        blockSamples_ = numSamples;
+        const uint32_t seq = blockSeq_.load(std::memory_order_relaxed) + 1;
+        blockSeq_.store(seq, std::memory_order_release);
+        blockSeq_.notify_one();
+
+        ampA_.process(buffer, numSamples);
+
+        waitForChange(doneSeq_, seq - 1);
+    } else {
+        // No worker (not prepared yet): same result, one core.
+        ampA_.process(buffer, numSamples);
+        ampB_.process(bufferB_.data(), numSamples);
+    }
+
+    mixSmoother_.setTarget(targetMix_.load(std::memory_order_relaxed));
+
+    const float* b = bufferB_.data();
+    for (int i = 0; i < numSamples; ++i) {
+        const float mix = mixSmoother_.next();
+        buffer[i] += mix * (b[i] - buffer[i]);
+    }
+}
+
+void DualAmpStage::reset()
+{
+    ampA_.reset();
+    ampB_.reset();
+    mixSmoother_.snap(targetMix_.load(std::memory_order_relaxed));
+}
+
+void DualAmpStage::setMix(float mix)
+{
+    targetMix_.store(std::clamp(mix, 0.f, 1.f), std::memory_order_relaxed);
+}
+
+float DualAmpStage::getMix() const
+{
+    return targetMix_.load(std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Worker
+// ---------------------------------------------------------------------------
+
+void DualAmpStage::startWorker()
+{
+    if (worker_.joinable()) return;
+
+    // The worker's starting sequence is read here, not on the new thread:
+    // the first block may be handed off before the thread gets scheduled.
+    const uint32_t seq = blockSeq_.load(std::memory_order_relaxed);
+    stopWorker_.store(false, std::memory_order_relaxed);
+    doneSeq_.store(seq, std::memory_order_relaxed);
+    worker_ = std::thread([this, seq] { workerLoop(seq); });
+}
+
+void DualAmpStage::stopWorkerThread()
+{
+    if (!worker_.joinable()) return;
+
+    stopWorker_.store(true, std::memory_order_release);
+    blockSeq_.fetch_add(1, std::memory_order_release);
+    blockSeq_.notify_one();
+    worker_.join();
+}
+
+void DualAmpStage::workerLoop(uint32_t seen)
+{
+    // Best-effort, like the audio thread's own SCHED_FIFO request.
+    pinCurrentThreadToCpu(workerCpu_);
+    if (workerPriority_ > 0) setCurrentThreadRealtime(workerPriority_);
+
+    for (;;) {
+        seen = waitForChange(blockSeq_, seen);
+        if (stopWorker_.load(std::memory_order_acquire)) break;
+
+        ampB_.process(bufferB_.data(), blockSamples_);
+
+        doneSeq_.store(seen, std::memory_order_release);
+        doneSeq_.notify_one();
+    }
+}
+
+} // namespace hexcaster
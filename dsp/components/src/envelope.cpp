@@ -0,0 +1,229 @@
+#include "hexcaster/envelope.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace hexcaster {
+
+static constexpr float kDetectorQ    = 0.7071f;   // Butterworth
+static constexpr float kRmsWindowMs  = 10.f;      // power averaging for Detector::Rms
+
+// ---------------------------------------------------------------------------
+// Block biquad
+// ---------------------------------------------------------------------------
+
+// DF2T as a state-space system with state s = (z1, z2):
+//   y  = D x + C s            D = b0, C = [1 0]
+//   s' = A s + B x            A = [-a1 1; -a2 0], B = [b1 - a1 b0; b2 - a2 b0]
+// Unrolled over N samples:
+//   y[j] = D x[j] + sum_{k<j} C A^(j-k-1) B x[k] + C A^j s
+//   s_N  = A^N s  + sum_k A^(N-1-k) B x[k]
+// Built in double, stored as float.
+void EnvelopeFollower::BlockBiquad::design(const BiquadCoeffs& coeffs)
+{
+    c = coeffs;
+
+    const double a[2][2] = { { -c.a1, 1.0 }, { -c.a2, 0.0 } };
+    const double b[2]    = { c.b1 - c.a1 * c.b0, c.b2 - c.a2 * c.b0 };
+
+    // r[m] = C A^m (row vectors), v[m] = A^m B (column vectors)
+    double r[N + 1][2], v[N][2];
+    r[0][0] = 1.0; r[0][1] = 0.0;
+    v[0][0] = b[0]; v[0][1] = b[1];
+    for (int m = 0; m < N; ++m) {
+        r[m + 1][0] = r[m][0] * a[0][0] + r[m][1] * a[1][0];
+        r[m + 1][1] = r[m][0] * a[0][1] + r[m][1] * a[1][1];
+        if (m + 1 < N) {
+            v[m + 1][0] = a[0][0] * v[m][0] + a[0][1] * v[m][1];
+            v[m + 1][1] = a[1][0] * v[m][0] + a[1][1] * v[m][1];
+        }
+    }
+
+    for (int k = 0; k < N; ++k) {
+        for (int j = 0; j < N; ++j) {
+            if (j == k)     h[k][j] = c.b0;
+            else if (j > k) h[k][j] = static_cast<float>(r[j - k - 1][0] * b[0] + r[j - k - 1][1] * b[1]);
+            else            h[k][j] = 0.f;
+        }
+    }
+    for (int j = 0; j < N; ++j) {
+        p[0][j] = static_cast<float>(r[j][0]);
+        p[1][j] = static_cast<float>(r[j][1]);
+    }
+    for (int k = 0; k < N; ++k) {
+        sx[0][k] = static_cast<float>(v[N - 1 - k][0]);
+        sx[1][k] = static_cast<float>(v[N - 1 - k][1]);
+    }
+
+    // A^N: columns are A^N e0 and A^N e1
+    double e0[2] = { 1.0, 0.0 }, e1[2] = { 0.0, 1.0 };
+    for (int m = 0; m < N; ++m) {
+        const double t0 = a[0][0] * e0[0] + a[0][1] * e0[1];
+        const double t1 = a[1][0] * e0[0] + a[1][1] * e0[1];
+        const double u0 = a[0][0] * e1[0] + a[0][1] * e1[1];
+        const double u1 = a[1][0] * e1[0] + a[1][1] * e1[1];
+        e0[0] = t0; e0[1] = t1;
+        e1[0] = u0; e1[1] = u1;
+    }
+    ss[0][0] = static_cast<float>(e0[0]); ss[0][1] = static_cast<float>(e1[0]);
+    ss[1][0] = static_cast<float>(e0[1]); ss[1][1] = static_cast<float>(e1[1]);
+}
+
+// in and out may alias.
+void EnvelopeFollower::BlockBiquad::run(const float* in, float* out, int n)
+{
+    float s1 = z1, s2 = z2;
+    int   i  = 0;
+
+    for (; i + N <= n; i += N) {
+        float x[N], y[N];
+        std::memcpy(x, in + i, sizeof(x));
+
+        for (int j = 0; j < N; ++j) y[j] = p[0][j] * s1 + p[1][j] * s2;
+        for (int k = 0; k < N; ++k) {
+            for (int j = 0; j < N; ++j) y[j] += h[k][j] * x[k];
+        }
+
+        float n1 = ss[0][0] * s1 + ss[0][1] * s2;
+        float n2 = ss[1][0] * s1 + ss[1][1] * s2;
+        for (int k = 0; k < N; ++k) {
+            n1 += sx[0][k] * x[k];
+            n2 += sx[1][k] * x[k];
+        }
+        s1 = n1;
+        s2 = n2;
+
+        std::memcpy(out + i, y, sizeof(y));
+    }
+
+    // Remainder: plain DF2T
+    for (; i < n; ++i) {
+        const float x = in[i];
+        const float y = c.b0 * x + s1;
+        s1 = c.b1 * x - c.a1 * y + s2;
+        s2 = c.b2 * x - c.a2 * y;
+        out[i] = y;
+    }
+
+    z1 = s1;
+    z2 = s2;
+}
+
+// ---------------------------------------------------------------------------
+// EnvelopeFollower
+// ---------------------------------------------------------------------------
+
+// One-pole ballistics applied once per chunk of len samples:
+// coeff = exp(-len / (tau * sampleRate))
+static float chunkCoeff(float ms, int len, float sampleRate)
+{
+    if (ms <= 0.f) return 0.f;
+    return std::exp(-static_cast<float>(len) / (ms * 0.001f * sampleRate));
+}
+
+void EnvelopeFollower::prepare(float sampleRate, int maxBlockSize, const Config& config)
+{
+    config_ = config;
+
+    const float nyquistGuard = 0.49f * sampleRate;
+    hpf_.design(designBiquad(BiquadType::HighPass, sampleRate,
+                             std::clamp(config.hpfCutoffHz, 10.f, nyquistGuard), 0.f, kDetectorQ));
+    lpf_.design(designBiquad(BiquadType::LowPass, sampleRate,
+                             std::clamp(config.lpfCutoffHz, 10.f, nyquistGuard), 0.f, kDetectorQ));
+
+    sampleRate_ = sampleRate;
+    for (int len = 1; len <= kDetectChunk; ++len) {
+        rmsCoeff_[len - 1] = chunkCoeff(kRmsWindowMs, len, sampleRate);
+    }
+    setBallistics(config.attackMs, config.releaseMs);
+
+    detector_.assign(static_cast<std::size_t>(std::max(maxBlockSize, 1)), 0.f);
+
+    lookaheadSamples_ = std::max(0, static_cast<int>(std::lround(config.lookaheadMs * 0.001f * sampleRate)));
+    delay_.prepare(lookaheadSamples_, 1);
+    delayOut_.assign(lookaheadSamples_ > 0 ? detector_.size() : 0, 0.f);
+
+    reset();
+}
+
+void EnvelopeFollower::setBallistics(float attackMs, float releaseMs)
+{
+    config_.attackMs  = attackMs;
+    config_.releaseMs = releaseMs;
+    for (int len = 1; len <= kDetectChunk; ++len) {
+        attackCoeff_[len - 1]  = chunkCoeff(attackMs,  len, sampleRate_);
+        releaseCoeff_[len - 1] = chunkCoeff(releaseMs, len, sampleRate_);
+    }
+}
+
+void EnvelopeFollower::reset()
+{
+    hpf_.z1 = hpf_.z2 = 0.f;
+    lpf_.z1 = lpf_.z2 = 0.f;
+    envelope_ = 0.f;
+    power_    = 0.f;
+    delay_.reset();
+}
+
+float EnvelopeFollower::process(const float* buffer, int numSamples, float* envelopeOut)
+{
+    const int   maxSlice = static_cast<int>(detector_.size());
+    const bool  rms      = config_.detector == Detector::Rms;
+    float*      det      = detector_.data();
+    float       env      = envelope_;
+    float       power    = power_;
+
+    for (int offset = 0; offset < numSamples; offset += maxSlice) {
+        const int n = std::min(maxSlice, numSamples - offset);
+
+        hpf_.run(buffer + offset, det, n);
+        if (config_.enableLpf) lpf_.run(det, det, n);
+
+        for (int i = 0; i < n; i += kDetectChunk) {
+            const int    len = std::min(kDetectChunk, n - i);
+            const float* x   = det + i;
+
+            float level = 0.f;
+            if (rms) {
+                // Mean square, averaged over kRmsWindowMs, then the ballistics
+                float sum = 0.f;
+                for (int j = 0; j < len; ++j) sum += x[j] * x[j];
+                const float meanSquare = sum / static_cast<float>(len);
+                power = meanSquare + rmsCoeff_[len - 1] * (power - meanSquare);
+                level = std::sqrt(power);
+            } else {
+                for (int j = 0; j < len; ++j) level = std::max(level, std::fabs(x[j]));
+            }
+            level = std::min(level, 1.f);
+
+            const float coeff = level > env ? attackCoeff_[len - 1] : releaseCoeff_[len - 1];
+            const float next  = level + coeff * (env - level);
+
+            if (envelopeOut) {
+                float*      out  = envelopeOut + offset + i;
+                const float step = (next - env) / static_cast<float>(len);
+                for (int j = 0; j < len; ++j) out[j] = env + step * static_cast<float>(j + 1);
+                out[len - 1] = next;
+            }
+            env = next;
+        }
+    }
+
+    envelope_ = env;
+    power_    = power;
+    return env;
+}
+
+// Block-sized slices through the ring: delayOut_ is its scratch.
+void EnvelopeFollower::delayAudio(float* buffer, int numSamples)
+{
+    if (lookaheadSamples_ == 0) return;
+
+    const int maxSlice = static_cast<int>(delayOut_.size());
+    for (int offset = 0; offset < numSamples; offset += maxSlice) {
+        delay_.process(buffer + offset, std::min(maxSlice, numSamples - offset), 1, delayOut_.data());
+    }
+}
+
+} // namespace hexcaster
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <iterator>
 
 namespace hexcaster {
 
@@ -13,11 +15,31 @@ void MidSweepEQ::prepare(float sampleRate, int /*maxBlockSize*/)
 {
     sampleRate_ = sampleRate;
 
-    // Force coefficient recompute on first block by making cache differ from atomics
-    cachedGainDb_  = gainDb_.load(std::memory_order_relaxed) + 1.f;  // != current value
-    cachedSweepHz_ = 0.f;
-    cachedQ_       = 0.f;
+    // Design tables: cos/sin of w0 on a linear Hz grid over the sweep range,
+    // and A = 10^(dB/40) on a linear dB grid over the gain range.
+    const double twoPiOverFs = 2.0 * M_PI / sampleRate;
+    for (int i = 0; i <= kSweepTableSize; ++i) {
+        const double hz = kMinSweepHz + (kMaxSweepHz - kMinSweepHz) * i / kSweepTableSize;
+        cosTable_[i] = static_cast<float>(std::cos(twoPiOverFs * hz));
+        sinTable_[i] = static_cast<float>(std::sin(twoPiOverFs * hz));
+    }
+    for (int i = 0; i <= kGainTableSize; ++i) {
+        const double db = kMinGainDb + (kMaxGainDb - kMinGainDb) * i / kGainTableSize;
+        ampTable_[i] = static_cast<float>(std::pow(10.0, db / 40.0));
+    }
 
+    // One smoother step per coefficient interval.
+    const float controlRate = sampleRate / static_cast<float>(kCoeffInterval);
+    gainSmoother_ .prepare(controlRate, kSmoothingMs);
+    sweepSmoother_.prepare(controlRate, kSmoothingMs);
+    qSmoother_    .prepare(controlRate, kSmoothingMs);
+    gainSmoother_ .snap(gainDb_.load(std::memory_order_relaxed));
+    sweepSmoother_.snap(sweepHz_.load(std::memory_order_relaxed));
+    qSmoother_    .snap(q_.load(std::memory_order_relaxed));
+
+    c_ = designFromTables(gainSmoother_.getCurrentValue(),
+                          sweepSmoother_.getCurrentValue(),
+                          qSmoother_.getCurrentValue());
     reset();
 }
 
@@ -25,51 +47,156 @@ void MidSweepEQ::reset()
 {
     z1_ = 0.f;
     z2_ = 0.f;
+    std::fill(std::begin(chZ1_), std::end(chZ1_), 0.f);
+    std::fill(std::begin(chZ2_), std::end(chZ2_), 0.f);
+}
+
+// One control-rate smoother step; snaps to the target once within tolerance
+// so the fixed-coefficient path resumes.
+static float stepSmoother(ParamSmoother& s, float tolerance)
+{
+    const float v = s.next();
+    if (std::fabs(v - s.getTargetValue()) <= tolerance) {
+        s.snap(s.getTargetValue());
+        return s.getTargetValue();
+    }
+    return v;
 }
 
 void MidSweepEQ::process(float* buffer, int numSamples)
 {
-    // Read atomics once per block
-    const float gainDb  = gainDb_.load(std::memory_order_relaxed);
-    const float sweepHz = sweepHz_.load(std::memory_order_relaxed);
-    const float q       = q_.load(std::memory_order_relaxed);
+    process(buffer, numSamples, OutputGain{});
+}
 
-    // Recompute coefficients only if parameters have changed
-    if (gainDb  != cachedGainDb_  ||
-        sweepHz != cachedSweepHz_ ||
-        q       != cachedQ_)
+void MidSweepEQ::readTargets()
+{
+    gainSmoother_ .setTarget(gainDb_.load(std::memory_order_relaxed));
+    sweepSmoother_.setTarget(sweepHz_.load(std::memory_order_relaxed));
+    qSmoother_    .setTarget(q_.load(std::memory_order_relaxed));
+}
+
+template <typename Kernel>
+void MidSweepEQ::runFiltered(int numSamples, Kernel&& kernel)
+{
+    BiquadCoeffs c = c_;
+    int          i = 0;
+
+    // Sweeping: step the parameters once per interval and slide the
+    // coefficients linearly toward the new design over that interval.
+    while (i < numSamples &&
+           !(gainSmoother_.isSettled() && sweepSmoother_.isSettled() && qSmoother_.isSettled()))
     {
-        cachedGainDb_  = gainDb;
-        cachedSweepHz_ = sweepHz;
-        cachedQ_       = q;
-        updateCoefficients();
+        const BiquadCoeffs t = designFromTables(stepSmoother(gainSmoother_,  1e-3f),
+                                                stepSmoother(sweepSmoother_, 1e-2f),
+                                                stepSmoother(qSmoother_,     1e-4f));
+        const int   len = std::min(kCoeffInterval, numSamples - i);
+        const float inv = 1.f / static_cast<float>(len);
+        const BiquadCoeffs d{ (t.b0 - c.b0) * inv, (t.b1 - c.b1) * inv, (t.b2 - c.b2) * inv,
+                              (t.a1 - c.a1) * inv, (t.a2 - c.a2) * inv };
+
+        for (const int end = i + len; i < end; ++i) {
+            c.b0 += d.b0; c.b1 += d.b1; c.b2 += d.b2;
+            c.a1 += d.a1; c.a2 += d.a2;
+            kernel(i, c);
+        }
+        c = t;   // land exactly, no accumulated drift
     }
 
+    // Settled: fixed coefficients.
+    for (; i < numSamples; ++i) kernel(i, c);
+
+    c_ = c;
+}
+
+void MidSweepEQ::process(float* buffer, int numSamples, const OutputGain& outputGain)
+{
+    // Output gain scales y on its way out; it never enters the recurrence.
+    const float* g = outputGain.perSample;
+    const float  k = outputGain.constant;
+
+    readTargets();
+
     // Biquad Direct Form II Transposed
     // y[n]  = b0*x[n] + z1
     // z1   <- b1*x[n] - a1*y[n] + z2
     // z2   <- b2*x[n] - a2*y[n]
     float z1 = z1_, z2 = z2_;
-
-    for (int i = 0; i < numSamples; ++i) {
+    runFiltered(numSamples, [&](int i, const BiquadCoeffs& c) {
         const float x = buffer[i];
-        const float y = b0_ * x + z1;
-        z1 = b1_ * x - a1_ * y + z2;
-        z2 = b2_ * x - a2_ * y;
-        buffer[i] = y;
-    }
-
+        const float y = c.b0 * x + z1;
+        z1 = c.b1 * x - c.a1 * y + z2;
+        z2 = c.b2 * x - c.a2 * y;
+        buffer[i] = y * (g ? g[i] : k);
+    });
     z1_ = z1;
     z2_ = z2;
 }
 
+void MidSweepEQ::processChannels(const AudioBlock& block)
+{
+    if (block.numChannels == 1) {
+        process(block.channels[0], block.numSamples);
+    } else if (block.numChannels <= 4) {
+        processLanes<4>(block);
+    } else {
+        processLanes<8>(block);
+    }
+}
+
+// The mono recurrence with channel c in lane c. Chunks are a whole number
+// of coefficient intervals, so the sweep steps exactly as in process().
+template <int N>
+void MidSweepEQ::processLanes(const AudioBlock& block)
+{
+    using Lanes = ChannelLanes<N>;
+    static_assert(kLaneChunk % kCoeffInterval == 0);
+
+    readTargets();
+
+    Lanes z1, z2;
+    for (int c = 0; c < N; ++c) {
+        z1[c] = chZ1_[c];
+        z2[c] = chZ2_[c];
+    }
+
+    Lanes x[kLaneChunk];
+    for (int offset = 0; offset < block.numSamples; offset += kLaneChunk) {
+        const int len = std::min(kLaneChunk, block.numSamples - offset);
+        loadLanes<N>(block, offset, len, x);
+        runFiltered(len, [&](int i, const BiquadCoeffs& c) {
+            const Lanes in = x[i];
+            const Lanes y  = c.b0 * in + z1;
+            z1   = c.b1 * in - c.a1 * y + z2;
+            z2   = c.b2 * in - c.a2 * y;
+            x[i] = y;
+        });
+        storeLanes<N>(x, offset, len, block);
+    }
+
+    // Unused lanes filtered zeros: their state is still zero.
+    for (int c = 0; c < N; ++c) {
+        chZ1_[c] = z1[c];
+        chZ2_[c] = z2[c];
+    }
+}
+
+bool MidSweepEQ::isIdentity() const
+{
+    float state = std::fabs(z1_) + std::fabs(z2_);
+    for (int c = 0; c < AudioBlock::kMaxChannels; ++c) state += std::fabs(chZ1_[c]) + std::fabs(chZ2_[c]);
+
+    return gainDb_.load(std::memory_order_relaxed) == 0.f
+        && gainSmoother_.isSettled() && gainSmoother_.getCurrentValue() == 0.f
+        && state < kIdentityStateEpsilon;
+}
+
 // ---------------------------------------------------------------------------
 // Parameter setters / getters
 // ---------------------------------------------------------------------------
 
-void MidSweepEQ::setGainDb (float db) { gainDb_.store (std::clamp(db,   -12.f,  12.f), std::memory_order_relaxed); }
-void MidSweepEQ::setSweepHz(float hz) { sweepHz_.store(std::clamp(hz,  300.f, 2500.f), std::memory_order_relaxed); }
-void MidSweepEQ::setQ      (float q)  { q_.store      (std::clamp(q,    0.3f,   3.f ), std::memory_order_relaxed); }
+void MidSweepEQ::setGainDb (float db) { gainDb_.store (std::clamp(db, kMinGainDb,  kMaxGainDb),  std::memory_order_relaxed); }
+void MidSweepEQ::setSweepHz(float hz) { sweepHz_.store(std::clamp(hz, kMinSweepHz, kMaxSweepHz), std::memory_order_relaxed); }
+void MidSweepEQ::setQ      (float q)  { q_.store      (std::clamp(q,  kMinQ,       kMaxQ),       std::memory_order_relaxed); }
 
 float MidSweepEQ::getGainDb()  const { return gainDb_.load (std::memory_order_relaxed); }
 float MidSweepEQ::getSweepHz() const { return sweepHz_.load(std::memory_order_relaxed); }
@@ -77,35 +204,330 @@ float MidSweepEQ::getQ()       const { return q_.load      (std::memory_order_re
 
 // ---------------------------------------------------------------------------
 // Coefficient computation
-// Audio EQ Cookbook -- peaking EQ filter
 // ---------------------------------------------------------------------------
 
-void MidSweepEQ::updateCoefficients()
+// Same peaking formulas as designBiquad(), with cos/sin/pow replaced by
+// table lookups (linear interpolation; error < 1e-6 on cos/sin, < 3e-5
+// relative on A).
+BiquadCoeffs MidSweepEQ::designFromTables(float gainDb, float sweepHz, float q) const
 {
-    // A = amplitude from dB (sqrt form for peaking filter)
-    const float A  = std::pow(10.f, cachedGainDb_ / 40.f);
+    auto lookup = [](float pos, int size, int& index) {
+        pos   = std::clamp(pos, 0.f, static_cast<float>(size));
+        index = std::min(static_cast<int>(pos), size - 1);
+        return pos - static_cast<float>(index);
+    };
 
-    const float w0    = 2.f * static_cast<float>(M_PI) * cachedSweepHz_ / sampleRate_;
+    int si, gi;
+    const float sf = lookup((sweepHz - kMinSweepHz) * (kSweepTableSize / (kMaxSweepHz - kMinSweepHz)),
+                            kSweepTableSize, si);
+    const float gf = lookup((gainDb - kMinGainDb) * (kGainTableSize / (kMaxGainDb - kMinGainDb)),
+                            kGainTableSize, gi);
+
+    const float cosw0 = cosTable_[si] + sf * (cosTable_[si + 1] - cosTable_[si]);
+    const float sinw0 = sinTable_[si] + sf * (sinTable_[si + 1] - sinTable_[si]);
+    const float A     = ampTable_[gi] + gf * (ampTable_[gi + 1] - ampTable_[gi]);
+    const float alpha = sinw0 / (2.f * q);
+
+    const float invA0 = 1.f / (1.f + alpha / A);
+    BiquadCoeffs c;
+    c.b0 = (1.f + alpha * A) * invA0;
+    c.b1 = (-2.f * cosw0)    * invA0;
+    c.b2 = (1.f - alpha * A) * invA0;
+    c.a1 = c.b1;
+    c.a2 = (1.f - alpha / A) * invA0;
+    return c;
+}
+
+// Audio EQ Cookbook (R. Bristow-Johnson). All shapes share w0 and alpha;
+// the results are normalised by a0 so only b0,b1,b2,a1,a2 are stored.
+BiquadCoeffs designBiquad(BiquadType type, float sampleRate,
+                          float freqHz, float gainDb, float q)
+{
+    BiquadCoeffs c;
+    if (type == BiquadType::Off) return c;
+
+    // A = amplitude from dB (sqrt form for peaking/shelving filters)
+    const float A     = std::pow(10.f, gainDb / 40.f);
+    const float w0    = 2.f * static_cast<float>(M_PI) * freqHz / sampleRate;
     const float cosw0 = std::cos(w0);
     const float sinw0 = std::sin(w0);
-    const float alpha = sinw0 / (2.f * cachedQ_);
-
-    //   b0 =   1 + alpha*A
-    //   b1 =  -2*cos(w0)
-    //   b2 =   1 - alpha*A
-    //   a0 =   1 + alpha/A
-    //   a1 =  -2*cos(w0)       (same as b1)
-    //   a2 =   1 - alpha/A
-    //
-    // Normalise by a0 so we store only b0,b1,b2,a1,a2 (a0 = 1 after normalisation).
-
-    const float a0 = 1.f + alpha / A;
-
-    b0_ = (1.f + alpha * A) / a0;
-    b1_ = (-2.f * cosw0)    / a0;
-    b2_ = (1.f - alpha * A) / a0;
-    a1_ = (-2.f * cosw0)    / a0;
-    a2_ = (1.f - alpha / A) / a0;
+    const float alpha = sinw0 / (2.f * q);
+
+    float b0 = 1.f, b1 = 0.f, b2 = 0.f, a0 = 1.f, a1 = 0.f, a2 = 0.f;
+
+    switch (type) {
+        case BiquadType::Peak:
+            //   b0 = 1 + alpha*A     a0 = 1 + alpha/A
+            //   b1 = -2*cos(w0)      a1 = -2*cos(w0)
+            //   b2 = 1 - alpha*A     a2 = 1 - alpha/A
+            // At 0 dB (A = 1) the alpha terms cancel: unity.
+            b0 = 1.f + alpha * A;
+            b1 = -2.f * cosw0;
+            b2 = 1.f - alpha * A;
+            a0 = 1.f + alpha / A;
+            a1 = -2.f * cosw0;
+            a2 = 1.f - alpha / A;
+            break;
+
+        case BiquadType::LowShelf: {
+            const float sq = 2.f * std::sqrt(A) * alpha;
+            b0 =        A * ((A + 1.f) - (A - 1.f) * cosw0 + sq);
+            b1 =  2.f * A * ((A - 1.f) - (A + 1.f) * cosw0);
+            b2 =        A * ((A + 1.f) - (A - 1.f) * cosw0 - sq);
+            a0 =             (A + 1.f) + (A - 1.f) * cosw0 + sq;
+            a1 = -2.f *     ((A - 1.f) + (A + 1.f) * cosw0);
+            a2 =             (A + 1.f) + (A - 1.f) * cosw0 - sq;
+            break;
+        }
+
+        case BiquadType::HighShelf: {
+            const float sq = 2.f * std::sqrt(A) * alpha;
+            b0 =        A * ((A + 1.f) + (A - 1.f) * cosw0 + sq);
+            b1 = -2.f * A * ((A - 1.f) + (A + 1.f) * cosw0);
+            b2 =        A * ((A + 1.f) + (A - 1.f) * cosw0 - sq);
+            a0 =             (A + 1.f) - (A - 1.f) * cosw0 + sq;
+            a1 =  2.f *     ((A - 1.f) - (A + 1.f) * cosw0);
+            a2 =             (A + 1.f) - (A - 1.f) * cosw0 - sq;
+            break;
+        }
+
+        case BiquadType::LowPass:
+            b0 = (1.f - cosw0) * 0.5f;
+            b1 =  1.f - cosw0;
+            b2 = (1.f - cosw0) * 0.5f;
+            a0 =  1.f + alpha;
+            a1 = -2.f * cosw0;
+            a2 =  1.f - alpha;
+            break;
+
+        case BiquadType::HighPass:
+            b0 =  (1.f + cosw0) * 0.5f;
+            b1 = -(1.f + cosw0);
+            b2 =  (1.f + cosw0) * 0.5f;
+            a0 =   1.f + alpha;
+            a1 =  -2.f * cosw0;
+            a2 =   1.f - alpha;
+            break;
+
+        case BiquadType::Off:
+            break;
+    }
+
+    c.b0 = b0 / a0;
+    c.b1 = b1 / a0;
+    c.b2 = b2 / a0;
+    c.a1 = a1 / a0;
+    c.a2 = a2 / a0;
+    return c;
+}
+
+// ===========================================================================
+// ParametricEQ
+// ===========================================================================
+
+// One lane per band (GCC/Clang vector extension). Element-wise arithmetic
+// lowers to SSE/AVX on x86 and NEON on the Pi; no intrinsics needed.
+using BandLanes = float __attribute__((vector_size(ParametricEQ::kMaxBands * sizeof(float))));
+
+void ParametricEQ::prepare(float sampleRate, int /*maxBlockSize*/)
+{
+    sampleRate_ = sampleRate;
+    cacheValid_ = false;   // recompute every band on the first block
+    reset();
+}
+
+void ParametricEQ::reset()
+{
+    for (int k = 0; k < kMaxBands; ++k) {
+        z1_[k] = 0.f;
+        z2_[k] = 0.f;
+    }
+}
+
+void ParametricEQ::process(float* buffer, int numSamples)
+{
+    constexpr int K = kMaxBands;
+
+    // Read atomics once per block; recompute only bands that changed.
+    bool changed = !cacheValid_;
+    for (int k = 0; k < K; ++k) {
+        const Band band = getBand(k);
+        const Band& old = cached_[k];
+        if (!cacheValid_ || band.type != old.type || band.freqHz != old.freqHz ||
+            band.gainDb != old.gainDb || band.q != old.q) {
+            cached_[k] = band;
+            updateCoefficients(k, band);
+            changed = true;
+        }
+    }
+    if (changed) {
+        cacheValid_  = true;
+        activeBands_ = 0;
+        for (int k = 0; k < K; ++k) {
+            if (cached_[k].type != BiquadType::Off) activeBands_ = k + 1;
+        }
+    }
+
+    const int L = activeBands_;
+    if (L == 0) return;
+
+    // Skewed cascade: at step t lane k filters sample t - k, fed by lane
+    // k - 1's output from step t - 1. Lanes past L are Off (identity, zero
+    // state) and just pass values along.
+    //   y[k]   = b0*x[k] + z1[k]
+    //   z1[k] <- b1*x[k] - a1*y[k] + z2[k]
+    //   z2[k] <- b2*x[k] - a2*y[k]
+    BandLanes b0, b1, b2, a1, a2, z1, z2;
+    std::memcpy(&b0, b0_, sizeof(b0));
+    std::memcpy(&b1, b1_, sizeof(b1));
+    std::memcpy(&b2, b2_, sizeof(b2));
+    std::memcpy(&a1, a1_, sizeof(a1));
+    std::memcpy(&a2, a2_, sizeof(a2));
+    std::memcpy(&z1, z1_, sizeof(z1));
+    std::memcpy(&z2, z2_, sizeof(z2));
+    BandLanes y = {};
+
+    auto step = [&](float input) {
+        BandLanes x;
+        x[0] = input;
+        for (int k = 1; k < K; ++k) x[k] = y[k - 1];
+        y  = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+    };
+
+    // Filling or draining the wavefront: only lanes [lo, hi] hold real
+    // samples; the others step on padding and get their state back.
+    auto edgeStep = [&](float input, int lo, int hi) {
+        const BandLanes s1 = z1, s2 = z2;
+        step(input);
+        for (int k = 0; k < K; ++k) {
+            if (k < lo || k > hi) { z1[k] = s1[k]; z2[k] = s2[k]; }
+        }
+    };
+
+    const int fill  = L - 1;           // first step with every lane < L valid
+    const int steps = numSamples + fill;
+    int t = 0;
+
+    for (; t < std::min(fill, steps); ++t) {
+        edgeStep(t < numSamples ? buffer[t] : 0.f, std::max(0, t - numSamples + 1), t);
+    }
+    for (; t < numSamples; ++t) {
+        step(buffer[t]);
+        buffer[t - fill] = y[L - 1];
+    }
+    for (; t < steps; ++t) {
+        edgeStep(0.f, t - numSamples + 1, L - 1);
+        buffer[t - fill] = y[L - 1];
+    }
+
+    std::memcpy(z1_, &z1, sizeof(z1));
+    std::memcpy(z2_, &z2, sizeof(z2));
+}
+
+bool ParametricEQ::isIdentity() const
+{
+    for (const BandParams& p : params_) {
+        if (p.type.load(std::memory_order_relaxed) != BiquadType::Off) return false;
+    }
+    return true;
+}
+
+void ParametricEQ::setBand(int index, const Band& band)
+{
+    if (index < 0 || index >= kMaxBands) return;
+    BandParams& p = params_[index];
+    p.freqHz.store(std::max(band.freqHz, kMinFreqHz),                std::memory_order_relaxed);
+    p.gainDb.store(std::clamp(band.gainDb, kMinGainDb, kMaxGainDb), std::memory_order_relaxed);
+    p.q     .store(std::clamp(band.q,      kMinQ,      kMaxQ),      std::memory_order_relaxed);
+    p.type  .store(band.type,                                        std::memory_order_relaxed);
+}
+
+void ParametricEQ::setBand(int index, BiquadType type, float freqHz, float gainDb, float q)
+{
+    setBand(index, Band{ type, freqHz, gainDb, q });
+}
+
+ParametricEQ::Band ParametricEQ::getBand(int index) const
+{
+    if (index < 0 || index >= kMaxBands) return {};
+    const BandParams& p = params_[index];
+    Band b;
+    b.type   = p.type  .load(std::memory_order_relaxed);
+    b.freqHz = p.freqHz.load(std::memory_order_relaxed);
+    b.gainDb = p.gainDb.load(std::memory_order_relaxed);
+    b.q      = p.q     .load(std::memory_order_relaxed);
+    return b;
+}
+
+// Audio thread, only when a band's parameters changed.
+void ParametricEQ::updateCoefficients(int index, const Band& band)
+{
+    const float freqHz = std::clamp(band.freqHz, kMinFreqHz, 0.49f * sampleRate_);
+    const BiquadCoeffs c = designBiquad(band.type, sampleRate_, freqHz, band.gainDb, band.q);
+    b0_[index] = c.b0;
+    b1_[index] = c.b1;
+    b2_[index] = c.b2;
+    a1_[index] = c.a1;
+    a2_[index] = c.a2;
+
+    // An Off band is an identity lane; its state must stay zero.
+    if (band.type == BiquadType::Off) {
+        z1_[index] = 0.f;
+        z2_[index] = 0.f;
+    }
+}
+
+// ===========================================================================
+// ToneEQ
+// ===========================================================================
+
+ToneEQ::ToneEQ()
+{
+    // Every band Off, parked at its default frequency.
+    setBand(kLowCutBand,  BiquadType::Off, kMinLowCutHz,  0.f, kCutQ);
+    setBand(kBassBand,    BiquadType::Off, 120.f,         0.f, kShelfQ);
+    setBand(kTrebleBand,  BiquadType::Off, 3000.f,        0.f, kShelfQ);
+    setBand(kHighCutBand, BiquadType::Off, kMaxHighCutHz, 0.f, kCutQ);
+}
+
+void ToneEQ::setLowCutHz (float hz) { setCut(kLowCutBand,  BiquadType::HighPass, std::clamp(hz, kMinLowCutHz,  kMaxLowCutHz),  kMinLowCutHz); }
+void ToneEQ::setHighCutHz(float hz) { setCut(kHighCutBand, BiquadType::LowPass,  std::clamp(hz, kMinHighCutHz, kMaxHighCutHz), kMaxHighCutHz); }
+void ToneEQ::setBassDb   (float db) { setShelf(kBassBand,   BiquadType::LowShelf,  db); }
+void ToneEQ::setTrebleDb (float db) { setShelf(kTrebleBand, BiquadType::HighShelf, db); }
+void ToneEQ::setBassHz   (float hz) { setShelfHz(kBassBand,   std::clamp(hz, kMinBassHz,   kMaxBassHz)); }
+void ToneEQ::setTrebleHz (float hz) { setShelfHz(kTrebleBand, std::clamp(hz, kMinTrebleHz, kMaxTrebleHz)); }
+
+// Hosts call the setters every block from the registry; a band is only
+// rewritten when its value actually changed.
+void ToneEQ::setCut(int band, BiquadType type, float hz, float offHz)
+{
+    Band b = getBand(band);
+    const BiquadType t = hz == offHz ? BiquadType::Off : type;
+    if (b.type == t && b.freqHz == hz) return;
+    b.type   = t;
+    b.freqHz = hz;
+    setBand(band, b);
+}
+
+void ToneEQ::setShelf(int band, BiquadType type, float db)
+{
+    Band b = getBand(band);
+    db = std::clamp(db, kMinShelfDb, kMaxShelfDb);
+    const BiquadType t = db == 0.f ? BiquadType::Off : type;
+    if (b.type == t && b.gainDb == db) return;
+    b.type   = t;
+    b.gainDb = db;
+    setBand(band, b);
+}
+
+void ToneEQ::setShelfHz(int band, float hz)
+{
+    Band b = getBand(band);
+    if (b.freqHz == hz) return;
+    b.freqHz = hz;
+    setBand(band, b);
 }
 
 } // namespace hexcaster
@@ -22,24 +22,88 @@ GainStage::GainStage()
     targetGainLinear_.store(1.f, std::memory_order_relaxed);
 }
 
-void GainStage::prepare(float sampleRate, int /*maxBlockSize*/)
+void GainStage::prepare(float sampleRate, int maxBlockSize)
 {
+    ramp_.assign(static_cast<std::size_t>(std::max(maxBlockSize, 1)), 1.f);
     smoother_.prepare(sampleRate, kSmoothingMs);
     smoother_.snap(targetGainLinear_.load(std::memory_order_relaxed));
 }
 
 void GainStage::process(float* buffer, int numSamples)
 {
+    if (trajectory_) {
+        const float* g = trajectory_;
+        trajectory_ = nullptr;
+        if (numSamples <= 0) return;
+        for (int i = 0; i < numSamples; ++i) {
+            buffer[i] *= g[i];
+        }
+        smoother_.snap(g[numSamples - 1]);
+        return;
+    }
+
     const float target = targetGainLinear_.load(std::memory_order_relaxed);
     smoother_.setTarget(target);
 
-    for (int i = 0; i < numSamples; ++i) {
-        buffer[i] *= smoother_.next();
+    if (smoother_.isSettled()) {
+        if (target == 1.f) return;
+        for (int i = 0; i < numSamples; ++i) {
+            buffer[i] *= target;
+        }
+        return;
+    }
+
+    smoother_.multiplyBlock(buffer, numSamples);
+}
+
+void GainStage::processChannels(const AudioBlock& block)
+{
+    const int        n    = block.numSamples;
+    const OutputGain gain = nextGain(n);
+    if (gain.isUnity()) return;
+
+    for (int c = 0; c < block.numChannels; ++c) {
+        float* x = block.channels[c];
+        if (gain.perSample) {
+            const float* g = gain.perSample;
+            for (int i = 0; i < n; ++i) x[i] *= g[i];
+        } else {
+            const float k = gain.constant;
+            for (int i = 0; i < n; ++i) x[i] *= k;
+        }
     }
 }
 
+OutputGain GainStage::nextGain(int numSamples)
+{
+    if (trajectory_) {
+        const float* g = trajectory_;
+        trajectory_ = nullptr;
+        if (numSamples > 0) smoother_.snap(g[numSamples - 1]);
+        return { g, 1.f };
+    }
+
+    const float target = targetGainLinear_.load(std::memory_order_relaxed);
+    smoother_.setTarget(target);
+    if (smoother_.isSettled()) return { nullptr, target };
+
+    // The ramp process() would multiply in, applied to ones.
+    const int n = std::min(numSamples, static_cast<int>(ramp_.size()));
+    std::fill(ramp_.begin(), ramp_.begin() + n, 1.f);
+    smoother_.multiplyBlock(ramp_.data(), n);
+    return { ramp_.data(), 1.f };
+}
+
+bool GainStage::isIdentity() const
+{
+    return trajectory_ == nullptr
+        && smoother_.isSettled() && smoother_.getCurrentValue() == 1.f
+        && targetGainLinear_.load(std::memory_order_relaxed) == 1.f;
+}
+
 void GainStage::reset()
 {
+    trajectory_ = nullptr;
     smoother_.snap(targetGainLinear_.load(std::memory_order_relaxed));
 }
 
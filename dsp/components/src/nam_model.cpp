@@ -0,0 +1,164 @@
+#include "hexcaster/nam_model.h"
+#include "NeuralAudio/NeuralModel.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace hexcaster {
+
+// ---------------------------------------------------------------------------
+// .nam config scanning
+//
+// Only the few keys that set the receptive field are looked up, by name,
+// in file order -- not a JSON parser. Each layer array of a WaveNet has one
+// "kernel_size" and one "dilations", so the i-th of each pair up.
+// ---------------------------------------------------------------------------
+
+// Offsets just past the ':' of every `"key":` in text.
+static std::vector<std::size_t> valuesOf(const std::string& text, const std::string& key)
+{
+    std::vector<std::size_t> values;
+    const std::string quoted = '"' + key + '"';
+    for (std::size_t pos = text.find(quoted); pos != std::string::npos;
+         pos = text.find(quoted, pos + 1)) {
+        const std::size_t colon = text.find_first_not_of(" \t\r\n", pos + quoted.size());
+        if (colon != std::string::npos && text[colon] == ':') values.push_back(colon + 1);
+    }
+    return values;
+}
+
+static long intAt(const std::string& text, std::size_t pos)
+{
+    return std::strtol(text.c_str() + pos, nullptr, 10);
+}
+
+// Sum of the integer array starting at pos ("[1, 2, 4]" -> 7).
+static long arraySumAt(const std::string& text, std::size_t pos)
+{
+    const std::size_t open  = text.find('[', pos);
+    const std::size_t close = text.find(']', pos);
+    if (open == std::string::npos || close == std::string::npos || close < open) return 0;
+
+    long        sum = 0;
+    const char* p   = text.c_str() + open + 1;
+    const char* end = text.c_str() + close;
+    while (p < end) {
+        char* next = nullptr;
+        sum += std::strtol(p, &next, 10);
+        if (next == p) ++p;   // skip ',' and whitespace
+        else           p = next;
+    }
+    return sum;
+}
+
+int NamModel::receptiveField(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) return 0;
+    const std::string text{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    const std::vector<std::size_t> arch = valuesOf(text, "architecture");
+    if (arch.empty()) return 0;
+    const std::size_t quote = text.find('"', arch.front());
+    const std::string name  = quote == std::string::npos ? std::string()
+                            : text.substr(quote + 1, text.find('"', quote + 1) - quote - 1);
+
+    if (name == "Linear") {
+        const std::vector<std::size_t> rf = valuesOf(text, "receptive_field");
+        return rf.empty() ? 0 : static_cast<int>(intAt(text, rf.front()));
+    }
+
+    if (name == "WaveNet" || name == "ConvNet") {
+        // Each dilated conv of kernel k adds (k - 1) * dilation samples.
+        // ConvNet's convolutions are all kernel 2.
+        const std::vector<std::size_t> dilations = valuesOf(text, "dilations");
+        const std::vector<std::size_t> kernels   = valuesOf(text, "kernel_size");
+        if (name == "WaveNet" && kernels.size() != dilations.size()) return 0;
+
+        long field = 1;
+        for (std::size_t i = 0; i < dilations.size(); ++i) {
+            const long k = name == "WaveNet" ? intAt(text, kernels[i]) : 2;
+            field += (k - 1) * arraySumAt(text, dilations[i]);
+        }
+        return static_cast<int>(field);
+    }
+
+    return 0;   // LSTM, GRU: recurrent
+}
+
+NamModel::NamModel()  = default;
+NamModel::~NamModel() = default;
+
+bool NamModel::load(const std::string& path, int maxBlockSize)
+{
+    NeuralAudio::NeuralModel* raw = nullptr;
+
+    try {
+        raw = NeuralAudio::NeuralModel::CreateFromFile(path.c_str());
+    } catch (const std::exception& e) {
+        errorMsg_ = "failed to load model '" + path + "': " + e.what();
+        return false;
+    } catch (...) {
+        errorMsg_ = "failed to load model '" + path + "'";
+        return false;
+    }
+
+    if (!raw) {
+        errorMsg_ = "failed to load model '" + path + "'";
+        return false;
+    }
+
+    model_.reset(raw);
+    path_ = path;
+
+    const float inDb  = model_->GetRecommendedInputDBAdjustment();
+    const float outDb = model_->GetRecommendedOutputDBAdjustment();
+    inputGainLinear_  = std::pow(10.f, inDb  / 20.f);
+    outputGainLinear_ = std::pow(10.f, outDb / 20.f);
+
+    if (maxBlockSize > 0) {
+        setMaxBlockSize(maxBlockSize);
+        warmUp(kWarmupSamples);
+    }
+    return true;
+}
+
+void NamModel::setMaxBlockSize(int maxBlockSize)
+{
+    maxBlockSize_ = maxBlockSize;
+    if (model_) model_->SetMaxAudioBufferSize(maxBlockSize);
+}
+
+void NamModel::warmUp(int numSamples)
+{
+    if (!model_ || maxBlockSize_ <= 0) return;
+
+    std::vector<float> silence(static_cast<std::size_t>(maxBlockSize_), 0.f);
+    std::vector<float> discard(static_cast<std::size_t>(maxBlockSize_), 0.f);
+    for (int done = 0; done < numSamples; done += maxBlockSize_) {
+        model_->Process(silence.data(), discard.data(),
+                        static_cast<std::size_t>(maxBlockSize_));
+    }
+}
+
+void NamModel::process(float* input, float* output, int numSamples)
+{
+    if (inputGainLinear_ != 1.f) {
+        for (int i = 0; i < numSamples; ++i) {
+            input[i] *= inputGainLinear_;
+        }
+    }
+
+    model_->Process(input, output, static_cast<std::size_t>(numSamples));
+
+    if (outputGainLinear_ != 1.f) {
+        for (int i = 0; i < numSamples; ++i) {
+            output[i] *= outputGainLinear_;
+        }
+    }
+}
+
+} // namespace hexcaster
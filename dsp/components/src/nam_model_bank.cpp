@@ -0,0 +1,66 @@
+#include "hexcaster/nam_model_bank.h"
+
+#include <algorithm>
+
+namespace hexcaster {
+
+NamModelBank::~NamModelBank()
+{
+    if (loader_.joinable()) loader_.join();
+}
+
+bool NamModelBank::load(const std::vector<std::string>& paths, int maxBlockSize)
+{
+    allLoaded_ = loadAll(paths, maxBlockSize);
+    return allLoaded_;
+}
+
+void NamModelBank::loadAsync(std::vector<std::string> paths, int maxBlockSize)
+{
+    if (loader_.joinable()) loader_.join();
+    loader_ = std::thread([this, paths = std::move(paths), maxBlockSize]() {
+        allLoaded_ = loadAll(paths, maxBlockSize);
+    });
+}
+
+bool NamModelBank::wait()
+{
+    if (loader_.joinable()) loader_.join();
+    return allLoaded_;
+}
+
+NamModel* NamModelBank::model(int index) const
+{
+    if (index < 0 || index >= size()) return nullptr;
+    return published_[index].load(std::memory_order_acquire);
+}
+
+void NamModelBank::setMaxBlockSize(int maxBlockSize)
+{
+    for (int i = 0; i < size(); ++i) {
+        if (NamModel* m = published_[i].load(std::memory_order_acquire))
+            m->setMaxBlockSize(maxBlockSize);
+    }
+}
+
+bool NamModelBank::loadAll(const std::vector<std::string>& paths, int maxBlockSize)
+{
+    const int count = std::min(static_cast<int>(paths.size()), kMaxModels);
+    size_.store(count, std::memory_order_release);
+
+    bool ok = true;
+    for (int i = 0; i < count; ++i) {
+        auto model = std::make_unique<NamModel>();
+        if (!model->load(paths[static_cast<std::size_t>(i)], maxBlockSize)) {
+            if (!errorMsg_.empty()) errorMsg_ += "; ";
+            errorMsg_ += "slot " + std::to_string(i) + ": " + model->errorMessage();
+            ok = false;
+            continue;
+        }
+        owned_[i] = std::move(model);
+        published_[i].store(owned_[i].get(), std::memory_order_release);
+    }
+    return ok;
+}
+
+} // namespace hexcaster
@@ -1,63 +1,102 @@
 #include "hexcaster/nam_stage.h"
+#include "hexcaster/nam_model.h"
+#include "hexcaster/nam_model_bank.h"
 #include "NeuralAudio/NeuralModel.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
+#include <memory>
 
 namespace hexcaster {
 
+// Poll interval for the reclaimer. The audio thread cannot signal a condvar,
+// so retired slots wait at most this long before being freed (publish()
+// also wakes it).
+static constexpr auto kReclaimInterval = std::chrono::milliseconds(50);
+
+struct NamStage::Slot {
+    std::unique_ptr<NamModel> owned;            // set for loadModel()
+    NamModel*                 model = nullptr;  // what runs; null = passthrough
+};
+
 NamStage::NamStage() = default;
-NamStage::~NamStage() = default;
+
+NamStage::~NamStage()
+{
+    if (reclaimer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(reclaimMutex_);
+            stopReclaimer_ = true;
+        }
+        reclaimCv_.notify_one();
+        reclaimer_.join();
+    }
+
+    // Audio has stopped by now; everything left is ours to free.
+    drainRetired();
+    delete pending_.exchange(nullptr, std::memory_order_acq_rel);
+    delete incoming_;
+    delete active_;
+}
 
 void NamStage::prepare(float sampleRate, int maxBlockSize)
 {
-    sampleRate_   = sampleRate;
-    maxBlockSize_ = maxBlockSize;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        sampleRate_   = sampleRate;
+        maxBlockSize_ = maxBlockSize;
+    }
 
     // Set the global max buffer size before any model is used.
     // Not RT-safe -- must be called before the audio thread starts.
     NeuralAudio::NeuralModel::SetDefaultMaxAudioBufferSize(maxBlockSize);
 
-    // Pre-allocate the output buffer NeuralAudio writes into.
+    // Pre-allocate the buffers NeuralAudio reads from and writes into.
+    inputBuffer_.assign (static_cast<std::size_t>(maxBlockSize), 0.f);
     outputBuffer_.assign(static_cast<std::size_t>(maxBlockSize), 0.f);
+    fadeBuffer_.assign  (static_cast<std::size_t>(maxBlockSize), 0.f);
 
-    // If a model was already loaded, update its buffer size too.
-    if (model_) {
-        model_->SetMaxAudioBufferSize(maxBlockSize);
-    }
+    // Safe: prepare() never runs concurrently with process().
+    // A fade interrupted by re-preparing just completes.
+    if (incoming_) finishFade();
+
+    // If a model was already loaded (or is waiting), update its buffer size too.
+    // A loader or MIDI thread may publish() over the pending slot and delete
+    // it meanwhile; publish() holds controlMutex_, so resize under it.
+    updateModelBlockSize(active_, maxBlockSize);
+
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    updateModelBlockSize(pending_.load(std::memory_order_acquire), maxBlockSize);
 }
 
 void NamStage::process(float* buffer, int numSamples)
 {
     // Swap in a pending model if one has been set by the control thread.
-    if (modelPending_.load(std::memory_order_acquire)) {
+    // Only when no fade is running and the outgoing slot has somewhere to
+    // go; otherwise try again next block.
+    if (!incoming_ && pending_.load(std::memory_order_relaxed) != nullptr
+        && !retired_.full()) {
         applyPendingModel();
     }
 
-    if (!model_) {
-        // No model loaded -- pass through unmodified.
+    if (incoming_) {
+        processCrossfade(buffer, numSamples);
         return;
     }
 
-    // Apply input calibration gain in-place before inference.
-    if (inputGainLinear_ != 1.f) {
-        for (int i = 0; i < numSamples; ++i) {
-            buffer[i] *= inputGainLinear_;
-        }
+    const Slot* slot = active_;
+    if (!slot || !slot->model) {
+        // No model loaded -- pass through unmodified.
+        return;
     }
 
-    // Run inference. NeuralAudio writes to outputBuffer_.
-    model_->Process(buffer, outputBuffer_.data(), numSamples);
-
-    // Copy result back into the in-place buffer and apply output calibration.
-    if (outputGainLinear_ != 1.f) {
-        for (int i = 0; i < numSamples; ++i) {
-            buffer[i] = outputBuffer_[i] * outputGainLinear_;
-        }
-    } else {
-        std::memcpy(buffer, outputBuffer_.data(),
-                    static_cast<std::size_t>(numSamples) * sizeof(float));
-    }
+    // Run inference (input calibration is applied to buffer in place),
+    // then copy the result back into the in-place buffer.
+    slot->model->process(buffer, outputBuffer_.data(), numSamples);
+    std::memcpy(buffer, outputBuffer_.data(),
+                static_cast<std::size_t>(numSamples) * sizeof(float));
 }
 
 void NamStage::reset()
@@ -70,64 +109,222 @@ void NamStage::reset()
 
 bool NamStage::loadModel(const std::string& path)
 {
-    NeuralAudio::NeuralModel* raw = nullptr;
-
-    try {
-        raw = NeuralAudio::NeuralModel::CreateFromFile(path.c_str());
-    } catch (...) {
-        return false;
+    int blockSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        blockSize = maxBlockSize_;
     }
 
-    if (!raw) return false;
+    // Parse, size and warm up without holding the lock. Warm-up only
+    // happens once prepared -- before that the block size is unknown.
+    auto slot   = std::make_unique<Slot>();
+    slot->owned = std::make_unique<NamModel>();
+    if (!slot->owned->load(path, blockSize)) return false;
+    slot->model = slot->owned.get();
 
-    auto newModel = std::unique_ptr<NeuralAudio::NeuralModel>(raw);
+    std::lock_guard<std::mutex> lock(controlMutex_);
 
-    if (maxBlockSize_ > 0) {
-        newModel->SetMaxAudioBufferSize(maxBlockSize_);
+    // prepare() may have changed the block size while we were loading.
+    if (maxBlockSize_ > 0 && maxBlockSize_ != blockSize) {
+        slot->model->setMaxBlockSize(maxBlockSize_);
     }
 
     // Stage the new model for swap at the top of the next process() call.
-    pendingModel_    = std::move(newModel);
-    pendingModelPath_ = path;
-    modelPending_.store(true, std::memory_order_release);
+    modelPath_ = path;
+    publish(slot.release());
+
+    return true;
+}
+
+bool NamStage::selectBankModel(const NamModelBank& bank, int index)
+{
+    NamModel* model = bank.model(index);
+    if (!model) return false;
+
+    auto slot   = std::make_unique<Slot>();
+    slot->model = model;
+
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    modelPath_ = model->path();
+    publish(slot.release());
 
     return true;
 }
 
 void NamStage::unloadModel()
 {
-    pendingModel_.reset();
-    pendingModelPath_.clear();
-    modelPending_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    modelPath_.clear();
+    publish(new Slot());   // empty slot = passthrough
 }
 
 bool NamStage::hasModel() const
 {
-    return model_ != nullptr;
+    return hasModel_.load(std::memory_order_acquire);
 }
 
+std::string NamStage::modelPath() const
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    return modelPath_;
+}
+
+void NamStage::setCrossfadeMs(float ms)
+{
+    crossfadeMs_.store(std::clamp(ms, 0.f, kMaxCrossfadeMs), std::memory_order_relaxed);
+}
+
+float NamStage::getCrossfadeMs() const
+{
+    return crossfadeMs_.load(std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Handoff and reclamation
+// ---------------------------------------------------------------------------
+
+// Control thread, with controlMutex_ held.
+void NamStage::publish(Slot* slot)
+{
+    startReclaimer();
+
+    // A slot still pending here was never seen by the audio thread (the
+    // exchange is atomic), so it is safe to free on this thread.
+    delete pending_.exchange(slot, std::memory_order_acq_rel);
+
+    // Free whatever the previous swap retired now rather than at the next
+    // poll, so back-to-back swaps (MIDI program scrolling) keep the retire
+    // queue near empty.
+    reclaimCv_.notify_one();
+}
+
+// Audio thread. Caller has checked that no fade is running and that
+// retired_ has room -- which stays true until this swap retires its slot,
+// since only the audio thread pushes.
 void NamStage::applyPendingModel()
 {
-    model_            = std::move(pendingModel_);
-    currentModelPath_ = std::move(pendingModelPath_);
-    modelPending_.store(false, std::memory_order_release);
+    Slot* next = pending_.exchange(nullptr, std::memory_order_acq_rel);
+    if (!next) return;
+
+    // Re-selecting the model that is already running (e.g. the same bank
+    // slot twice): nothing to fade, and running one model twice per block
+    // would corrupt its state. Drop the duplicate handoff record.
+    if (active_ && next->model && next->model == active_->model) {
+        retired_.push(next);
+        return;
+    }
+
+    hasModel_.store(next->model != nullptr, std::memory_order_release);
+
+    // The first model into a fresh stage cuts in; so does dry -> dry.
+    int fadeLength = 0;
+    if (active_ && (active_->model || next->model)) {
+        fadeLength = static_cast<int>(crossfadeMs_.load(std::memory_order_relaxed)
+                                      * 0.001f * sampleRate_ + 0.5f);
+    }
 
-    updateCalibration();
+    incoming_   = next;
+    fadeLength_ = fadeLength;
+    fadePos_    = 0;
+
+    if (fadeLength <= 0) finishFade();
 }
 
-void NamStage::updateCalibration()
+// Audio thread (or prepare()). Retire the outgoing slot and promote incoming_.
+void NamStage::finishFade()
+{
+    if (active_) retired_.push(active_);
+    active_     = incoming_;
+    incoming_   = nullptr;
+    fadeLength_ = 0;
+    fadePos_    = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Crossfade
+// ---------------------------------------------------------------------------
+
+// Run one slot out-of-place: out = model(in), or a copy of in for an
+// empty slot.
+void NamStage::runSlot(const Slot* slot, const float* in, float* out, int numSamples)
 {
-    if (!model_) {
-        inputGainLinear_  = 1.f;
-        outputGainLinear_ = 1.f;
+    const std::size_t bytes = static_cast<std::size_t>(numSamples) * sizeof(float);
+
+    if (!slot || !slot->model) {
+        std::memcpy(out, in, bytes);
         return;
     }
 
-    const float inDb  = model_->GetRecommendedInputDBAdjustment();
-    const float outDb = model_->GetRecommendedOutputDBAdjustment();
+    // NamModel scales its input in place; keep the caller's buffer intact
+    // for the other slot.
+    std::memcpy(inputBuffer_.data(), in, bytes);
+    slot->model->process(inputBuffer_.data(), out, numSamples);
+}
 
-    inputGainLinear_  = std::pow(10.f, inDb  / 20.f);
-    outputGainLinear_ = std::pow(10.f, outDb / 20.f);
+// Non-RT (prepare; controlMutex_ held for the pending slot). Bank models are
+// resized here too: the audio thread is stopped, and the bank is expected
+// to be sized for the same block size.
+void NamStage::updateModelBlockSize(Slot* slot, int maxBlockSize)
+{
+    if (slot && slot->model) slot->model->setMaxBlockSize(maxBlockSize);
+}
+
+void NamStage::processCrossfade(float* buffer, int numSamples)
+{
+    // Both models see the same input for the whole block, so the incoming
+    // one keeps converging on the live signal while it fades in.
+    runSlot(active_,   buffer, outputBuffer_.data(), numSamples);
+    runSlot(incoming_, buffer, fadeBuffer_.data(),   numSamples);
+
+    // Equal-power: out = a*cos(theta) + b*sin(theta), theta 0 -> pi/2.
+    // cos/sin advance by rotation; re-seeded exactly at each block start.
+    static constexpr float kHalfPi = 1.57079632679f;
+    const float step  = kHalfPi / static_cast<float>(fadeLength_);
+    const float theta = step * static_cast<float>(fadePos_);
+    const float cs = std::cos(step), sn = std::sin(step);
+    float c = std::cos(theta);
+    float s = std::sin(theta);
+
+    const int fadeSamples = std::min(numSamples, fadeLength_ - fadePos_);
+    for (int i = 0; i < fadeSamples; ++i) {
+        buffer[i] = outputBuffer_[i] * c + fadeBuffer_[i] * s;
+        const float nc = c * cs - s * sn;
+        s = s * cs + c * sn;
+        c = nc;
+    }
+    for (int i = fadeSamples; i < numSamples; ++i) {
+        buffer[i] = fadeBuffer_[i];
+    }
+
+    fadePos_ += fadeSamples;
+    if (fadePos_ >= fadeLength_) finishFade();
+}
+
+// Control thread, with controlMutex_ held.
+void NamStage::startReclaimer()
+{
+    if (reclaimer_.joinable()) return;
+    reclaimer_ = std::thread([this] { reclaimerLoop(); });
+}
+
+void NamStage::reclaimerLoop()
+{
+    std::unique_lock<std::mutex> lock(reclaimMutex_);
+    while (!stopReclaimer_) {
+        reclaimCv_.wait_for(lock, kReclaimInterval);
+        lock.unlock();
+        drainRetired();
+        lock.lock();
+    }
+}
+
+// Reclaimer thread (or destructor, once the reclaimer has been joined).
+void NamStage::drainRetired()
+{
+    Slot* slot = nullptr;
+    while (retired_.pop(slot)) {
+        delete slot;
+    }
 }
 
 } // namespace hexcaster
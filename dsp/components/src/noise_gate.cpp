@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <limits>
 
 namespace hexcaster {
 
@@ -31,7 +33,13 @@ float NoiseGate::dbToLinear(float db)
 
 void NoiseGate::prepare(float sampleRate, int /*maxBlockSize*/)
 {
-    sampleRate_ = sampleRate;
+    sampleRate_  = sampleRate;
+    coeffsValid_ = false;   // sample rate may have changed
+
+    lookaheadSamples_ = static_cast<int>(std::lround(lookaheadMs_ * 0.001f * sampleRate));
+    delay_.prepare(lookaheadSamples_, 1);
+    chDelay_.prepare(lookaheadSamples_, AudioBlock::kMaxChannels);
+
     reset();
     updateCoefficients();
 }
@@ -42,30 +50,120 @@ void NoiseGate::reset()
     envelope_    = 0.f;
     gateGain_    = 0.f;
     holdCounter_ = 0;
+    delay_.reset();
+
+    for (int c = 0; c < AudioBlock::kMaxChannels; ++c) {
+        chState_[c]    = static_cast<int>(State::Closed);
+        chHold_[c]     = 0;
+        chEnvelope_[c] = 0.f;
+        chGain_[c]     = 0.f;
+    }
+    chDelay_.reset();
 }
 
 void NoiseGate::process(float* buffer, int numSamples)
 {
+    process(buffer, numSamples, OutputGain{});
+}
+
+void NoiseGate::process(float* buffer, int numSamples, const OutputGain& outputGain)
+{
+    const bool unity = outputGain.isUnity();
+
     // Refresh coefficients once per block from the atomics.
     updateCoefficients();
 
-    for (int i = 0; i < numSamples; ++i) {
-        const float input = buffer[i];
-        const float absSample = input < 0.f ? -input : input;
-
-        // --- Envelope follower ---
-        // Fast attack: snap up to peaks immediately.
-        // Slow release: decay governed by envReleaseCoeff_.
-        if (absSample > envelope_) {
-            envelope_ = absSample;
-        } else {
-            envelope_ = envReleaseCoeff_ * envelope_;
+    float env[kSegment];
+    float delayed[kSegment];   // lookahead scratch
+
+    for (int i = 0; i < numSamples; i += kSegment) {
+        const int n = std::min(kSegment, numSamples - i);
+        float*    x = buffer + i;
+        const float* g = outputGain.perSample ? outputGain.perSample + i : nullptr;
+        const float  k = outputGain.constant;
+
+        // Open or holding: the gate passes the segment at unity, so only
+        // the output gain (if any) is left to apply.
+        auto applyOutputGain = [&] {
+            if (unity) return;
+            if (g) { for (int j = 0; j < n; ++j) x[j] *= g[j]; }
+            else   { for (int j = 0; j < n; ++j) x[j] *= k; }
+        };
+
+        computeEnvelope(x, n, env);
+        if (lookaheadSamples_ > 0) delay_.process(x, n, 1, delayed);
+
+        float lo = env[0], hi = env[0];
+        for (int j = 1; j < n; ++j) {
+            lo = std::min(lo, env[j]);
+            hi = std::max(hi, env[j]);
+        }
+        const bool allAbove = lo >= thresholdLin_;
+        const bool allBelow = hi <  thresholdLin_;
+
+        // Open or holding means gateGain_ == 1: nothing to multiply.
+        if (state_ == State::Open && allAbove) {
+            applyOutputGain();
+            continue;
+        }
+        if (state_ == State::Holding && allAbove) {
+            state_       = State::Open;      // came back up on the first sample
+            holdCounter_ = holdSamples_;
+            applyOutputGain();
+            continue;
+        }
+        if (state_ == State::Holding && allBelow && holdCounter_ > n) {
+            holdCounter_ -= n;
+            applyOutputGain();
+            continue;
+        }
+        if (state_ == State::Closed && allBelow) {
+            std::memset(x, 0, static_cast<std::size_t>(n) * sizeof(float));
+            continue;
+        }
+
+        processTransitions(x, env, n, g, k);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Envelope and state machine
+// ---------------------------------------------------------------------------
+
+void NoiseGate::computeEnvelope(const float* buffer, int n, float* env)
+{
+    float carry = envelope_;
+
+    for (int c = 0; c < n; c += kLanes) {
+        const int len = std::min(kLanes, n - c);
+
+        float a[kLanes] = {};
+        for (int j = 0; j < len; ++j) a[j] = std::fabs(buffer[c + j]);
+
+        // e[j] = max(carry * r^(j+1), max over k <= j of a[k] * r^(j-k))
+        float e[kLanes];
+        for (int j = 0; j < kLanes; ++j) e[j] = carry * envCarry_[j];
+        for (int k = 0; k < kLanes; ++k) {
+            for (int j = 0; j < kLanes; ++j) {
+                e[j] = std::max(e[j], a[k] * envDecay_[k][j]);
+            }
         }
 
-        // --- State machine ---
+        for (int j = 0; j < len; ++j) env[c + j] = e[j];
+        carry = e[len - 1];
+    }
+
+    envelope_ = carry;
+}
+
+void NoiseGate::processTransitions(float* buffer, const float* env, int n, const float* g, float k)
+{
+    for (int i = 0; i < n; ++i) {
+        const float envelope = env[i];
+
         switch (state_) {
             case State::Closed:
-                if (envelope_ >= thresholdLin_) {
+                if (envelope >= thresholdLin_) {
                     state_ = State::Opening;
                     holdCounter_ = holdSamples_;
                 }
@@ -81,14 +179,14 @@ void NoiseGate::process(float* buffer, int numSamples)
                 break;
 
             case State::Open:
-                if (envelope_ < thresholdLin_) {
+                if (envelope < thresholdLin_) {
                     state_ = State::Holding;
                     holdCounter_ = holdSamples_;
                 }
                 break;
 
             case State::Holding:
-                if (envelope_ >= thresholdLin_) {
+                if (envelope >= thresholdLin_) {
                     // Signal came back up during hold -- stay open
                     state_ = State::Open;
                     holdCounter_ = holdSamples_;
@@ -105,14 +203,146 @@ void NoiseGate::process(float* buffer, int numSamples)
                     state_ = State::Closed;
                 }
                 // If signal returns above threshold while closing, re-open
-                if (envelope_ >= thresholdLin_) {
+                if (envelope >= thresholdLin_) {
                     state_ = State::Opening;
                     holdCounter_ = holdSamples_;
                 }
                 break;
         }
 
-        buffer[i] = input * gateGain_;
+        buffer[i] *= gateGain_ * (g ? g[i] : k);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Multichannel
+// ---------------------------------------------------------------------------
+
+void NoiseGate::processChannels(const AudioBlock& block)
+{
+    if (block.numChannels <= 4) {
+        processLanes<4>(block);
+    } else {
+        processLanes<8>(block);
+    }
+}
+
+// process() with channel c in lane c. The envelope is the plain recurrence
+// env = max(|x|, r * env), one vector step per sample; the state machine
+// is processTransitions() with every branch turned into a lane select.
+template <int N>
+void NoiseGate::processLanes(const AudioBlock& block)
+{
+    using Lanes = ChannelLanes<N>;
+    using Mask  = ChannelMask<N>;
+
+    constexpr int kClosed  = static_cast<int>(State::Closed);
+    constexpr int kOpening = static_cast<int>(State::Opening);
+    constexpr int kOpen    = static_cast<int>(State::Open);
+    constexpr int kHolding = static_cast<int>(State::Holding);
+    constexpr int kClosing = static_cast<int>(State::Closing);
+
+    updateCoefficients();
+
+    const int channels = std::min(block.numChannels, N);
+
+    Lanes env, gain;
+    Mask  state, hold;
+    for (int c = 0; c < N; ++c) {
+        env[c]   = chEnvelope_[c];
+        gain[c]  = chGain_[c];
+        state[c] = chState_[c];
+        hold[c]  = chHold_[c];
+    }
+
+    const Lanes zero       = Lanes{};
+    const Lanes one        = zero + 1.f;
+    const Lanes threshold  = zero + thresholdLin_;
+    const Lanes envRelease = zero + envReleaseCoeff_;
+    const Lanes attack     = zero + attackCoeff_;
+    const Lanes release    = zero + releaseCoeff_;
+    const Mask  holdFull   = Mask{} + holdSamples_;
+
+    Lanes x[kSegment];
+    Lanes e[kSegment];
+    float delayed[kSegment * N];   // lookahead scratch
+
+    for (int offset = 0; offset < block.numSamples; offset += kSegment) {
+        const int n = std::min(kSegment, block.numSamples - offset);
+        loadLanes<N>(block, offset, n, x);
+
+        Lanes lo = zero + std::numeric_limits<float>::max(), hi = zero;
+        for (int j = 0; j < n; ++j) {
+            const Lanes a     = x[j] < zero ? -x[j] : x[j];
+            const Lanes decay = envRelease * env;
+            env  = a > decay ? a : decay;
+            e[j] = env;
+            lo   = env < lo ? env : lo;
+            hi   = env > hi ? env : hi;
+        }
+
+        if (lookaheadSamples_ > 0) {
+            chDelay_.process(reinterpret_cast<float*>(x), n, N, delayed);
+        }
+
+        bool allOpen = true, allClosed = true;
+        for (int c = 0; c < channels; ++c) {
+            allOpen   = allOpen   && state[c] == kOpen   && lo[c] >= thresholdLin_;
+            allClosed = allClosed && state[c] == kClosed && hi[c] <  thresholdLin_;
+        }
+        if (allOpen) {
+            if (lookaheadSamples_ > 0) storeLanes<N>(x, offset, n, block);
+            continue;
+        }
+        if (allClosed) {
+            for (int c = 0; c < channels; ++c) {
+                std::memset(block.channels[c] + offset, 0, static_cast<std::size_t>(n) * sizeof(float));
+            }
+            continue;
+        }
+
+        for (int j = 0; j < n; ++j) {
+            const Mask above     = e[j] >= threshold;
+            const Mask below     = ~above;
+            const Mask isClosed  = state == kClosed;
+            const Mask isOpening = state == kOpening;
+            const Mask isOpen    = state == kOpen;
+            const Mask isHolding = state == kHolding;
+            const Mask isClosing = state == kClosing;
+
+            // Gain ramps (Opening toward 1, Closing toward 0)
+            gain = isOpening ? attack * gain + (1.f - attack) : gain;
+            gain = isClosing ? release * gain : gain;
+            const Mask opened = isOpening & (gain >= 0.999f);
+            const Mask closed = isClosing & (gain <= 0.001f);
+            gain = opened ? one  : gain;
+            gain = closed ? zero : gain;
+
+            // Transitions, in processTransitions() order
+            const Mask holdNext = hold - 1;
+            Mask next = state;
+            next = (isClosed & above)                     ? Mask{} + kOpening : next;
+            next = opened                                 ? Mask{} + kOpen    : next;
+            next = (isOpen & below)                       ? Mask{} + kHolding : next;
+            next = (isHolding & above)                    ? Mask{} + kOpen    : next;
+            next = (isHolding & below & (holdNext <= 0))  ? Mask{} + kClosing : next;
+            next = closed                                 ? Mask{} + kClosed  : next;
+            next = (isClosing & above)                    ? Mask{} + kOpening : next;
+
+            const Mask reload = ((isClosed | isHolding | isClosing) & above) | (isOpen & below);
+            hold  = reload ? holdFull : ((isHolding & below) ? holdNext : hold);
+            state = next;
+
+            x[j] *= gain;
+        }
+        storeLanes<N>(x, offset, n, block);
+    }
+
+    for (int c = 0; c < N; ++c) {
+        chEnvelope_[c] = env[c];
+        chGain_[c]     = gain[c];
+        chState_[c]    = state[c];
+        chHold_[c]     = hold[c];
     }
 }
 
@@ -140,6 +370,11 @@ void NoiseGate::setHoldMs(float ms)
     holdMs_.store(std::clamp(ms, 0.f, 500.f), std::memory_order_relaxed);
 }
 
+void NoiseGate::setLookaheadMs(float ms)
+{
+    lookaheadMs_ = std::clamp(ms, 0.f, kMaxLookaheadMs);
+}
+
 float NoiseGate::getThresholdDb()  const { return thresholdDb_.load(std::memory_order_relaxed); }
 float NoiseGate::getAttackMs()     const { return attackMs_.load(std::memory_order_relaxed); }
 float NoiseGate::getReleaseMs()    const { return releaseMs_.load(std::memory_order_relaxed); }
@@ -151,13 +386,36 @@ float NoiseGate::getHoldMs()       const { return holdMs_.load(std::memory_order
 
 void NoiseGate::updateCoefficients()
 {
-    thresholdLin_    = dbToLinear(thresholdDb_.load(std::memory_order_relaxed));
-    attackCoeff_     = msToCoeff(attackMs_.load(std::memory_order_relaxed),   sampleRate_);
-    releaseCoeff_    = msToCoeff(releaseMs_.load(std::memory_order_relaxed),  sampleRate_);
+    const float thresholdDb = thresholdDb_.load(std::memory_order_relaxed);
+    const float attackMs    = attackMs_.load(std::memory_order_relaxed);
+    const float releaseMs   = releaseMs_.load(std::memory_order_relaxed);
+    const float holdMs      = holdMs_.load(std::memory_order_relaxed);
+
+    if (coeffsValid_ &&
+        thresholdDb == cachedThresholdDb_ && attackMs == cachedAttackMs_ &&
+        releaseMs   == cachedReleaseMs_   && holdMs   == cachedHoldMs_)
+        return;
+
+    cachedThresholdDb_ = thresholdDb;
+    cachedAttackMs_    = attackMs;
+    cachedReleaseMs_   = releaseMs;
+    cachedHoldMs_      = holdMs;
+    coeffsValid_       = true;
+
+    thresholdLin_    = dbToLinear(thresholdDb);
+    attackCoeff_     = msToCoeff(attackMs,  sampleRate_);
+    releaseCoeff_    = msToCoeff(releaseMs, sampleRate_);
     // Envelope follower release: ~3x faster than gate release for responsiveness
-    envReleaseCoeff_ = msToCoeff(releaseMs_.load(std::memory_order_relaxed) / 3.f, sampleRate_);
-    holdSamples_     = static_cast<int>(holdMs_.load(std::memory_order_relaxed)
-                                        * 0.001f * sampleRate_);
+    envReleaseCoeff_ = msToCoeff(releaseMs / 3.f, sampleRate_);
+    holdSamples_     = static_cast<int>(holdMs * 0.001f * sampleRate_);
+
+    // Decay powers for the unrolled envelope.
+    float p = 1.f;
+    for (int d = 0; d < kLanes; ++d) {
+        for (int k = 0; k + d < kLanes; ++k) envDecay_[k][k + d] = p;
+        p *= envReleaseCoeff_;
+        envCarry_[d] = p;
+    }
 }
 
 } // namespace hexcaster
@@ -0,0 +1,355 @@
+// RT-safety sanitizer: libc interposers (see rt_sanitizer.h).
+//
+// Built only with -DHEXCASTER_RT_SANITIZE=ON, as a shared library so these
+// definitions come ahead of libc's in the process-wide symbol lookup.
+// Allocation is forwarded to glibc's __libc_* entry points; everything
+// else to the next definition found with dlsym(RTLD_NEXT).
+//
+// Nothing in here may allocate on the checked path: the thread state is
+// initial-exec TLS (no lazy TLS allocation), records live in a static
+// array, and backtrace() is warmed up at load so its one-time libgcc load
+// does not happen inside a scope.
+
+// The fortified headers define open()/fprintf() as inline wrappers, which
+// would clash with the definitions below.
+#undef _FORTIFY_SOURCE
+
+#include "hexcaster/rt_sanitizer.h"
+
+#if !defined(__GLIBC__)
+#error "HEXCASTER_RT_SANITIZE needs glibc (__libc_malloc and friends)"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void  __libc_free(void* ptr);
+}
+
+namespace hexcaster {
+
+namespace {
+
+struct Record {
+    const char* what = nullptr;
+    int         depth = 0;
+    void*       frames[kRtsanMaxFrames] = {};
+};
+
+__attribute__((tls_model("initial-exec"))) thread_local int  tScopeDepth = 0;
+__attribute__((tls_model("initial-exec"))) thread_local bool tInHook     = false;
+
+std::atomic<int> gViolations{ 0 };
+std::atomic<int> gRecorded{ 0 };
+Record           gRecords[kRtsanMaxRecords];
+
+// Count (and record) a call made inside an RtScope. Calls the hook makes
+// itself (backtrace) are not counted.
+void check(const char* what)
+{
+    if (tScopeDepth == 0 || tInHook) return;
+    tInHook = true;
+
+    gViolations.fetch_add(1, std::memory_order_relaxed);
+    const int slot = gRecorded.fetch_add(1, std::memory_order_relaxed);
+    if (slot < kRtsanMaxRecords) {
+        Record& r = gRecords[slot];
+        r.what  = what;
+        r.depth = backtrace(r.frames, kRtsanMaxFrames);
+    }
+
+    tInHook = false;
+}
+
+// The next definition of name after ours (libc's), looked up once.
+void* lookup(std::atomic<void*>& cache, const char* name)
+{
+    void* fn = cache.load(std::memory_order_acquire);
+    if (!fn) {
+        fn = dlsym(RTLD_NEXT, name);
+        cache.store(fn, std::memory_order_release);
+    }
+    return fn;
+}
+
+#define HEXCASTER_RTSAN_CACHE(fn) std::atomic<void*> cache_##fn{ nullptr }
+#define HEXCASTER_RTSAN_NEXT(fn)  reinterpret_cast<decltype(&::fn)>(lookup(cache_##fn, #fn))
+
+HEXCASTER_RTSAN_CACHE(pthread_mutex_lock);
+HEXCASTER_RTSAN_CACHE(pthread_create);
+HEXCASTER_RTSAN_CACHE(open);
+HEXCASTER_RTSAN_CACHE(open64);
+HEXCASTER_RTSAN_CACHE(openat);
+HEXCASTER_RTSAN_CACHE(fopen);
+HEXCASTER_RTSAN_CACHE(fopen64);
+HEXCASTER_RTSAN_CACHE(close);
+HEXCASTER_RTSAN_CACHE(read);
+HEXCASTER_RTSAN_CACHE(write);
+HEXCASTER_RTSAN_CACHE(vfprintf);
+HEXCASTER_RTSAN_CACHE(nanosleep);
+HEXCASTER_RTSAN_CACHE(usleep);
+
+// open()'s mode argument is only present with O_CREAT / O_TMPFILE.
+mode_t openMode(int flags, va_list args)
+{
+    return (flags & (O_CREAT | O_TMPFILE)) ? static_cast<mode_t>(va_arg(args, int)) : 0;
+}
+
+// Warm up backtrace() (it loads libgcc on first use) and report at exit.
+__attribute__((constructor)) void startUp()
+{
+    void* frames[2];
+    backtrace(frames, 2);
+}
+
+__attribute__((destructor)) void shutDown()
+{
+    if (gViolations.load(std::memory_order_relaxed) > 0) rtsanReport(stderr);
+}
+
+} // namespace
+
+RtScope::RtScope()  { ++tScopeDepth; }
+RtScope::~RtScope() { --tScopeDepth; }
+
+int rtsanViolationCount()
+{
+    return gViolations.load(std::memory_order_relaxed);
+}
+
+void rtsanClear()
+{
+    gViolations.store(0, std::memory_order_relaxed);
+    gRecorded.store(0, std::memory_order_relaxed);
+}
+
+bool rtsanInScope()
+{
+    return tScopeDepth > 0;
+}
+
+void rtsanReport(std::FILE* out)
+{
+    const int count    = gViolations.load(std::memory_order_relaxed);
+    const int recorded = std::min(gRecorded.load(std::memory_order_relaxed), kRtsanMaxRecords);
+
+    std::fprintf(out, "RT sanitizer: %d call(s) that are not real-time safe on an RT thread\n", count);
+    for (int i = 0; i < recorded; ++i) {
+        const Record& r = gRecords[i];
+        std::fprintf(out, "#%d %s\n", i, r.what ? r.what : "?");
+        std::fflush(out);
+        backtrace_symbols_fd(r.frames, r.depth, fileno(out));
+    }
+    if (count > recorded) std::fprintf(out, "(%d more not recorded)\n", count - recorded);
+    std::fflush(out);
+}
+
+} // namespace hexcaster
+
+// ---------------------------------------------------------------------------
+// Interposers
+// ---------------------------------------------------------------------------
+
+using namespace hexcaster;
+
+extern "C" {
+
+void* malloc(std::size_t size) noexcept
+{
+    check("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    check("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept
+{
+    check("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept
+{
+    if (ptr) check("free");
+    __libc_free(ptr);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept
+{
+    check("memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+    check("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, std::size_t alignment, std::size_t size) noexcept
+{
+    check("posix_memalign");
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void* p = __libc_memalign(alignment, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+    check("pthread_mutex_lock");
+    return HEXCASTER_RTSAN_NEXT(pthread_mutex_lock)(mutex);
+}
+
+int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*start)(void*), void* arg) noexcept
+{
+    check("pthread_create");
+    return HEXCASTER_RTSAN_NEXT(pthread_create)(thread, attr, start, arg);
+}
+
+int open(const char* path, int flags, ...)
+{
+    check("open");
+    va_list args;
+    va_start(args, flags);
+    const mode_t mode = openMode(flags, args);
+    va_end(args);
+    return HEXCASTER_RTSAN_NEXT(open)(path, flags, mode);
+}
+
+int open64(const char* path, int flags, ...)
+{
+    check("open64");
+    va_list args;
+    va_start(args, flags);
+    const mode_t mode = openMode(flags, args);
+    va_end(args);
+    return HEXCASTER_RTSAN_NEXT(open64)(path, flags, mode);
+}
+
+int openat(int dirfd, const char* path, int flags, ...)
+{
+    check("openat");
+    va_list args;
+    va_start(args, flags);
+    const mode_t mode = openMode(flags, args);
+    va_end(args);
+    return HEXCASTER_RTSAN_NEXT(openat)(dirfd, path, flags, mode);
+}
+
+FILE* fopen(const char* path, const char* mode)
+{
+    check("fopen");
+    return HEXCASTER_RTSAN_NEXT(fopen)(path, mode);
+}
+
+FILE* fopen64(const char* path, const char* mode)
+{
+    check("fopen64");
+    return HEXCASTER_RTSAN_NEXT(fopen64)(path, mode);
+}
+
+int close(int fd)
+{
+    check("close");
+    return HEXCASTER_RTSAN_NEXT(close)(fd);
+}
+
+ssize_t read(int fd, void* buf, std::size_t count)
+{
+    check("read");
+    return HEXCASTER_RTSAN_NEXT(read)(fd, buf, count);
+}
+
+ssize_t write(int fd, const void* buf, std::size_t count)
+{
+    check("write");
+    return HEXCASTER_RTSAN_NEXT(write)(fd, buf, count);
+}
+
+int vfprintf(FILE* stream, const char* format, va_list args)
+{
+    check("vfprintf");
+    return HEXCASTER_RTSAN_NEXT(vfprintf)(stream, format, args);
+}
+
+int fprintf(FILE* stream, const char* format, ...)
+{
+    check("fprintf");
+    va_list args;
+    va_start(args, format);
+    const int n = HEXCASTER_RTSAN_NEXT(vfprintf)(stream, format, args);
+    va_end(args);
+    return n;
+}
+
+int printf(const char* format, ...)
+{
+    check("printf");
+    va_list args;
+    va_start(args, format);
+    const int n = HEXCASTER_RTSAN_NEXT(vfprintf)(stdout, format, args);
+    va_end(args);
+    return n;
+}
+
+// _FORTIFY_SOURCE builds call these instead of fprintf/printf.
+int __fprintf_chk(FILE* stream, int /*flag*/, const char* format, ...)
+{
+    check("fprintf");
+    va_list args;
+    va_start(args, format);
+    const int n = HEXCASTER_RTSAN_NEXT(vfprintf)(stream, format, args);
+    va_end(args);
+    return n;
+}
+
+int __printf_chk(int /*flag*/, const char* format, ...)
+{
+    check("printf");
+    va_list args;
+    va_start(args, format);
+    const int n = HEXCASTER_RTSAN_NEXT(vfprintf)(stdout, format, args);
+    va_end(args);
+    return n;
+}
+
+int __vfprintf_chk(FILE* stream, int /*flag*/, const char* format, va_list args)
+{
+    check("vfprintf");
+    return HEXCASTER_RTSAN_NEXT(vfprintf)(stream, format, args);
+}
+
+int nanosleep(const struct timespec* request, struct timespec* remaining)
+{
+    check("nanosleep");
+    return HEXCASTER_RTSAN_NEXT(nanosleep)(request, remaining);
+}
+
+int usleep(useconds_t usec)
+{
+    check("usleep");
+    return HEXCASTER_RTSAN_NEXT(usleep)(usec);
+}
+
+} // extern "C"
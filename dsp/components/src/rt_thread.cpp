@@ -0,0 +1,29 @@
+#include "hexcaster/rt_thread.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace hexcaster {
+
+bool setCurrentThreadRealtime(int priority)
+{
+    struct sched_param sp{};
+    sp.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0;
+}
+
+bool pinCurrentThreadToCpu(int cpu)
+{
+    if (cpu < 0) return true;
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace hexcaster
@@ -0,0 +1,459 @@
+#include "hexcaster/sample_convert.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace hexcaster {
+
+int bytesPerSample(SampleFormat fmt)
+{
+    switch (fmt) {
+        case SampleFormat::Float32:     return 4;
+        case SampleFormat::Int32:       return 4;
+        case SampleFormat::Int16:       return 2;
+        case SampleFormat::Int24:       return 4;
+        case SampleFormat::Int24Packed: return 3;
+    }
+    return 2;
+}
+
+namespace {
+
+constexpr int kLanes = PlaybackConverter::kLanes;
+
+typedef float    Floats __attribute__((vector_size(kLanes * sizeof(float))));
+typedef int32_t  Ints   __attribute__((vector_size(kLanes * sizeof(int32_t))));
+typedef uint32_t Uints  __attribute__((vector_size(kLanes * sizeof(uint32_t))));
+typedef int16_t  Shorts __attribute__((vector_size(kLanes * sizeof(int16_t))));
+
+// 128-bit vectors for the packed 24-bit kernels: one group of 4 samples.
+typedef uint8_t  Bytes16 __attribute__((vector_size(16)));
+typedef int32_t  Ints4   __attribute__((vector_size(16)));
+typedef float    Floats4 __attribute__((vector_size(16)));
+
+// Byte shuffles are one instruction with SSSE3 (pshufb) and NEON (tbl);
+// plain SSE2 has to emulate them, slower than the scalar byte loops.
+#if defined(__SSSE3__) || defined(__ARM_NEON)
+constexpr bool kFastByteShuffle = true;
+#else
+constexpr bool kFastByteShuffle = false;
+#endif
+
+// The 24-bit device sample types (the others are plain int16_t etc.).
+struct Int24In4 { int32_t v; };      // S24_LE: top byte padding
+struct Int24In3 { uint8_t b[3]; };   // S24_3LE
+static_assert(sizeof(Int24In3) == 3, "S24_3LE samples must be packed");
+
+// Full scale: 1.0 <-> 2^(bits - 1). The largest float below 2^31 bounds
+// Int32 output: 2^31 itself does not fit.
+template <typename T> constexpr float kFullScale   = 1.f;
+template <>           constexpr float kFullScale<int16_t>  = 32768.f;
+template <>           constexpr float kFullScale<int32_t>  = 2147483648.f;
+template <>           constexpr float kFullScale<Int24In4> = 8388608.f;
+template <>           constexpr float kFullScale<Int24In3> = 8388608.f;
+constexpr float kMaxInt32Float = 2147483520.f;
+
+// Dither noise is made a chunk at a time, ahead of the conversion loop.
+constexpr int kChunk = 64;
+
+// kChunk TPDF values in LSBs, triangular in (-1, 1): one xorshift32 step
+// per lane per sample, its two 16-bit halves the two uniform sources.
+inline void tpdfChunk(Uints& rng, float* out)
+{
+    for (int i = 0; i < kChunk; i += kLanes) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        const Ints   tpdf  = (Ints)(rng & 0xffffu) - (Ints)(rng >> 16);
+        const Floats noise = __builtin_convertvector(tpdf, Floats) * (1.f / 65536.f);
+        std::memcpy(out + i, &noise, sizeof noise);
+    }
+}
+
+// One device sample -> float. 24-bit samples are top-aligned into an
+// int32 first: that sign-extends them and drops S24_LE's padding byte.
+template <typename T>
+inline float toFloat(const T& sample)
+{
+    if constexpr (std::is_same_v<T, Int24In4>) {
+        const int32_t v = static_cast<int32_t>(static_cast<uint32_t>(sample.v) << 8);
+        return static_cast<float>(v) * (1.f / kFullScale<int32_t>);
+    } else if constexpr (std::is_same_v<T, Int24In3>) {
+        const int32_t v = static_cast<int32_t>(static_cast<uint32_t>(sample.b[0]) << 8
+                                             | static_cast<uint32_t>(sample.b[1]) << 16
+                                             | static_cast<uint32_t>(sample.b[2]) << 24);
+        return static_cast<float>(v) * (1.f / kFullScale<int32_t>);
+    } else {
+        return static_cast<float>(sample) * (1.f / kFullScale<T>);
+    }
+}
+
+inline int32_t quantize24(float x)
+{
+    return static_cast<int32_t>(std::clamp(x * kFullScale<Int24In3>, -8388608.f, 8388607.f));
+}
+
+// One sample, saturated. Int16 rounds to nearest (offset to positive so
+// truncation is floor); the wider formats truncate, an error below
+// -138 dBFS.
+template <typename T>
+inline T quantize(float x, float noise)
+{
+    if constexpr (std::is_same_v<T, float>) {
+        return x;
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+        const float y = std::clamp(x * kFullScale<int32_t>, -2147483648.f, kMaxInt32Float);
+        return static_cast<int32_t>(y);
+    } else if constexpr (std::is_same_v<T, Int24In4> || std::is_same_v<T, Int24In3>) {
+        const int32_t v = quantize24(x);
+        if constexpr (std::is_same_v<T, Int24In4>) {
+            return Int24In4{ v };   // sign-extended into the padding byte
+        } else {
+            return Int24In3{ { static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8),
+                               static_cast<uint8_t>(v >> 16) } };
+        }
+    } else {
+        const float y = std::clamp(x * kFullScale<int16_t> + noise, -32768.f, 32767.f);
+        return static_cast<int16_t>(static_cast<int32_t>(y + 32768.5f) - 32768);
+    }
+}
+
+// kLanes samples plus dither (LSBs) -> int16, as quantize<int16_t>() but
+// with the clamp as vector selects: the per-sample version keeps a branch
+// (std::clamp) that stops the dithered loop vectorizing without
+// -ffast-math.
+inline Shorts quantize16(const Floats& x, const Floats& noise)
+{
+    const Floats lo = Floats{} - 32768.f;
+    const Floats hi = Floats{} + 32767.f;
+    Floats y = x * kFullScale<int16_t> + noise;
+    y = y < lo ? lo : y;
+    y = y > hi ? hi : y;
+    const Ints v = __builtin_convertvector(y + 32768.5f, Ints) - 32768;
+    return __builtin_convertvector(v, Shorts);
+}
+
+// ---------------------------------------------------------------------------
+// S24_3LE groups
+//
+// Sample l (0..3) of a group at stride S sits at bytes 3*S*l .. 3*S*l + 2.
+// A group is moved with 16-byte loads/stores and byte shuffles over a
+// 32-byte window; from stride 4 on the four samples span more than that,
+// so samples 2-3 get a second window at byte 6*S.
+// ---------------------------------------------------------------------------
+
+template <int S> constexpr bool kSplitGroup  = 9 * S + 3 > 32;
+template <int S> constexpr int  kGroupWindow = kSplitGroup<S> ? 6 * S + 32 : 32;
+
+// Unpack: byte j of the result is byte j % 4 of top-aligned sample j / 4,
+// from a window starting at byte base. The low byte is masked off later;
+// samples outside the window read byte 0.
+constexpr int unpackIndex(int stride, int base, int j)
+{
+    const int offset = 3 * stride * (j / 4) - base;
+    if (offset < 0 || offset + 3 > 32) return 0;
+    return offset + (j % 4 == 0 ? 0 : j % 4 - 1);
+}
+
+// Pack: byte d of window half h keeps the old byte unless it belongs to
+// one of the group's samples; then it takes that sample's byte from the
+// quantized int32s (shuffle operand 2, indices 16..31).
+constexpr int packIndex(int stride, int base, int half, int d)
+{
+    const int pos = base + 16 * half + d;
+    for (int l = 0; l < 4; ++l) {
+        const int offset = pos - 3 * stride * l;
+        if (offset >= 0 && offset < 3) return 16 + 4 * l + offset;
+    }
+    return d;
+}
+
+template <int S, int Base, std::size_t... J>
+inline Bytes16 unpackWindow(const uint8_t* window, std::index_sequence<J...>)
+{
+    Bytes16 lo, hi;
+    std::memcpy(&lo, window, sizeof lo);
+    std::memcpy(&hi, window + 16, sizeof hi);
+    return __builtin_shufflevector(lo, hi, unpackIndex(S, Base, J)...);
+}
+
+// Stores end at the window's last sample byte: the next group's window
+// load must not overlap them, or it stalls on store forwarding.
+template <int S, int Base, std::size_t... D>
+inline void packWindow(Bytes16 samples, uint8_t* window, std::index_sequence<D...>)
+{
+    constexpr int kUsed = (kSplitGroup<S> ? 3 * S : 9 * S) + 3;
+    Bytes16 lo, hi;
+    std::memcpy(&lo, window, sizeof lo);
+    std::memcpy(&hi, window + 16, sizeof hi);
+    lo = __builtin_shufflevector(lo, samples, packIndex(S, Base, 0, D)...);
+    hi = __builtin_shufflevector(hi, samples, packIndex(S, Base, 1, D)...);
+    std::memcpy(window, &lo, std::min(kUsed, 16));
+    if constexpr (kUsed > 16) std::memcpy(window + 16, &hi, kUsed - 16);
+}
+
+// Convert whole groups while their windows stay inside the channel's
+// frames; return how many frames were done.
+template <int S>
+int unpackGroups(const uint8_t* in, float* dst, int frames)
+{
+    constexpr auto kBytes = std::make_index_sequence<16>{};
+    const std::ptrdiff_t spanBytes = 3 * S * static_cast<std::ptrdiff_t>(frames - 1) + 3;
+
+    int i = 0;
+    for (; i + 4 <= frames && 3 * S * static_cast<std::ptrdiff_t>(i) + kGroupWindow<S> <= spanBytes; i += 4) {
+        const uint8_t* group = in + 3 * S * static_cast<std::ptrdiff_t>(i);
+        Bytes16 bytes = unpackWindow<S, 0>(group, kBytes);
+        if constexpr (kSplitGroup<S>) {
+            const Bytes16 upper = unpackWindow<S, 6 * S>(group + 6 * S, kBytes);
+            bytes = __builtin_shufflevector(bytes, upper, 0, 1, 2, 3, 4, 5, 6, 7,
+                                            24, 25, 26, 27, 28, 29, 30, 31);
+        }
+        const Ints4   v = (Ints4)bytes & ~0xff;
+        const Floats4 f = __builtin_convertvector(v, Floats4) * (1.f / kFullScale<int32_t>);
+        std::memcpy(dst + i, &f, sizeof f);
+    }
+    return i;
+}
+
+template <int S>
+int packGroups(const int32_t* q, uint8_t* out, int first, int last, int frames)
+{
+    constexpr auto kBytes = std::make_index_sequence<16>{};
+    const std::ptrdiff_t spanBytes = 3 * S * static_cast<std::ptrdiff_t>(frames - 1) + 3;
+
+    int i = first;
+    for (; i + 4 <= last && 3 * S * static_cast<std::ptrdiff_t>(i) + kGroupWindow<S> <= spanBytes; i += 4) {
+        uint8_t* group = out + 3 * S * static_cast<std::ptrdiff_t>(i);
+        Bytes16  samples;
+        std::memcpy(&samples, q + (i - first), sizeof samples);
+        if constexpr (S == 1) {
+            // Contiguous: no neighbours to keep, just drop the top bytes.
+            const Bytes16 packed = __builtin_shufflevector(samples, samples, 0, 1, 2, 4, 5, 6,
+                                                           8, 9, 10, 12, 13, 14, 0, 0, 0, 0);
+            std::memcpy(group, &packed, 12);
+        } else {
+            packWindow<S, 0>(samples, group, kBytes);
+            if constexpr (kSplitGroup<S>) packWindow<S, 6 * S>(samples, group + 6 * S, kBytes);
+        }
+    }
+    return i;
+}
+
+// S > 0: compile-time stride; S == 0: the stride argument.
+template <typename T, int S>
+void captureKernel(const void* src, int stride, float* dst, int frames)
+{
+    const T*  in   = static_cast<const T*>(src);
+    const int step = S > 0 ? S : stride;
+
+    int i = 0;
+    if constexpr (std::is_same_v<T, Int24In3> && S > 0 && kFastByteShuffle) {
+        i = unpackGroups<S>(static_cast<const uint8_t*>(src), dst, frames);
+    }
+    for (; i < frames; ++i) {
+        dst[i] = toFloat(in[static_cast<std::ptrdiff_t>(i) * step]);
+    }
+}
+
+template <typename T, int S, bool Dither>
+void playbackKernel(const float* src, void* dst, int stride, int frames, uint32_t* ditherState)
+{
+    T*        out  = static_cast<T*>(dst);
+    const int step = S > 0 ? S : stride;
+
+    if constexpr (std::is_same_v<T, Int24In3> && S > 0 && kFastByteShuffle) {
+        // Quantize a chunk to int32 (vectorized), then pack it in groups.
+        alignas(sizeof(Ints4)) int32_t q[kChunk];
+        for (int base = 0; base < frames; base += kChunk) {
+            const int n = std::min(kChunk, frames - base);
+            for (int i = 0; i < n; ++i) q[i] = quantize24(src[base + i]);
+
+            int i = packGroups<S>(q, static_cast<uint8_t*>(dst), base, base + n, frames);
+            for (; i < base + n; ++i) {
+                out[static_cast<std::ptrdiff_t>(i) * step] = quantize<T>(src[i], 0.f);
+            }
+        }
+        return;
+    }
+
+    if constexpr (!Dither) {
+        for (int i = 0; i < frames; ++i) {
+            out[static_cast<std::ptrdiff_t>(i) * step] = quantize<T>(src[i], 0.f);
+        }
+    } else {
+        static_assert(std::is_same_v<T, int16_t>, "only Int16 output is dithered");
+
+        // Quantize a chunk kLanes at a time into q, then scatter q at the
+        // stride. A full vector would read past the end of src for the
+        // last frames % kLanes, so those go through quantize() instead.
+        Uints rng;
+        std::memcpy(&rng, ditherState, sizeof rng);
+        alignas(sizeof(Floats)) float   noise[kChunk];
+        alignas(sizeof(Shorts)) int16_t q[kChunk];
+        for (int base = 0; base < frames; base += kChunk) {
+            const int    n = std::min(kChunk, frames - base);
+            const int    v = n - n % kLanes;
+            const float* x = src + base;
+            T*           o = out + static_cast<std::ptrdiff_t>(base) * step;
+            tpdfChunk(rng, noise);
+            for (int i = 0; i < v; i += kLanes) {
+                Floats xs, ns;
+                std::memcpy(&xs, x + i, sizeof xs);
+                std::memcpy(&ns, noise + i, sizeof ns);
+                const Shorts qs = quantize16(xs, ns);
+                std::memcpy(q + i, &qs, sizeof qs);
+            }
+            for (int i = v; i < n; ++i) q[i] = quantize<int16_t>(x[i], noise[i]);
+            for (int i = 0; i < n; ++i) o[static_cast<std::ptrdiff_t>(i) * step] = q[i];
+        }
+        std::memcpy(ditherState, &rng, sizeof rng);
+    }
+}
+
+template <typename T, int S>
+void silenceKernel(void* dst, int stride, int frames)
+{
+    T*        out  = static_cast<T*>(dst);
+    const int step = S > 0 ? S : stride;
+    for (int i = 0; i < frames; ++i) out[static_cast<std::ptrdiff_t>(i) * step] = T{};
+}
+
+// pick(integral_constant<int, S>) for strides 1..8, S = 0 for any other.
+template <typename Pick>
+auto byStride(int stride, Pick pick)
+{
+    switch (stride) {
+        case 1:  return pick(std::integral_constant<int, 1>{});
+        case 2:  return pick(std::integral_constant<int, 2>{});
+        case 3:  return pick(std::integral_constant<int, 3>{});
+        case 4:  return pick(std::integral_constant<int, 4>{});
+        case 5:  return pick(std::integral_constant<int, 5>{});
+        case 6:  return pick(std::integral_constant<int, 6>{});
+        case 7:  return pick(std::integral_constant<int, 7>{});
+        case 8:  return pick(std::integral_constant<int, 8>{});
+        default: return pick(std::integral_constant<int, 0>{});
+    }
+}
+
+using CaptureKernel  = void (*)(const void*, int, float*, int);
+using PlaybackKernel = void (*)(const float*, void*, int, int, uint32_t*);
+using SilenceKernel  = void (*)(void*, int, int);
+
+template <typename T>
+CaptureKernel pickCapture(int stride)
+{
+    return byStride(stride, [](auto s) -> CaptureKernel {
+        return captureKernel<T, decltype(s)::value>;
+    });
+}
+
+template <typename T, bool Dither>
+PlaybackKernel pickPlayback(int stride)
+{
+    return byStride(stride, [](auto s) -> PlaybackKernel {
+        return playbackKernel<T, decltype(s)::value, Dither>;
+    });
+}
+
+template <typename T>
+SilenceKernel pickSilence(int stride)
+{
+    return byStride(stride, [](auto s) -> SilenceKernel {
+        return silenceKernel<T, decltype(s)::value>;
+    });
+}
+
+CaptureKernel captureFor(SampleFormat fmt, int stride)
+{
+    switch (fmt) {
+        case SampleFormat::Float32:     return pickCapture<float>(stride);
+        case SampleFormat::Int32:       return pickCapture<int32_t>(stride);
+        case SampleFormat::Int16:       return pickCapture<int16_t>(stride);
+        case SampleFormat::Int24:       return pickCapture<Int24In4>(stride);
+        case SampleFormat::Int24Packed: return pickCapture<Int24In3>(stride);
+    }
+    return pickCapture<int16_t>(stride);
+}
+
+PlaybackKernel playbackFor(SampleFormat fmt, int stride, bool dither)
+{
+    switch (fmt) {
+        case SampleFormat::Float32:     return pickPlayback<float, false>(stride);
+        case SampleFormat::Int32:       return pickPlayback<int32_t, false>(stride);
+        case SampleFormat::Int16:
+            return dither ? pickPlayback<int16_t, true>(stride)
+                          : pickPlayback<int16_t, false>(stride);
+        case SampleFormat::Int24:       return pickPlayback<Int24In4, false>(stride);
+        case SampleFormat::Int24Packed: return pickPlayback<Int24In3, false>(stride);
+    }
+    return pickPlayback<int16_t, false>(stride);
+}
+
+SilenceKernel silenceFor(SampleFormat fmt, int stride)
+{
+    switch (fmt) {
+        case SampleFormat::Float32:     return pickSilence<float>(stride);
+        case SampleFormat::Int32:       return pickSilence<int32_t>(stride);
+        case SampleFormat::Int16:       return pickSilence<int16_t>(stride);
+        case SampleFormat::Int24:       return pickSilence<Int24In4>(stride);
+        case SampleFormat::Int24Packed: return pickSilence<Int24In3>(stride);
+    }
+    return pickSilence<int16_t>(stride);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// CaptureConverter
+// ---------------------------------------------------------------------------
+
+void CaptureConverter::setUp(SampleFormat fmt, int stride)
+{
+    kernel_  = captureFor(fmt, stride);
+    generic_ = captureFor(fmt, 0);
+    stride_  = stride;
+}
+
+void CaptureConverter::convert(const RawChannel& raw, float* dst, int frames) const
+{
+    (raw.stride == stride_ ? kernel_ : generic_)(raw.data, raw.stride, dst, frames);
+}
+
+// ---------------------------------------------------------------------------
+// PlaybackConverter
+// ---------------------------------------------------------------------------
+
+void PlaybackConverter::setUp(SampleFormat fmt, int stride, bool dither, uint32_t seed)
+{
+    kernel_         = playbackFor(fmt, stride, dither);
+    generic_        = playbackFor(fmt, 0, dither);
+    silence_        = silenceFor(fmt, stride);
+    genericSilence_ = silenceFor(fmt, 0);
+    stride_         = stride;
+
+    // Decorrelate the lanes (splitmix32 finalizer); xorshift needs non-zero.
+    for (int lane = 0; lane < kLanes; ++lane) {
+        uint32_t z = seed + 0x9e3779b9u * static_cast<uint32_t>(lane + 1);
+        z = (z ^ (z >> 16)) * 0x85ebca6bu;
+        z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+        z ^= z >> 16;
+        ditherState_[lane] = z != 0 ? z : 1u;
+    }
+}
+
+void PlaybackConverter::convert(const float* src, const RawChannel& raw, int frames)
+{
+    (raw.stride == stride_ ? kernel_ : generic_)(src, raw.data, raw.stride, frames,
+                                                 ditherState_.data());
+}
+
+void PlaybackConverter::silence(const RawChannel& raw, int frames) const
+{
+    (raw.stride == stride_ ? silence_ : genericSilence_)(raw.data, raw.stride, frames);
+}
+
+} // namespace hexcaster
@@ -2,11 +2,13 @@
 
 #include "hexcaster/pipeline.h"
 #include "hexcaster/param_registry.h"
+#include "hexcaster/envelope.h"
+
+#include <vector>
 
 namespace hexcaster {
 
 class GainStage;
-class EnvelopeFollower;
 
 /**
  * BloomController: dynamic gain coordinator.
@@ -18,30 +20,43 @@ class EnvelopeFollower;
  *   PreGain_dB  = BasePre  - A * envelope
  *   PostGain_dB = BasePost + B * envelope
  *
- * Both values are clamped to safe limits.
+ * Both values are clamped to GainStage's limits.
  *
  * Architecture:
  *   - Registered as a PipelineController.
- *   - preProcess(): runs envelope follower on the input signal.
- *   - betweenStages(): applies pre-gain before the amp stage (stageIndex == preAmpStageIndex - 1)
- *                      applies post-gain after the amp stage (stageIndex == ampStageIndex).
- *   - Reads parameters from ParamRegistry each block (atomic reads).
- *   - Writes to GainStage via setGainLinear() (pre-amp and post-amp GainStage references).
+ *   - preProcess(): runs the envelope follower on the input signal and
+ *     computes both gain trajectories for the block, one value per sample.
+ *   - betweenStages(): hands each trajectory to its GainStage just before
+ *     that stage runs (after stage preStageIndex - 1 / postStageIndex - 1;
+ *     a pre-gain stage at index 0 gets it from preProcess()).
+ *   - Reads the Bloom* and Env* parameters from ParamRegistry each block
+ *     (atomic reads); derived values are only recomputed when one changed.
+ *
+ * Gain trajectories:
+ *   The envelope is produced per sample (EnvelopeFollower's envelope
+ *   buffer), so the gains follow it sample by sample instead of stepping
+ *   once per block. dB -> linear uses a branch-free exp2 approximation
+ *   (relative error < 1e-6) so both conversion loops vectorize.
  *
  * The BloomController does NOT own the GainStage objects -- those live in
- * the pipeline stage list. This is intentional: you can swap the gain
- * application strategy (e.g., sample-by-sample vs. block-level) without
- * changing the controller interface.
+ * the pipeline stage list. While Bloom runs, the stages' own targets are
+ * ignored; the trajectories replace them block by block.
  *
- * Implementation: to be added in Phase 1.
+ * Pipelined execution: the trajectories are per block, so both gain stages
+ * must run in the first segment (no cut point at or before postStageIndex).
+ *
+ * Real-time safety:
+ *   preProcess()/betweenStages() are RT-safe: no allocation, no locks.
+ *   prepare() allocates; call it after Pipeline::prepare() with
+ *   Pipeline::stageBlockSize().
  */
 class BloomController : public PipelineController {
 public:
     /**
      * @param preGainStage        GainStage in the pipeline that precedes the amp model.
      * @param postGainStage       GainStage in the pipeline that follows the amp model.
-     * @param preStageIndex       Pipeline stage index of preGainStage (controller injects after this - 1).
-     * @param postStageIndex      Pipeline stage index of postGainStage (controller injects after this).
+     * @param preStageIndex       Pipeline stage index of preGainStage.
+     * @param postStageIndex      Pipeline stage index of postGainStage.
      * @param registry            Parameter source (read-only from audio thread).
      */
     BloomController(GainStage&      preGainStage,
@@ -57,13 +72,34 @@ public:
 
     void reset();
 
+    /** Envelope at the end of the last block [0, 1]. Audio thread. */
+    float envelope() const { return envelope_; }
+
 private:
+    void refreshParams();
+
     GainStage&     preGainStage_;
     GainStage&     postGainStage_;
     int            preStageIndex_;
     int            postStageIndex_;
     ParamRegistry& registry_;
     float          envelope_ = 0.f;
+
+    EnvelopeFollower follower_;
+
+    // Pre-allocated in prepare(): per-sample envelope and gains, one block
+    std::vector<float> envBuffer_;
+    std::vector<float> preGain_;
+    std::vector<float> postGain_;
+    bool               trajectoriesReady_ = false;
+
+    // Parameter values in use (change detection)
+    float basePreDb_   = 0.f;
+    float basePostDb_  = 0.f;
+    float preDepth_    = 0.f;
+    float postDepth_   = 0.f;
+    float attackMs_    = 0.f;
+    float releaseMs_   = 0.f;
 };
 
 } // namespace hexcaster
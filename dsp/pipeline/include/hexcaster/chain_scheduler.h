@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+namespace hexcaster {
+
+/**
+ * ChainScheduler: runs a batch of independent jobs per audio period on a
+ * fixed pool of real-time worker threads, and returns once all of them
+ * are done.
+ *
+ *   scheduler.start(3, [&](int i) { chains[i].process(block.channels[i], n); });
+ *   // audio thread, every period:
+ *   scheduler.run(4);   // jobs 0..3 on the caller + 3 workers; joins
+ *
+ * Made for the standalone rack mode: N independent guitar chains sharing
+ * one capture/playback pair, so one device clock and one xrun domain
+ * instead of N processes fighting over the scheduler.
+ *
+ * - The calling thread takes part: with W workers, W + 1 threads share the
+ *   jobs, and run() adds no latency -- the period's output is complete
+ *   when it returns.
+ * - Work stealing: job j's home is thread j % (W + 1) (caller = 0), so a
+ *   pinned worker keeps running the same chain and its state stays in that
+ *   core's cache. A thread that finishes its home jobs claims any job still
+ *   unclaimed, so one slow chain does not leave the other cores idle.
+ * - A job is claimed by setting its bit in one atomic word tagged with the
+ *   period number; a worker that wakes late for an old period claims
+ *   nothing.
+ * - Workers wait with waitForChange(): spinning briefly, then on a futex.
+ *
+ * Thread safety: start() and stop() are non-RT, from the control thread,
+ * while run() is not being called. run() is the audio thread's, RT-safe;
+ * the job must be too. Jobs with different indices must not share state.
+ */
+class ChainScheduler {
+public:
+    using Job = std::function<void(int index)>;
+
+    static constexpr int kMaxJobs    = 32;   // bits in the claim word
+    static constexpr int kMaxWorkers = 8;
+    static constexpr int kDefaultWorkerPriority = 70;
+
+    ChainScheduler() = default;
+    ~ChainScheduler();
+
+    ChainScheduler(const ChainScheduler&)            = delete;
+    ChainScheduler& operator=(const ChainScheduler&) = delete;
+
+    /**
+     * SCHED_FIFO priority for the workers, or 0 to keep the default
+     * policy. Default matches the ALSA audio thread. Call before start().
+     */
+    void setWorkerPriority(int priority) { workerPriority_ = priority; }
+
+    /**
+     * (Re)start with numWorkers threads running job. workerCpus, if given,
+     * has one CPU per worker (-1 = unpinned). Returns false if numWorkers
+     * is outside [0, kMaxWorkers]. With 0 workers run() calls every job
+     * on the caller. Not real-time safe.
+     */
+    bool start(int numWorkers, Job job, const int* workerCpus = nullptr);
+
+    /** Stop and join the workers. Not real-time safe. */
+    void stop();
+
+    /**
+     * Run job(0) .. job(numJobs - 1), each exactly once, and wait for all
+     * of them. numJobs must be in [0, kMaxJobs]. Real-time safe.
+     */
+    void run(int numJobs);
+
+    int numWorkers() const { return numWorkers_; }
+
+private:
+    void workerLoop(int participant, uint32_t seen);
+
+    // Claim and run jobs of the given period until none are left; returns
+    // how many this thread ran.
+    int  runJobs(int participant, uint32_t period);
+
+    Job job_;
+    int numWorkers_     = 0;
+    int workerPriority_ = kDefaultWorkerPriority;
+
+    std::array<int, kMaxWorkers + 1>      workerCpus_ = {};
+    std::array<uint32_t, kMaxWorkers + 1> homeJobs_   = {};   // bit j: job j's home
+
+    // period in the high 32 bits, claimed-job bits in the low 32. Job bits
+    // at and above numJobs start out claimed.
+    std::atomic<uint64_t> claims_{ 0 };
+    std::atomic<uint32_t> period_{ 0 };      // bumped to wake the workers
+    std::atomic<uint32_t> remaining_{ 0 };   // jobs not yet finished
+    std::atomic<bool>     stopWorkers_{ false };
+
+    std::array<std::thread, kMaxWorkers> workers_;
+};
+
+} // namespace hexcaster
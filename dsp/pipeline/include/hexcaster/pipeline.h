@@ -1,8 +1,13 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <thread>
+#include <vector>
+#include "hexcaster/pipeline_stats.h"
 #include "hexcaster/processor_stage.h"
+#include "hexcaster/spsc_queue.h"
 
 namespace hexcaster {
 
@@ -20,6 +25,10 @@ namespace hexcaster {
  *
  * Controllers are lightweight: they do NOT own stages, they reference them.
  * Real-time safe: no allocation, no blocking.
+ *
+ * Both hooks are called on the audio thread only, so controller state needs
+ * no synchronisation with itself. In pipelined mode that means segment 0:
+ * betweenStages() is not called for stages past the first cut point.
  */
 class PipelineController {
 public:
@@ -55,25 +64,67 @@ public:
  * - The stage list is a fixed-capacity array (no heap allocation).
  * - Controllers are notified at preProcess and betweenStages points.
  *
- * Signal flow per block:
+ * Signal flow per block (per micro-block, see setMicroBlockSize):
  *   1. controller->preProcess(buffer) for each controller
  *   2. for each stage i:
  *        stage[i]->process(buffer)
  *        controller->betweenStages(i, buffer) for each controller
  *
+ * Micro-blocks:
+ *   With a micro-block size set, process() slices each host block into
+ *   runs of at most that many samples and runs the whole chain on each in
+ *   turn. Stages are prepared for the micro-block size rather than the
+ *   host maximum, so NeuralAudio always sees the frame size it was built
+ *   for (WAVENET_FRAMES), buffers stay L1-resident even when a DAW hands
+ *   over 4096 samples, and odd host sizes just leave a short last slice.
+ *   Adds no latency.
+ *
+ * Identity bypass:
+ *   Before each stage call the pipeline asks the stage isIdentity(); if it
+ *   is (master volume at 0 dB, EQ flat), the call is skipped -- no buffer
+ *   pass, no filter update. When a bypassed stage becomes active again its
+ *   output is crossfaded in from the dry signal over kBypassFadeMs, so any
+ *   state the stage carried from before the bypass cannot click. Entering
+ *   bypass needs no fade: the stage was already passing the signal through.
+ *   setAutoBypass(false) runs every stage every block.
+ *
+ * Multichannel:
+ *   setNumChannels(n) and process(const AudioBlock&) run one chain over n
+ *   planar channels: each stage gets the whole block at once
+ *   (processChannels()) instead of one mono pipeline per channel walking
+ *   the same stages again. Every stage must support n channels, the chain
+ *   runs serially (no cut points), and controllers see channel 0 only.
+ *   Timing stats cover the mono process() only.
+ *
  * Thread safety:
  *   - prepare(), addStage(), addController() are non-RT, called before audio.
  *   - process() is called from the audio thread only.
+ *   - Controller hooks run on the audio thread, also in pipelined mode:
+ *     there they see segment 0's stages only (see setCutPoints()).
  *   - reset() is RT-safe.
+ *   - stats() and resetStats() may be called from any non-RT thread.
+ *
+ * Timing instrumentation (HEXCASTER_PIPELINE_STATS):
+ *   When built with -DHEXCASTER_PIPELINE_STATS=ON, process() reads the cycle
+ *   counter around every stage, around each controller's hooks and around
+ *   the whole block, and records the durations into per-slot log2
+ *   histograms (see pipeline_stats.h). Each histogram has one writer and
+ *   stats() copies them out without locking. In pipelined mode a stage is
+ *   timed by the thread running its segment, and the block histogram
+ *   covers the audio thread's share only (segment 0 plus the hand-off).
+ *   When the option is off, none of this is compiled: process() is the
+ *   plain loop and stats() returns a snapshot with enabled == false.
  */
 class Pipeline {
 public:
     static constexpr int kMaxStages      = 16;
     static constexpr int kMaxControllers = 4;
+    static constexpr int kMaxSegments    = 3;
 
     Pipeline() = default;
+    ~Pipeline();
 
-    // Non-copyable, non-moveable (owns no resources but stages hold state)
+    // Non-copyable, non-moveable (stages hold state; owns worker threads)
     Pipeline(const Pipeline&)            = delete;
     Pipeline& operator=(const Pipeline&) = delete;
 
@@ -89,8 +140,74 @@ public:
      */
     void addController(PipelineController* controller);
 
+    /**
+     * Split the chain into segments that run on separate threads. Not
+     * real-time safe; call after addStage(), before prepare().
+     *
+     * cuts[i] is the index of the first stage of segment i + 1; cuts must
+     * be strictly increasing and within (0, numStages()). workerCpus, if
+     * given, has one entry per cut: the CPU to pin that segment's worker
+     * to, or -1 to leave it unpinned. numCuts == 0 restores serial mode.
+     *
+     * Segments past the first run on worker threads, a block behind the
+     * audio thread. Controllers stay on the audio thread with segment 0:
+     * preProcess() and betweenStages() for stages before cuts[0] see one
+     * block together, stages from cuts[0] on get no betweenStages() call.
+     * A stage a controller drives (Bloom's post gain) must come before the
+     * first cut.
+     *
+     * Returns false (and leaves the current layout) if the cuts are invalid,
+     * or if numChannels() > 1.
+     */
+    bool setCutPoints(const int* cuts, int numCuts, const int* workerCpus = nullptr);
+
+    /**
+     * SCHED_FIFO priority for segment workers, or 0 to keep the default
+     * policy. Default matches the ALSA audio thread. Call before prepare().
+     */
+    void setWorkerPriority(int priority) { workerPriority_ = priority; }
+
+    static constexpr int kDefaultWorkerPriority = 70;
+
+    /**
+     * Largest slice of a host block that the chain runs on at once, or 0
+     * (default) to run whole host blocks. Not real-time safe; call before
+     * prepare().
+     */
+    void setMicroBlockSize(int samples);
+    int  microBlockSize() const { return microBlockSize_; }
+
+    /** Block size the stages were last prepared with. */
+    int  stageBlockSize() const { return stageBlockSize_; }
+
+    /** Micro-block size matching NeuralAudio's WAVENET_FRAMES build setting. */
+    static constexpr int kDefaultMicroBlockSize = 128;
+
+    /**
+     * Skip stages while they report isIdentity() (default on). Not
+     * real-time safe; call before prepare().
+     */
+    void setAutoBypass(bool enabled) { autoBypass_ = enabled; }
+    bool autoBypass() const { return autoBypass_; }
+
+    static constexpr float kBypassFadeMs = 3.f;
+
+    /** Whether stage was skipped in the last block it saw. Audio thread. */
+    bool isBypassed(int stage) const { return bypassed_[static_cast<std::size_t>(stage)]; }
+
+    /**
+     * Planar channels per block, default 1. Not real-time safe; call after
+     * addStage() and before prepare(). Returns false (and keeps the current
+     * count) if n is outside [1, AudioBlock::kMaxChannels], a stage's
+     * maxChannels() is below n, or cut points are set.
+     */
+    bool setNumChannels(int numChannels);
+    int  numChannels() const { return numChannels_; }
+
     /**
      * Prepare all stages. Not real-time safe.
+     * In pipelined mode this also (re)starts the segment workers and
+     * refills the pipeline with silence.
      */
     void prepare(float sampleRate, int maxBlockSize);
 
@@ -99,13 +216,59 @@ public:
      */
     void process(float* buffer, int numSamples);
 
+    /**
+     * Process one block of planar audio in place, block.numChannels ==
+     * numChannels() (a one-channel block is the same as the mono call).
+     * Real-time safe.
+     */
+    void process(const AudioBlock& block);
+
     /**
      * Reset all stages. Real-time safe.
+     * In pipelined mode each segment resets its own stages on its own
+     * thread, before the next block it processes.
      */
     void reset();
 
     int numStages()      const { return numStages_; }
     int numControllers() const { return numControllers_; }
+    int numSegments()    const { return numSegments_; }
+
+    /** Blocks of delay added by pipelined execution (numSegments() - 1). */
+    int latencyBlocks()  const { return numSegments_ - 1; }
+
+    /**
+     * Samples of delay the stages themselves add (sum of latencySamples()),
+     * on top of latencyBlocks(). Valid after prepare().
+     */
+    int latencySamples() const;
+
+    /**
+     * Per-block timing, in cycle-counter ticks (divide by cycleHz for seconds).
+     * controllers[c] is the sum of controller c's preProcess and
+     * betweenStages calls within one block.
+     */
+    struct Stats {
+        bool           enabled        = false;
+        double         cycleHz        = 0.0;
+        int            numStages      = 0;
+        int            numControllers = 0;
+        TimingSnapshot block;
+        TimingSnapshot stages[kMaxStages];
+        TimingSnapshot controllers[kMaxControllers];
+    };
+
+    /**
+     * Snapshot the timing histograms. Not real-time safe (may calibrate the
+     * cycle counter on first call); does not disturb the audio thread.
+     */
+    Stats stats() const;
+
+    /**
+     * Ask the audio thread to zero the histograms at the start of its next
+     * block. Safe from any thread.
+     */
+    void resetStats();
 
 private:
     std::array<ProcessorStage*,      kMaxStages>      stages_      = {};
@@ -114,6 +277,71 @@ private:
     int   numControllers_ = 0;
     float sampleRate_     = 0.f;
     int   maxBlockSize_   = 0;
+    int   microBlockSize_ = 0;
+    int   stageBlockSize_ = 0;
+    int   numChannels_    = 1;
+
+    // --- Identity bypass ---
+    // Per-stage state is only touched by the thread running that stage's
+    // segment; dry_[s] is segment s's scratch for fading a stage back in
+    // (one plane per channel).
+    bool autoBypass_        = true;
+    int  bypassFadeSamples_ = 0;
+    std::array<bool, kMaxStages>              bypassed_      = {};
+    std::array<int,  kMaxStages>              fadeRemaining_ = {};
+    std::array<std::vector<float>, kMaxSegments> dry_;
+
+    void runStage(int stage, const AudioBlock& block, float* dry);
+    void clearBypass(int first, int last);
+
+    // --- Pipelined execution ---
+    // Segment s runs stages [segmentStart_[s], segmentStart_[s + 1]).
+    // queues_[s] carries block slots from segment s to segment s + 1; the
+    // last queue carries finished blocks back to the audio thread.
+    // signals_[s] is bumped after every push to queues_[s] so its consumer
+    // can sleep on it.
+    static constexpr int kSlotQueueCapacity = 4;   // >= kMaxSegments
+
+    struct BlockSlot {
+        std::vector<float> samples;
+        int                numSamples = 0;
+    };
+
+    int numSegments_ = 1;
+    std::array<int, kMaxSegments + 1> segmentStart_ = {};
+    std::array<int, kMaxSegments>     workerCpus_   = {};
+    int workerPriority_ = kDefaultWorkerPriority;
+
+    std::array<BlockSlot, kMaxSegments>                        slots_;
+    std::array<SpscQueue<int, kSlotQueueCapacity>, kMaxSegments> queues_;
+    std::array<std::atomic<uint32_t>, kMaxSegments>            signals_ = {};
+    std::array<std::atomic<bool>, kMaxSegments>                resetPending_ = {};
+    std::array<int, kMaxSegments> freeSlots_ = {};  // audio thread only
+    int                           numFreeSlots_ = 0;
+
+    std::array<std::thread, kMaxSegments> workers_;
+    std::atomic<bool>                     stopWorkers_{ false };
+
+    void runSegment(int segment, float* buffer, int numSamples);
+    void processPipelined(float* buffer, int numSamples);
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop(int segment);
+    int  popSlot(int queue);
+    void pushSlot(int queue, int slot);
+
+#if HEXCASTER_PIPELINE_STATS
+    void processTimed(float* buffer, int numSamples);
+    void runSegmentTimed(int segment, int first, int last, float* buffer, int numSamples);
+    void takeStatsReset(int segment, int first, int last);
+
+    // statsResetPending_[s] is consumed by the thread running segment s
+    // (segment 0 in serial mode).
+    TimingHistogram   blockTiming_;
+    TimingHistogram   stageTiming_[kMaxStages];
+    TimingHistogram   controllerTiming_[kMaxControllers];
+    std::array<std::atomic<bool>, kMaxSegments> statsResetPending_ = {};
+#endif
 };
 
 } // namespace hexcaster
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace hexcaster {
+
+/**
+ * Monotonic cycle counter used by the pipeline's timing instrumentation.
+ *
+ *   aarch64: CNTVCT_EL0 (generic timer; 54 MHz on the Pi 5)
+ *   x86:     RDTSC (invariant TSC on anything recent)
+ *   other:   std::chrono::steady_clock in nanoseconds
+ *
+ * readCycleCounter() is a single instruction on the first two and is safe
+ * to call from the audio thread. cycleCounterHz() converts ticks to time;
+ * on x86 it calibrates against steady_clock on first use (~20 ms sleep), so
+ * call it from a non-RT thread only.
+ */
+inline uint64_t readCycleCounter()
+{
+#if defined(__aarch64__)
+    uint64_t v;
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(v) :: "memory");
+    return v;
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/** Counter frequency in Hz. Not RT-safe (may calibrate on first call). */
+double cycleCounterHz();
+
+/**
+ * TimingSnapshot: plain copy of a TimingHistogram, safe to inspect at leisure.
+ *
+ * Bucket b counts samples with floor(log2(cycles)) == b (bucket 0 also
+ * holds 0 and 1 cycles), so percentiles are resolved to a factor of two --
+ * plenty to tell a 40 us stage from a 400 us one.
+ */
+struct TimingSnapshot {
+    static constexpr int kNumBuckets = 40;
+
+    uint64_t count       = 0;
+    uint64_t totalCycles = 0;
+    uint64_t maxCycles   = 0;
+    uint64_t buckets[kNumBuckets] = {};
+
+    double meanCycles() const
+    {
+        return count ? static_cast<double>(totalCycles) / static_cast<double>(count) : 0.0;
+    }
+
+    /** Upper edge of the bucket holding the p-th fraction (0..1) of samples. */
+    double percentileCycles(double p) const
+    {
+        if (count == 0) return 0.0;
+        const double target = p * static_cast<double>(count);
+        uint64_t seen = 0;
+        for (int b = 0; b < kNumBuckets; ++b) {
+            seen += buckets[b];
+            if (static_cast<double>(seen) >= target) {
+                const double edge = static_cast<double>(uint64_t{ 2 } << b);
+                return edge < static_cast<double>(maxCycles) ? edge
+                                                             : static_cast<double>(maxCycles);
+            }
+        }
+        return static_cast<double>(maxCycles);
+    }
+};
+
+/**
+ * TimingHistogram: log2 histogram of durations with a single writer.
+ *
+ * Real-time safety:
+ *   record() is called from one thread only (the audio thread, or the
+ *   pipeline worker that owns the stage). Every field is an atomic
+ *   updated with a relaxed load + store (no read-modify-write, no lock
+ *   prefix), so the writer never waits and costs a handful of plain stores.
+ *   snapshot() may be called concurrently from any other thread; it sees
+ *   each field atomically, but fields can be one block apart from each
+ *   other. That skew is irrelevant for monitoring.
+ */
+class TimingHistogram {
+public:
+    static constexpr int kNumBuckets = TimingSnapshot::kNumBuckets;
+
+    void record(uint64_t cycles)
+    {
+        const int b = bucketFor(cycles);
+        bump(buckets_[b], 1);
+        bump(count_, 1);
+        bump(totalCycles_, cycles);
+        if (cycles > maxCycles_.load(std::memory_order_relaxed))
+            maxCycles_.store(cycles, std::memory_order_relaxed);
+    }
+
+    /** Zero every field. Writer thread only. */
+    void clear()
+    {
+        for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        totalCycles_.store(0, std::memory_order_relaxed);
+        maxCycles_.store(0, std::memory_order_relaxed);
+    }
+
+    TimingSnapshot snapshot() const
+    {
+        TimingSnapshot s;
+        s.count       = count_.load(std::memory_order_relaxed);
+        s.totalCycles = totalCycles_.load(std::memory_order_relaxed);
+        s.maxCycles   = maxCycles_.load(std::memory_order_relaxed);
+        for (int b = 0; b < kNumBuckets; ++b)
+            s.buckets[b] = buckets_[b].load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static int bucketFor(uint64_t cycles)
+    {
+        if (cycles < 2) return 0;
+        const int b = 63 - __builtin_clzll(cycles);
+        return b < kNumBuckets ? b : kNumBuckets - 1;
+    }
+
+    static void bump(std::atomic<uint64_t>& a, uint64_t by)
+    {
+        a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> buckets_[kNumBuckets] = {};
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> totalCycles_{ 0 };
+    std::atomic<uint64_t> maxCycles_{ 0 };
+};
+
+} // namespace hexcaster
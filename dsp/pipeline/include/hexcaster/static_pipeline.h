@@ -0,0 +1,137 @@
+#pragma once
+
+#include "hexcaster/gain_stage.h"
+#include "hexcaster/processor_stage.h"
+#include "hexcaster/rt_sanitizer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace hexcaster {
+
+/**
+ * Stage types that can apply an OutputGain on their own output pass.
+ */
+template <typename Stage>
+concept FusesOutputGain = requires(Stage& stage, float* buffer, int numSamples, const OutputGain& gain) {
+    stage.process(buffer, numSamples, gain);
+};
+
+/**
+ * StaticPipeline: a fixed chain of stages whose types are known at compile
+ * time -- the alternative to Pipeline for hosts that never rearrange it.
+ *
+ *   StaticPipeline chain(noiseGate, inputGain, nam, tone, eq, masterVolume);
+ *   // StaticPipeline<NoiseGate, GainStage, NamStage, ToneEQ, MidSweepEQ, GainStage>
+ *
+ * - Does not own the stages; they are referenced, in chain order.
+ * - Every call is a qualified call on the concrete type (Stage::process),
+ *   so there is no vtable dispatch and no stage pointer array; the chain
+ *   unrolls into straight-line code.
+ * - Fusion: a GainStage directly after a stage that satisfies
+ *   FusesOutputGain (NoiseGate, MidSweepEQ) is not run as a pass of its
+ *   own. Its gain for the block (GainStage::nextGain()) is handed to the
+ *   stage before it, which applies it while writing its output. The
+ *   standard chain makes three passes over the buffer instead of five.
+ * - Micro-blocks work as in Pipeline (setMicroBlockSize()).
+ *
+ * Not supported, by design: controllers, pipelined segments and timing
+ * stats. Hosts that need those at runtime use Pipeline.
+ *
+ * Thread safety: as Pipeline. prepare() is non-RT; process() and reset()
+ * are audio thread, RT-safe.
+ */
+template <typename... Stages>
+class StaticPipeline {
+public:
+    static constexpr int kNumStages = static_cast<int>(sizeof...(Stages));
+
+    explicit StaticPipeline(Stages&... stages) : stages_(stages...) {}
+
+    StaticPipeline(const StaticPipeline&)            = delete;
+    StaticPipeline& operator=(const StaticPipeline&) = delete;
+
+    /** As Pipeline::setMicroBlockSize(). Call before prepare(). */
+    void setMicroBlockSize(int samples) { microBlockSize_ = std::max(samples, 0); }
+    int  microBlockSize() const { return microBlockSize_; }
+
+    /** Block size the stages were last prepared with. */
+    int  stageBlockSize() const { return stageBlockSize_; }
+
+    /** Prepare all stages. Not real-time safe. */
+    void prepare(float sampleRate, int maxBlockSize)
+    {
+        stageBlockSize_ = microBlockSize_ > 0 ? std::min(microBlockSize_, maxBlockSize)
+                                              : maxBlockSize;
+        std::apply([&](Stages&... s) { (s.Stages::prepare(sampleRate, stageBlockSize_), ...); }, stages_);
+    }
+
+    /** Process one block of audio in place. Real-time safe. */
+    void process(float* buffer, int numSamples)
+    {
+        const RtScope rtScope;
+        const int step = microBlockSize_ > 0 ? microBlockSize_ : numSamples;
+        for (int offset = 0; offset < numSamples; offset += step) {
+            runFrom<0>(buffer + offset, std::min(step, numSamples - offset));
+        }
+    }
+
+    /** Reset all stages. Real-time safe. */
+    void reset()
+    {
+        std::apply([](Stages&... s) { (s.Stages::reset(), ...); }, stages_);
+    }
+
+    static constexpr int numStages() { return kNumStages; }
+
+    /** Samples of delay the stages add (sum of latencySamples()). */
+    int latencySamples() const
+    {
+        return std::apply([](const Stages&... s) { return (0 + ... + s.Stages::latencySamples()); }, stages_);
+    }
+
+    /** Stage I, by reference. */
+    template <std::size_t I>
+    auto& stage() { return std::get<I>(stages_); }
+
+private:
+    template <std::size_t I>
+    using StageAt = std::tuple_element_t<I, std::tuple<Stages...>>;
+
+    // Stage I + 1 is a GainStage that stage I applies on its output pass.
+    template <std::size_t I>
+    static constexpr bool fusesNext()
+    {
+        if constexpr (I + 1 < sizeof...(Stages)) {
+            return FusesOutputGain<StageAt<I>> && std::is_same_v<StageAt<I + 1>, GainStage>;
+        } else {
+            return false;
+        }
+    }
+
+    template <std::size_t I>
+    void runFrom(float* block, int n)
+    {
+        if constexpr (I < sizeof...(Stages)) {
+            using Stage  = StageAt<I>;
+            Stage& stage = std::get<I>(stages_);
+
+            if constexpr (fusesNext<I>()) {
+                const OutputGain gain = std::get<I + 1>(stages_).nextGain(n);
+                stage.Stage::process(block, n, gain);
+                runFrom<I + 2>(block, n);
+            } else {
+                stage.Stage::process(block, n);
+                runFrom<I + 1>(block, n);
+            }
+        }
+    }
+
+    std::tuple<Stages&...> stages_;
+    int microBlockSize_ = 0;
+    int stageBlockSize_ = 0;
+};
+
+} // namespace hexcaster
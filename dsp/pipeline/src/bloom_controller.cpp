@@ -0,0 +1,121 @@
+#include "hexcaster/bloom_controller.h"
+#include "hexcaster/gain_stage.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace hexcaster {
+
+// 10^(dB/20) = 2^x with x = dB * log2(10) / 20. x = n + f with f in [0, 1):
+// 2^f from a degree-5 polynomial, 2^n written straight into the exponent
+// bits. No libm call and no branches, so loops over it vectorize.
+// Valid for |x| < 126, far beyond GainStage's dB range.
+static inline float dbToLinearFast(float db)
+{
+    const float   x = db * 0.166096404744f;
+    const int32_t n = static_cast<int32_t>(x + 128.f) - 128;   // floor(x)
+    const float   f = x - static_cast<float>(n);
+
+    float p = 1.8775767e-3f;
+    p = p * f + 8.9893397e-3f;
+    p = p * f + 5.5826318e-2f;
+    p = p * f + 2.4015361e-1f;
+    p = p * f + 6.9315308e-1f;
+    p = p * f + 1.f;
+
+    return p * std::bit_cast<float>((n + 127) << 23);
+}
+
+BloomController::BloomController(GainStage&     preGainStage,
+                                 GainStage&     postGainStage,
+                                 int            preStageIndex,
+                                 int            postStageIndex,
+                                 ParamRegistry& registry)
+    : preGainStage_(preGainStage)
+    , postGainStage_(postGainStage)
+    , preStageIndex_(preStageIndex)
+    , postStageIndex_(postStageIndex)
+    , registry_(registry)
+{
+}
+
+void BloomController::prepare(float sampleRate, int maxBlockSize)
+{
+    refreshParams();
+
+    EnvelopeFollower::Config config;
+    config.attackMs  = attackMs_;
+    config.releaseMs = releaseMs_;
+    follower_.prepare(sampleRate, maxBlockSize, config);
+
+    const auto size = static_cast<std::size_t>(std::max(maxBlockSize, 1));
+    envBuffer_.assign(size, 0.f);
+    preGain_.assign(size, 1.f);
+    postGain_.assign(size, 1.f);
+
+    reset();
+}
+
+void BloomController::reset()
+{
+    follower_.reset();
+    envelope_          = 0.f;
+    trajectoriesReady_ = false;
+}
+
+void BloomController::refreshParams()
+{
+    basePreDb_  = registry_.get(ParamId::BloomBasePre_dB);
+    basePostDb_ = registry_.get(ParamId::BloomBasePost_dB);
+    preDepth_   = registry_.get(ParamId::BloomPreDepth);
+    postDepth_  = registry_.get(ParamId::BloomPostDepth);
+
+    // The follower's ballistics cost exp calls: only on change.
+    const float attackMs  = registry_.get(ParamId::EnvAttackMs);
+    const float releaseMs = registry_.get(ParamId::EnvReleaseMs);
+    if (attackMs != attackMs_ || releaseMs != releaseMs_) {
+        attackMs_  = attackMs;
+        releaseMs_ = releaseMs;
+        follower_.setBallistics(attackMs, releaseMs);
+    }
+}
+
+void BloomController::preProcess(const float* buffer, int numSamples)
+{
+    // Larger than prepared for: leave the stages on their own targets.
+    trajectoriesReady_ = numSamples > 0 && numSamples <= static_cast<int>(envBuffer_.size());
+    if (!trajectoriesReady_) return;
+
+    refreshParams();
+
+    float* env = envBuffer_.data();
+    envelope_  = follower_.process(buffer, numSamples, env);
+
+    const float basePre  = basePreDb_,  preDepth  = preDepth_;
+    const float basePost = basePostDb_, postDepth = postDepth_;
+    float* pre  = preGain_.data();
+    float* post = postGain_.data();
+
+    for (int i = 0; i < numSamples; ++i) {
+        const float db = std::clamp(basePre - preDepth * env[i], GainStage::kMinDb, GainStage::kMaxDb);
+        pre[i] = dbToLinearFast(db);
+    }
+    for (int i = 0; i < numSamples; ++i) {
+        const float db = std::clamp(basePost + postDepth * env[i], GainStage::kMinDb, GainStage::kMaxDb);
+        post[i] = dbToLinearFast(db);
+    }
+
+    if (preStageIndex_ == 0) preGainStage_.setGainTrajectory(pre);
+}
+
+void BloomController::betweenStages(int stageIndex, float* /*buffer*/, int /*numSamples*/)
+{
+    if (!trajectoriesReady_) return;
+
+    // Hand each trajectory over right before its stage runs.
+    if (stageIndex == preStageIndex_ - 1)  preGainStage_.setGainTrajectory(preGain_.data());
+    if (stageIndex == postStageIndex_ - 1) postGainStage_.setGainTrajectory(postGain_.data());
+}
+
+} // namespace hexcaster
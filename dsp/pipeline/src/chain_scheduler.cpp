@@ -0,0 +1,122 @@
+#include "hexcaster/chain_scheduler.h"
+#include "hexcaster/rt_sanitizer.h"
+#include "hexcaster/rt_thread.h"
+#include <cassert>
+
+namespace hexcaster {
+
+ChainScheduler::~ChainScheduler()
+{
+    stop();
+}
+
+bool ChainScheduler::start(int numWorkers, Job job, const int* workerCpus)
+{
+    if (numWorkers < 0 || numWorkers > kMaxWorkers) return false;
+
+    stop();
+
+    job_        = std::move(job);
+    numWorkers_ = numWorkers;
+
+    // Job j's home is thread j % (numWorkers + 1); thread 0 is the caller.
+    const int participants = numWorkers + 1;
+    homeJobs_.fill(0);
+    for (int j = 0; j < kMaxJobs; ++j) {
+        homeJobs_[j % participants] |= 1u << j;
+    }
+
+    // Workers start from the current period, so one that is slow to start
+    // still wakes for the first run().
+    const uint32_t period = period_.load(std::memory_order_relaxed);
+    stopWorkers_.store(false, std::memory_order_relaxed);
+    for (int w = 0; w < numWorkers; ++w) {
+        workerCpus_[w + 1] = workerCpus ? workerCpus[w] : -1;
+        workers_[w] = std::thread([this, w, period] { workerLoop(w + 1, period); });
+    }
+    return true;
+}
+
+void ChainScheduler::stop()
+{
+    stopWorkers_.store(true, std::memory_order_release);
+    period_.fetch_add(1, std::memory_order_release);
+    period_.notify_all();
+    for (auto& w : workers_) {
+        if (w.joinable()) w.join();
+    }
+    numWorkers_ = 0;
+}
+
+void ChainScheduler::run(int numJobs)
+{
+    assert(numJobs >= 0 && numJobs <= kMaxJobs);
+    if (numJobs <= 0) return;
+
+    if (numWorkers_ == 0) {
+        for (int j = 0; j < numJobs; ++j) job_(j);
+        return;
+    }
+
+    // Publish the period: job bits past numJobs start out claimed.
+    const uint32_t period = period_.load(std::memory_order_relaxed) + 1;
+    const uint32_t unused = numJobs == kMaxJobs ? 0u : ~((1u << numJobs) - 1u);
+    remaining_.store(static_cast<uint32_t>(numJobs), std::memory_order_relaxed);
+    claims_.store((static_cast<uint64_t>(period) << 32) | unused, std::memory_order_release);
+    period_.store(period, std::memory_order_release);
+    period_.notify_all();
+
+    // Take part, then join: wait until the workers finished what they took.
+    const uint32_t ran = static_cast<uint32_t>(runJobs(0, period));
+    uint32_t left = remaining_.fetch_sub(ran, std::memory_order_acq_rel) - ran;
+    while (left != 0) {
+        left = waitForChange(remaining_, left);
+    }
+}
+
+int ChainScheduler::runJobs(int participant, uint32_t period)
+{
+    const uint32_t home = homeJobs_[participant];
+    int ran = 0;
+
+    uint64_t claims = claims_.load(std::memory_order_acquire);
+    for (;;) {
+        if (static_cast<uint32_t>(claims >> 32) != period) break;   // late for this period
+        const uint32_t open = ~static_cast<uint32_t>(claims);
+        if (open == 0) break;
+
+        // Home jobs first, then steal whatever is left.
+        const uint32_t mine = open & home;
+        const int      job  = __builtin_ctz(mine != 0 ? mine : open);
+        if (!claims_.compare_exchange_weak(claims, claims | (uint64_t{ 1 } << job),
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+            continue;
+        }
+
+        job_(job);
+        ++ran;
+        claims = claims_.load(std::memory_order_acquire);
+    }
+    return ran;
+}
+
+void ChainScheduler::workerLoop(int participant, uint32_t seen)
+{
+    // Best-effort, like the audio thread's own SCHED_FIFO request.
+    pinCurrentThreadToCpu(workerCpus_[participant]);
+    if (workerPriority_ > 0) setCurrentThreadRealtime(workerPriority_);
+
+    for (;;) {
+        seen = waitForChange(period_, seen);
+        if (stopWorkers_.load(std::memory_order_acquire)) return;
+
+        const RtScope rtScope;
+        const uint32_t ran = static_cast<uint32_t>(runJobs(participant, seen));
+        if (ran > 0 && remaining_.fetch_sub(ran, std::memory_order_acq_rel) == ran) {
+            remaining_.notify_one();
+        }
+    }
+}
+
+} // namespace hexcaster
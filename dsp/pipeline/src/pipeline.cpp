@@ -1,8 +1,17 @@
 #include "hexcaster/pipeline.h"
+#include "hexcaster/rt_sanitizer.h"
+#include "hexcaster/rt_thread.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 namespace hexcaster {
 
+Pipeline::~Pipeline()
+{
+    stopWorkers();
+}
+
 void Pipeline::addStage(ProcessorStage* stage)
 {
     assert(numStages_ < kMaxStages && "Pipeline stage limit exceeded");
@@ -17,38 +26,525 @@ void Pipeline::addController(PipelineController* controller)
     controllers_[numControllers_++] = controller;
 }
 
+bool Pipeline::setCutPoints(const int* cuts, int numCuts, const int* workerCpus)
+{
+    if (numCuts < 0 || numCuts >= kMaxSegments) return false;
+    if (numCuts > 0 && numChannels_ > 1) return false;
+
+    int prev = 0;
+    for (int i = 0; i < numCuts; ++i) {
+        if (cuts[i] <= prev || cuts[i] >= numStages_) return false;
+        prev = cuts[i];
+    }
+
+    stopWorkers();
+
+    numSegments_     = numCuts + 1;
+    segmentStart_[0] = 0;
+    for (int i = 0; i < numCuts; ++i) {
+        segmentStart_[i + 1] = cuts[i];
+        workerCpus_[i + 1]   = workerCpus ? workerCpus[i] : -1;
+    }
+    return true;
+}
+
+bool Pipeline::setNumChannels(int numChannels)
+{
+    if (numChannels < 1 || numChannels > AudioBlock::kMaxChannels) return false;
+    if (numChannels > 1 && numSegments_ > 1) return false;
+    for (int i = 0; i < numStages_; ++i) {
+        if (stages_[i]->maxChannels() < numChannels) return false;
+    }
+
+    numChannels_ = numChannels;
+    return true;
+}
+
+void Pipeline::setMicroBlockSize(int samples)
+{
+    microBlockSize_ = std::max(samples, 0);
+}
+
 void Pipeline::prepare(float sampleRate, int maxBlockSize)
 {
+    // Workers must be idle while stages are re-prepared.
+    stopWorkers();
+
     sampleRate_   = sampleRate;
     maxBlockSize_ = maxBlockSize;
 
+    // Stages never see more than one micro-block at a time.
+    stageBlockSize_ = microBlockSize_ > 0 ? std::min(microBlockSize_, maxBlockSize)
+                                          : maxBlockSize;
     for (int i = 0; i < numStages_; ++i) {
-        stages_[i]->prepare(sampleRate, maxBlockSize);
+        stages_[i]->prepare(sampleRate, stageBlockSize_);
+    }
+
+    bypassFadeSamples_ = std::max(1, static_cast<int>(kBypassFadeMs * 0.001f * sampleRate));
+    for (int s = 0; s < numSegments_; ++s) {
+        dry_[s].assign(static_cast<std::size_t>(std::max(stageBlockSize_, 1)) * numChannels_, 0.f);
     }
+    clearBypass(0, numStages_);
+
+    if (numSegments_ > 1) startWorkers();
 }
 
 void Pipeline::process(float* buffer, int numSamples)
 {
-    // 1. Notify controllers before any stages run
-    for (int c = 0; c < numControllers_; ++c) {
-        controllers_[c]->preProcess(buffer, numSamples);
+    const RtScope rtScope;
+
+    if (numSegments_ > 1) {
+        processPipelined(buffer, numSamples);
+        return;
     }
 
-    // 2. Process stages in order, notifying controllers between each
-    for (int s = 0; s < numStages_; ++s) {
-        stages_[s]->process(buffer, numSamples);
+#if HEXCASTER_PIPELINE_STATS
+    processTimed(buffer, numSamples);
+#else
+    // Run the whole chain on one micro-block at a time.
+    const int step = microBlockSize_ > 0 ? microBlockSize_ : numSamples;
+    for (int offset = 0; offset < numSamples; offset += step) {
+        float*    block = buffer + offset;
+        const int n     = std::min(step, numSamples - offset);
 
+        // 1. Notify controllers before any stages run
         for (int c = 0; c < numControllers_; ++c) {
-            controllers_[c]->betweenStages(s, buffer, numSamples);
+            controllers_[c]->preProcess(block, n);
+        }
+
+        // 2. Process stages in order, notifying controllers between each
+        for (int s = 0; s < numStages_; ++s) {
+            runStage(s, AudioBlock::mono(block, n), dry_[0].data());
+
+            for (int c = 0; c < numControllers_; ++c) {
+                controllers_[c]->betweenStages(s, block, n);
+            }
+        }
+    }
+#endif
+}
+
+void Pipeline::process(const AudioBlock& block)
+{
+    if (block.numChannels == 1) {
+        process(block.channels[0], block.numSamples);
+        return;
+    }
+
+    const RtScope rtScope;
+    assert(block.numChannels == numChannels_ && "Pipeline prepared for another channel count");
+
+    // As the serial mono loop; controllers see channel 0.
+    const int step = microBlockSize_ > 0 ? microBlockSize_ : block.numSamples;
+    for (int offset = 0; offset < block.numSamples; offset += step) {
+        const int        n     = std::min(step, block.numSamples - offset);
+        const AudioBlock slice = block.slice(offset, n);
+        float*           first = slice.channels[0];
+
+        for (int c = 0; c < numControllers_; ++c) {
+            controllers_[c]->preProcess(first, n);
+        }
+
+        for (int s = 0; s < numStages_; ++s) {
+            runStage(s, slice, dry_[0].data());
+
+            for (int c = 0; c < numControllers_; ++c) {
+                controllers_[c]->betweenStages(s, first, n);
+            }
         }
     }
 }
 
 void Pipeline::reset()
 {
+    if (numSegments_ > 1) {
+        // Stages may be mid-block on a worker; let each segment reset its
+        // own stages on its own thread.
+        for (int s = 0; s < numSegments_; ++s)
+            resetPending_[s].store(true, std::memory_order_release);
+        return;
+    }
+
     for (int i = 0; i < numStages_; ++i) {
         stages_[i]->reset();
     }
+    clearBypass(0, numStages_);
+}
+
+// ---------------------------------------------------------------------------
+// Identity bypass
+// ---------------------------------------------------------------------------
+
+// Run one stage on one micro-block: skipped while it is at identity,
+// crossfaded in from the dry signal for bypassFadeSamples_ after leaving.
+// dry holds one plane per channel.
+void Pipeline::runStage(int stage, const AudioBlock& block, float* dry)
+{
+    const auto s = static_cast<std::size_t>(stage);
+    ProcessorStage* st = stages_[s];
+    const int numSamples = block.numSamples;
+
+    auto run = [&] {
+        if (block.numChannels == 1) st->process(block.channels[0], numSamples);
+        else                        st->processChannels(block);
+    };
+
+    if (!autoBypass_) {
+        run();
+        return;
+    }
+
+    if (st->isIdentity()) {
+        bypassed_[s]      = true;
+        fadeRemaining_[s] = 0;
+        return;
+    }
+    if (bypassed_[s]) {
+        bypassed_[s]      = false;
+        fadeRemaining_[s] = bypassFadeSamples_;
+    }
+    if (fadeRemaining_[s] == 0) {
+        run();
+        return;
+    }
+
+    for (int c = 0; c < block.numChannels; ++c) {
+        std::memcpy(dry + c * numSamples, block.channels[c], static_cast<std::size_t>(numSamples) * sizeof(float));
+    }
+    run();
+
+    // Linear dry -> wet ramp, continuing across blocks.
+    const float inv  = 1.f / static_cast<float>(bypassFadeSamples_);
+    const float w0   = static_cast<float>(bypassFadeSamples_ - fadeRemaining_[s]) * inv;
+    const int   len  = std::min(numSamples, fadeRemaining_[s]);
+    for (int c = 0; c < block.numChannels; ++c) {
+        float*       x = block.channels[c];
+        const float* d = dry + c * numSamples;
+        for (int i = 0; i < len; ++i) {
+            const float w = w0 + static_cast<float>(i + 1) * inv;
+            x[i] = d[i] + w * (x[i] - d[i]);
+        }
+    }
+    fadeRemaining_[s] -= len;
+}
+
+void Pipeline::clearBypass(int first, int last)
+{
+    for (int s = first; s < last; ++s) {
+        bypassed_[static_cast<std::size_t>(s)]      = false;
+        fadeRemaining_[static_cast<std::size_t>(s)] = 0;
+    }
+}
+
+int Pipeline::latencySamples() const
+{
+    int total = 0;
+    for (int i = 0; i < numStages_; ++i) total += stages_[i]->latencySamples();
+    return total;
+}
+
+// ---------------------------------------------------------------------------
+// Pipelined execution
+// ---------------------------------------------------------------------------
+
+// Run one segment's stages in order, on the calling thread, one
+// micro-block at a time. Only segment 0 (the audio thread) calls the
+// controllers: a worker calling them would race with the audio thread's
+// preProcess() for the next block.
+void Pipeline::runSegment(int segment, float* buffer, int numSamples)
+{
+    const int first = segmentStart_[segment];
+    const int last  = segment + 1 < numSegments_ ? segmentStart_[segment + 1] : numStages_;
+
+    if (resetPending_[segment].exchange(false, std::memory_order_acq_rel)) {
+        for (int s = first; s < last; ++s) stages_[s]->reset();
+        clearBypass(first, last);
+    }
+
+#if HEXCASTER_PIPELINE_STATS
+    runSegmentTimed(segment, first, last, buffer, numSamples);
+#else
+    const int step = microBlockSize_ > 0 ? microBlockSize_ : numSamples;
+    for (int offset = 0; offset < numSamples; offset += step) {
+        float*    block = buffer + offset;
+        const int n     = std::min(step, numSamples - offset);
+
+        if (segment == 0) {
+            for (int c = 0; c < numControllers_; ++c) {
+                controllers_[c]->preProcess(block, n);
+            }
+        }
+
+        for (int s = first; s < last; ++s) {
+            runStage(s, AudioBlock::mono(block, n), dry_[segment].data());
+
+            if (segment == 0) {
+                for (int c = 0; c < numControllers_; ++c) {
+                    controllers_[c]->betweenStages(s, block, n);
+                }
+            }
+        }
+    }
+#endif
+}
+
+// Audio thread. Runs segment 0 on this block, hands it on, and returns the
+// block that entered the pipeline numSegments_ - 1 calls ago. Host block
+// sizes are expected to be fixed; if they change, the returned block is
+// truncated or zero-padded to numSamples.
+void Pipeline::processPipelined(float* buffer, int numSamples)
+{
+#if HEXCASTER_PIPELINE_STATS
+    takeStatsReset(0, 0, segmentStart_[1]);
+    const uint64_t blockStart = readCycleCounter();
+#endif
+
+    runSegment(0, buffer, numSamples);
+
+    // numSegments_ slots; numSegments_ - 1 are always in flight, so one is free.
+    const int slot = freeSlots_[--numFreeSlots_];
+    BlockSlot& in = slots_[slot];
+    std::memcpy(in.samples.data(), buffer, static_cast<std::size_t>(numSamples) * sizeof(float));
+    in.numSamples = numSamples;
+    pushSlot(0, slot);
+
+    const int done = popSlot(numSegments_ - 1);
+    if (done < 0) return;   // workers stopped underneath us (teardown)
+
+    const BlockSlot& out = slots_[done];
+    const int n = std::min(numSamples, out.numSamples);
+    std::memcpy(buffer, out.samples.data(), static_cast<std::size_t>(n) * sizeof(float));
+    std::fill(buffer + n, buffer + numSamples, 0.f);
+    freeSlots_[numFreeSlots_++] = done;
+
+#if HEXCASTER_PIPELINE_STATS
+    blockTiming_.record(readCycleCounter() - blockStart);
+#endif
+}
+
+// Non-RT. Workers are stopped, so every queue and slot is ours.
+void Pipeline::startWorkers()
+{
+    int slot = 0;
+    for (int q = 0; q < kMaxSegments; ++q) {
+        while (queues_[q].pop(slot)) {}
+    }
+
+    // Fill the pipeline: numSegments_ - 1 silent blocks wait on the return
+    // queue, the remaining slot is free for the first process() call.
+    const int last = numSegments_ - 1;
+    for (int i = 0; i < numSegments_; ++i) {
+        slots_[i].samples.assign(static_cast<std::size_t>(maxBlockSize_), 0.f);
+        slots_[i].numSamples = 0;
+        if (i < last) queues_[last].push(i);
+    }
+    freeSlots_[0] = last;
+    numFreeSlots_ = 1;
+
+    for (auto& r : resetPending_) r.store(false, std::memory_order_relaxed);
+
+    stopWorkers_.store(false, std::memory_order_relaxed);
+    for (int s = 1; s < numSegments_; ++s) {
+        workers_[s] = std::thread([this, s] { workerLoop(s); });
+    }
+}
+
+void Pipeline::stopWorkers()
+{
+    stopWorkers_.store(true, std::memory_order_release);
+    for (int s = 0; s < kMaxSegments; ++s) {
+        signals_[s].fetch_add(1, std::memory_order_release);
+        signals_[s].notify_all();
+    }
+    for (auto& w : workers_) {
+        if (w.joinable()) w.join();
+    }
+}
+
+void Pipeline::workerLoop(int segment)
+{
+    // Best-effort, like the audio thread's own SCHED_FIFO request.
+    pinCurrentThreadToCpu(workerCpus_[segment]);
+    if (workerPriority_ > 0) setCurrentThreadRealtime(workerPriority_);
+
+    for (;;) {
+        const int slot = popSlot(segment - 1);
+        if (slot < 0) return;
+
+        BlockSlot& block = slots_[slot];
+        {
+            const RtScope rtScope;
+            runSegment(segment, block.samples.data(), block.numSamples);
+        }
+        pushSlot(segment, slot);
+    }
+}
+
+// Consumer of queues_[queue]. Waits for a slot; returns -1 once the
+// workers are being stopped.
+int Pipeline::popSlot(int queue)
+{
+    for (;;) {
+        // Read the signal before trying the queue, so a push that lands in
+        // between still wakes us.
+        const uint32_t sig = signals_[queue].load(std::memory_order_acquire);
+        int slot = -1;
+        if (queues_[queue].pop(slot)) return slot;
+        if (stopWorkers_.load(std::memory_order_acquire)) return -1;
+        waitForChange(signals_[queue], sig);
+    }
+}
+
+// Producer of queues_[queue]. Never full: there are only numSegments_ slots.
+void Pipeline::pushSlot(int queue, int slot)
+{
+    queues_[queue].push(slot);
+    signals_[queue].fetch_add(1, std::memory_order_release);
+    signals_[queue].notify_one();
+}
+
+// ---------------------------------------------------------------------------
+// Timing instrumentation
+// ---------------------------------------------------------------------------
+
+#if HEXCASTER_PIPELINE_STATS
+
+// Same signal flow as process(), with a cycle-counter read around each call.
+// Micro-blocks of one host block are summed, so every histogram still
+// records one sample per process() call.
+void Pipeline::processTimed(float* buffer, int numSamples)
+{
+    takeStatsReset(0, 0, numStages_);
+
+    uint64_t stageCycles[kMaxStages]           = {};
+    uint64_t controllerCycles[kMaxControllers] = {};
+
+    const uint64_t blockStart = readCycleCounter();
+    uint64_t t0 = blockStart;
+
+    const int step = microBlockSize_ > 0 ? microBlockSize_ : numSamples;
+    for (int offset = 0; offset < numSamples; offset += step) {
+        float*    block = buffer + offset;
+        const int n     = std::min(step, numSamples - offset);
+
+        for (int c = 0; c < numControllers_; ++c) {
+            controllers_[c]->preProcess(block, n);
+            const uint64_t t1 = readCycleCounter();
+            controllerCycles[c] += t1 - t0;
+            t0 = t1;
+        }
+
+        for (int s = 0; s < numStages_; ++s) {
+            runStage(s, AudioBlock::mono(block, n), dry_[0].data());
+            uint64_t t1 = readCycleCounter();
+            stageCycles[s] += t1 - t0;
+            t0 = t1;
+
+            for (int c = 0; c < numControllers_; ++c) {
+                controllers_[c]->betweenStages(s, block, n);
+                t1 = readCycleCounter();
+                controllerCycles[c] += t1 - t0;
+                t0 = t1;
+            }
+        }
+    }
+
+    for (int s = 0; s < numStages_; ++s)
+        stageTiming_[s].record(stageCycles[s]);
+    for (int c = 0; c < numControllers_; ++c)
+        controllerTiming_[c].record(controllerCycles[c]);
+
+    blockTiming_.record(t0 - blockStart);
+}
+
+// runSegment() with the stages (and, on segment 0, the controllers) timed
+// as in processTimed(). Each stage belongs to one segment, so its
+// histogram has a single writer: the audio thread for segment 0, the
+// segment's worker otherwise.
+void Pipeline::runSegmentTimed(int segment, int first, int last, float* buffer, int numSamples)
+{
+    if (segment > 0) takeStatsReset(segment, first, last);
+
+    uint64_t stageCycles[kMaxStages]           = {};
+    uint64_t controllerCycles[kMaxControllers] = {};
+
+    uint64_t t0 = readCycleCounter();
+
+    const int step = microBlockSize_ > 0 ? microBlockSize_ : numSamples;
+    for (int offset = 0; offset < numSamples; offset += step) {
+        float*    block = buffer + offset;
+        const int n     = std::min(step, numSamples - offset);
+
+        if (segment == 0) {
+            for (int c = 0; c < numControllers_; ++c) {
+                controllers_[c]->preProcess(block, n);
+                const uint64_t t1 = readCycleCounter();
+                controllerCycles[c] += t1 - t0;
+                t0 = t1;
+            }
+        }
+
+        for (int s = first; s < last; ++s) {
+            runStage(s, AudioBlock::mono(block, n), dry_[segment].data());
+            uint64_t t1 = readCycleCounter();
+            stageCycles[s] += t1 - t0;
+            t0 = t1;
+
+            if (segment == 0) {
+                for (int c = 0; c < numControllers_; ++c) {
+                    controllers_[c]->betweenStages(s, block, n);
+                    t1 = readCycleCounter();
+                    controllerCycles[c] += t1 - t0;
+                    t0 = t1;
+                }
+            }
+        }
+    }
+
+    for (int s = first; s < last; ++s)
+        stageTiming_[s].record(stageCycles[s]);
+    if (segment == 0) {
+        for (int c = 0; c < numControllers_; ++c)
+            controllerTiming_[c].record(controllerCycles[c]);
+    }
+}
+
+// Zero the histograms the calling thread writes, if resetStats() asked:
+// stages [first, last), plus the block and controller histograms on the
+// audio thread (segment 0).
+void Pipeline::takeStatsReset(int segment, int first, int last)
+{
+    if (!statsResetPending_[segment].exchange(false, std::memory_order_acq_rel)) return;
+
+    for (int s = first; s < last; ++s) stageTiming_[s].clear();
+    if (segment == 0) {
+        blockTiming_.clear();
+        for (auto& h : controllerTiming_) h.clear();
+    }
+}
+
+#endif
+
+Pipeline::Stats Pipeline::stats() const
+{
+    Stats s;
+#if HEXCASTER_PIPELINE_STATS
+    s.enabled        = true;
+    s.cycleHz        = cycleCounterHz();
+    s.numStages      = numStages_;
+    s.numControllers = numControllers_;
+    s.block          = blockTiming_.snapshot();
+    for (int i = 0; i < numStages_; ++i)      s.stages[i]      = stageTiming_[i].snapshot();
+    for (int i = 0; i < numControllers_; ++i) s.controllers[i] = controllerTiming_[i].snapshot();
+#endif
+    return s;
+}
+
+void Pipeline::resetStats()
+{
+#if HEXCASTER_PIPELINE_STATS
+    for (auto& r : statsResetPending_) r.store(true, std::memory_order_release);
+#endif
 }
 
 } // namespace hexcaster
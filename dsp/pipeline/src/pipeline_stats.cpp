@@ -0,0 +1,31 @@
+#include "hexcaster/pipeline_stats.h"
+
+#include <thread>
+
+namespace hexcaster {
+
+double cycleCounterHz()
+{
+    static const double hz = []() -> double {
+#if defined(__aarch64__)
+        uint64_t freq;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+        return static_cast<double>(freq);
+#elif defined(__x86_64__) || defined(__i386__)
+        // TSC rate is not exposed portably; measure it against steady_clock.
+        using Clock = std::chrono::steady_clock;
+        const auto     wall0 = Clock::now();
+        const uint64_t tsc0  = readCycleCounter();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const auto     wall1 = Clock::now();
+        const uint64_t tsc1  = readCycleCounter();
+        const double seconds = std::chrono::duration<double>(wall1 - wall0).count();
+        return static_cast<double>(tsc1 - tsc0) / seconds;
+#else
+        return 1e9; // steady_clock nanoseconds
+#endif
+    }();
+    return hz;
+}
+
+} // namespace hexcaster
@@ -21,14 +21,22 @@
  *
  * The loaded model path is persisted via LV2 state (state:interface), so
  * Reaper will reload the model automatically when the project is reopened.
+ *
+ * The chain (gate, input gain, NAM, tone EQ, mid EQ, master volume) is
+ * fixed, so it runs as a StaticPipeline like the standalone host's default
+ * chain: no virtual dispatch, and both gain stages are fused into the stage
+ * before them. The tone and mid EQ have no ports; they follow the registry
+ * defaults.
  */
 
 #include "hexcaster/pipeline.h"
+#include "hexcaster/static_pipeline.h"
 #include "hexcaster/gain_stage.h"
 #include "hexcaster/nam_stage.h"
 #include "hexcaster/noise_gate.h"
 #include "hexcaster/eq.h"
 #include "hexcaster/param_registry.h"
+#include "hexcaster/rt_sanitizer.h"
 
 #include <lv2/atom/atom.h>
 #include <lv2/core/lv2.h>
@@ -113,9 +121,13 @@ struct HexCasterLV2 {
     hexcaster::NoiseGate     noiseGate;
     hexcaster::GainStage     inputGain;
     hexcaster::NamStage      nam;
+    hexcaster::ToneEQ        tone;
     hexcaster::MidSweepEQ    eq;
     hexcaster::GainStage     masterVolume;
-    hexcaster::Pipeline      pipeline;
+
+    hexcaster::StaticPipeline<hexcaster::NoiseGate, hexcaster::GainStage, hexcaster::NamStage,
+                              hexcaster::ToneEQ, hexcaster::MidSweepEQ, hexcaster::GainStage>
+        pipeline{ noiseGate, inputGain, nam, tone, eq, masterVolume };
 
     explicit HexCasterLV2(double sampleRate, const LV2_Feature* const* features)
     {
@@ -133,11 +145,9 @@ struct HexCasterLV2 {
         noiseGate.setThresholdDb(params.get(hexcaster::ParamId::NoiseGateThreshold_dB));
         inputGain.setGainDb(params.get(hexcaster::ParamId::InputGain_dB));
 
-        pipeline.addStage(&noiseGate);    // stage 0
-        pipeline.addStage(&inputGain);    // stage 1
-        pipeline.addStage(&nam);          // stage 2
-        pipeline.addStage(&eq);           // stage 3
-        pipeline.addStage(&masterVolume); // stage 4
+        // Hosts may hand over up to 4096 samples; the chain runs them in
+        // NeuralAudio-sized slices.
+        pipeline.setMicroBlockSize(hexcaster::Pipeline::kDefaultMicroBlockSize);
         pipeline.prepare(static_cast<float>(sampleRate), 4096);
     }
 
@@ -201,6 +211,8 @@ static void activate(LV2_Handle /*instance*/) {}
 
 static void run(LV2_Handle instance, uint32_t sampleCount)
 {
+    const hexcaster::RtScope rtScope;   // HEXCASTER_RT_SANITIZE
+
     auto* self = static_cast<HexCasterLV2*>(instance);
     if (!self->audioIn || !self->audioOut) return;
 
@@ -212,6 +224,12 @@ static void run(LV2_Handle instance, uint32_t sampleCount)
         self->inputGain.setGainDb(*self->inputGainCtl);
     }
 
+    self->tone.setLowCutHz (self->params.get(hexcaster::ParamId::EqLowCutHz));
+    self->tone.setBassDb   (self->params.get(hexcaster::ParamId::EqBass_dB));
+    self->tone.setBassHz   (self->params.get(hexcaster::ParamId::EqBassHz));
+    self->tone.setTrebleDb (self->params.get(hexcaster::ParamId::EqTreble_dB));
+    self->tone.setTrebleHz (self->params.get(hexcaster::ParamId::EqTrebleHz));
+    self->tone.setHighCutHz(self->params.get(hexcaster::ParamId::EqHighCutHz));
     self->eq.setGainDb (self->params.get(hexcaster::ParamId::EqGain_dB));
     self->eq.setSweepHz(self->params.get(hexcaster::ParamId::EqSweepHz));
     self->eq.setQ      (self->params.get(hexcaster::ParamId::EqQ));
@@ -256,7 +274,7 @@ static LV2_State_Status state_save(LV2_Handle                instance,
     auto* self = static_cast<HexCasterLV2*>(instance);
     if (!self->uridMap) return LV2_STATE_ERR_NO_FEATURE;
 
-    const std::string& path = self->nam.modelPath();
+    const std::string path = self->nam.modelPath();
     if (path.empty()) return LV2_STATE_SUCCESS;
 
     store(handle,
@@ -0,0 +1,299 @@
+#include "parallel_renderer.h"
+#include "render_chain.h"
+#include "wav_file.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// CLI argument parsing
+// ---------------------------------------------------------------------------
+
+struct Args {
+    std::string  inputPath;
+    std::string  outputPath;
+    std::string  modelPath;
+    unsigned int rawSampleRate   = 48000;
+    unsigned int bufferFrames    = 128;
+    float        gainDb          = 0.f;
+    float        gateThresholdDb = -60.f;
+    float        eqGainDb        = 0.f;
+    float        eqSweepHz       = 1000.f;
+    float        eqQ             = 0.8f;
+    float        eqLowCutHz      = 20.f;
+    float        eqBassDb        = 0.f;
+    float        eqBassHz        = 120.f;
+    float        eqTrebleDb      = 0.f;
+    float        eqTrebleHz      = 3000.f;
+    float        eqHighCutHz     = 20000.f;
+    float        masterVolumeDb  = 0.f;
+    int          inputChannel    = 0;
+    int          jobs            = 1;
+    float        preRollMs       = 250.f;
+    float        chunkSeconds    = 0.f;      // 0 = automatic
+    hexcaster::WavWriter::Format outFormat = hexcaster::WavWriter::Format::Float32;
+    bool         help            = false;
+};
+
+static void printUsage(const char* prog)
+{
+    std::fprintf(stderr,
+        "Usage: %s --model <path.nam> --in <di.wav> --out <out.wav> [options]\n"
+        "\n"
+        "Renders a DI file through the HexCaster chain (gate, input gain, NAM,\n"
+        "tone and mid EQ, master volume) offline, as fast as the CPU allows.\n"
+        "\n"
+        "Options:\n"
+        "  --model <path>              NAM model file (.nam)  [required]\n"
+        "  --in <path>                 Input file: WAV, or raw float32 (.f32/.raw)  [required]\n"
+        "  --out <path>                Output file: WAV, or raw float32 (.f32/.raw)  [required]\n"
+        "  --out-format <fmt>          Output WAV sample format: f32, s16, s24  [default: f32]\n"
+        "  --raw-rate <Hz>             Sample rate of raw float32 input  [default: 48000]\n"
+        "  --buffer <frames>           Processing block size in frames  [default: 128]\n"
+        "  --gain <dB>                 Input gain in dB  [default: 0.0]\n"
+        "  --gate-threshold <dB>       Noise gate threshold  [-80, 0] dB  [default: -60]\n"
+        "  --eq-gain <dB>              Post-NAM EQ gain  [-12, +12] dB  [default: 0]\n"
+        "  --eq-sweep <Hz>             Post-NAM EQ center frequency  [300, 2500] Hz  [default: 1000]\n"
+        "  --eq-q <Q>                  Post-NAM EQ bandwidth  [0.3, 3.0]  [default: 0.8]\n"
+        "  --eq-low-cut <Hz>           Post-NAM high-pass  [20, 300] Hz, 20 = off  [default: 20]\n"
+        "  --eq-bass <dB>              Post-NAM low shelf  [-12, +12] dB  [default: 0]\n"
+        "  --eq-bass-freq <Hz>         Low shelf corner  [60, 400] Hz  [default: 120]\n"
+        "  --eq-treble <dB>            Post-NAM high shelf  [-12, +12] dB  [default: 0]\n"
+        "  --eq-treble-freq <Hz>       High shelf corner  [1500, 8000] Hz  [default: 3000]\n"
+        "  --eq-high-cut <Hz>          Post-NAM low-pass  [2000, 20000] Hz, 20000 = off\n"
+        "                              [default: 20000]\n"
+        "  --master-volume <dB>        Output level  [-60, +24] dB  [default: 0]\n"
+        "  --input-channel <N>         Channel of a multichannel input to render  [default: 0]\n"
+        "  --jobs <N>                  Worker threads; 0 = one per core  [default: 1]\n"
+        "  --preroll <ms>              Warm-up rendered before each chunk; raised to the\n"
+        "                              model's minimum if shorter  [default: 250]\n"
+        "  --chunk-seconds <s>         Chunk length for --jobs > 1; 0 = automatic  [default: 0]\n"
+        "  --help                      Show this help and exit\n"
+        "\n"
+        "Example:\n"
+        "  %s --model ~/amp.nam --in take1_di.wav --out take1_amp.wav --out-format s24\n"
+        "  %s --model ~/amp.nam --in long_di.wav --out long_amp.wav --jobs 0\n",
+        prog, prog, prog);
+}
+
+static bool parseArgs(int argc, char** argv, Args& args)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* key = argv[i];
+        auto nextArg = [&]() -> const char* {
+            if (i + 1 < argc) return argv[++i];
+            std::fprintf(stderr, "Error: %s requires an argument\n", key);
+            return nullptr;
+        };
+
+        if (std::strcmp(key, "--help") == 0 || std::strcmp(key, "-h") == 0) {
+            args.help = true;
+            return true;
+        }
+
+        if (std::strcmp(key, "--model") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.modelPath = v;
+        } else if (std::strcmp(key, "--in") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.inputPath = v;
+        } else if (std::strcmp(key, "--out") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.outputPath = v;
+        } else if (std::strcmp(key, "--out-format") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            if      (std::strcmp(v, "f32") == 0) args.outFormat = hexcaster::WavWriter::Format::Float32;
+            else if (std::strcmp(v, "s16") == 0) args.outFormat = hexcaster::WavWriter::Format::Pcm16;
+            else if (std::strcmp(v, "s24") == 0) args.outFormat = hexcaster::WavWriter::Format::Pcm24;
+            else {
+                std::fprintf(stderr, "Error: --out-format must be f32, s16 or s24, got '%s'\n", v);
+                return false;
+            }
+        } else if (std::strcmp(key, "--raw-rate") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.rawSampleRate = static_cast<unsigned int>(std::atoi(v));
+        } else if (std::strcmp(key, "--buffer") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.bufferFrames = static_cast<unsigned int>(std::atoi(v));
+        } else if (std::strcmp(key, "--gain") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.gainDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--gate-threshold") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.gateThresholdDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-gain") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqGainDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-sweep") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqSweepHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-q") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqQ = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-low-cut") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqLowCutHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-bass") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqBassDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-bass-freq") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqBassHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-treble") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqTrebleDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-treble-freq") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqTrebleHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-high-cut") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqHighCutHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--master-volume") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.masterVolumeDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--input-channel") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.inputChannel = std::atoi(v);
+        } else if (std::strcmp(key, "--jobs") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.jobs = std::atoi(v);
+        } else if (std::strcmp(key, "--preroll") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.preRollMs = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--chunk-seconds") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.chunkSeconds = static_cast<float>(std::atof(v));
+        } else {
+            std::fprintf(stderr, "Unknown option: %s\n", key);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    Args args;
+    if (!parseArgs(argc, argv, args)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (args.help) { printUsage(argv[0]); return 0; }
+
+    if (args.modelPath.empty() || args.inputPath.empty() || args.outputPath.empty()) {
+        std::fprintf(stderr, "Error: --model, --in and --out are required.\n\n");
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (args.bufferFrames == 0) {
+        std::fprintf(stderr, "Error: --buffer must be > 0\n");
+        return 1;
+    }
+
+    if (args.jobs <= 0) {
+        args.jobs = static_cast<int>(std::thread::hardware_concurrency());
+        if (args.jobs <= 0) args.jobs = 1;
+    }
+
+    // -------------------------------------------------------------------------
+    // Input / output files
+    // -------------------------------------------------------------------------
+
+    unsigned int sampleRate = 0;
+    {
+        hexcaster::WavReader reader;
+        if (!reader.open(args.inputPath, args.rawSampleRate)) {
+            std::fprintf(stderr, "Error: %s\n", reader.errorMessage().c_str());
+            return 1;
+        }
+
+        sampleRate = reader.sampleRate();
+        std::fprintf(stdout, "Input: %s  rate=%u channels=%u bits=%u frames=%lld (%.1f s)\n",
+            args.inputPath.c_str(), sampleRate, reader.channels(), reader.bitsPerSample(),
+            static_cast<long long>(reader.totalFrames()),
+            static_cast<double>(reader.totalFrames()) / sampleRate);
+
+        if (args.inputChannel < 0 || args.inputChannel >= static_cast<int>(reader.channels())) {
+            std::fprintf(stderr, "Error: --input-channel %d out of range (file has %u)\n",
+                         args.inputChannel, reader.channels());
+            return 1;
+        }
+    }
+
+    hexcaster::WavWriter writer;
+    if (!writer.open(args.outputPath, sampleRate, args.outFormat)) {
+        std::fprintf(stderr, "Error: %s\n", writer.errorMessage().c_str());
+        return 1;
+    }
+
+    // -------------------------------------------------------------------------
+    // Render
+    // -------------------------------------------------------------------------
+
+    hexcaster::RenderChain::Settings settings;
+    settings.modelPath       = args.modelPath;
+    settings.gainDb          = args.gainDb;
+    settings.gateThresholdDb = args.gateThresholdDb;
+    settings.eqGainDb        = args.eqGainDb;
+    settings.eqSweepHz       = args.eqSweepHz;
+    settings.eqQ             = args.eqQ;
+    settings.eqLowCutHz      = args.eqLowCutHz;
+    settings.eqBassDb        = args.eqBassDb;
+    settings.eqBassHz        = args.eqBassHz;
+    settings.eqTrebleDb      = args.eqTrebleDb;
+    settings.eqTrebleHz      = args.eqTrebleHz;
+    settings.eqHighCutHz     = args.eqHighCutHz;
+    settings.masterVolumeDb  = args.masterVolumeDb;
+
+    hexcaster::ParallelRenderer::Options options;
+    options.jobs          = args.jobs;
+    options.blockSize     = static_cast<int>(args.bufferFrames);
+    options.inputChannel  = args.inputChannel;
+    options.rawSampleRate = args.rawSampleRate;
+    options.preRollFrames = static_cast<int64_t>(args.preRollMs * 0.001f * sampleRate);
+    options.chunkFrames   = static_cast<int64_t>(args.chunkSeconds * sampleRate);
+
+    std::fprintf(stdout, "Model: %s\n", args.modelPath.c_str());
+
+    const auto start = std::chrono::steady_clock::now();
+
+    hexcaster::ParallelRenderer renderer;
+    if (!renderer.render(args.inputPath, writer, settings, options)) {
+        std::fprintf(stderr, "Error: %s\n", renderer.errorMessage().c_str());
+        return 1;
+    }
+
+    if (!writer.close()) {
+        std::fprintf(stderr, "Error: %s\n", writer.errorMessage().c_str());
+        return 1;
+    }
+
+    const double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    const double audioSeconds = static_cast<double>(writer.framesWritten()) / sampleRate;
+
+    std::fprintf(stdout,
+        "Rendered %.2f s of audio in %.2f s  (%.1fx real-time, %d job(s), %d chunk(s))\n"
+        "Output: %s\n",
+        audioSeconds, elapsed, elapsed > 0.0 ? audioSeconds / elapsed : 0.0,
+        renderer.jobsUsed(), renderer.chunksRendered(),
+        args.outputPath.c_str());
+
+    if (renderer.chunksRendered() > 1) {
+        const int64_t requested = options.preRollFrames;
+        const int64_t used      = renderer.preRollFramesUsed();
+        std::fprintf(stdout, "Pre-roll: %.0f ms per chunk%s\n",
+            1000.0 * static_cast<double>(used) / sampleRate,
+            used > requested ? " (raised from --preroll to cover the model)" : "");
+    }
+
+    return 0;
+}
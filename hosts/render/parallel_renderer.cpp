@@ -0,0 +1,147 @@
+#include "parallel_renderer.h"
+#include "wav_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hexcaster {
+
+// Frames pulled from disk per read by each worker, before rounding down to
+// a whole number of blocks.
+static constexpr int kStreamFrames = 16384;
+
+// Automatic chunking: aim for a few chunks per worker so a slow chunk at the
+// end doesn't leave the other cores idle, but keep each chunk long enough
+// that the pre-roll overhead stays in the low single-digit percent.
+static constexpr int64_t kChunksPerJob     = 4;
+static constexpr int64_t kMinChunkPreRolls = 40;
+
+bool ParallelRenderer::render(const std::string&           inputPath,
+                              WavWriter&                   writer,
+                              const RenderChain::Settings& settings,
+                              const Options&               options)
+{
+    // Probe length and rate once; each worker opens its own reader.
+    unsigned int sampleRate = 0;
+    {
+        WavReader probe;
+        if (!probe.open(inputPath, options.rawSampleRate)) {
+            errorMsg_ = probe.errorMessage();
+            return false;
+        }
+        totalFrames_ = probe.totalFrames();
+        sampleRate   = probe.sampleRate();
+    }
+
+    const int blockSize = std::max(options.blockSize, 1);
+
+    // RenderChain::process slices each read from its start, so reads must
+    // be whole blocks for every chunk to run on the serial render's grid.
+    const int streamFrames = std::max(kStreamFrames / blockSize * blockSize, blockSize);
+    jobs_ = std::max(options.jobs, 1);
+
+    // The pre-roll must cover the chain's settling time for this model.
+    preRoll_ = std::max<int64_t>(options.preRollFrames, 0);
+    if (jobs_ > 1)
+        preRoll_ = std::max(preRoll_, RenderChain::minPreRollFrames(settings, static_cast<float>(sampleRate)));
+    const int64_t preRoll = preRoll_;
+
+    int64_t chunk = options.chunkFrames;
+    if (jobs_ == 1) {
+        chunk = totalFrames_;
+    } else if (chunk <= 0) {
+        chunk = (totalFrames_ + jobs_ * kChunksPerJob - 1) / (jobs_ * kChunksPerJob);
+        chunk = std::max(chunk, preRoll * kMinChunkPreRolls);
+    }
+    // Keep chunk boundaries on the serial render's block grid.
+    chunk = std::max<int64_t>((chunk + blockSize - 1) / blockSize * blockSize, blockSize);
+
+    numChunks_ = static_cast<int>((totalFrames_ + chunk - 1) / chunk);
+    jobs_      = std::clamp(numChunks_, 1, jobs_);
+
+    std::atomic<int>  nextChunk{ 0 };
+    std::atomic<bool> failed{ false };
+    std::mutex        errorMutex;
+
+    auto fail = [&](const std::string& msg) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!failed.exchange(true)) errorMsg_ = msg;
+    };
+
+    auto worker = [&]() {
+        WavReader          reader;
+        RenderChain        chain;
+        std::vector<float> stream(static_cast<std::size_t>(streamFrames), 0.f);
+        bool               prepared = false;
+
+        while (!failed.load(std::memory_order_relaxed)) {
+            const int c = nextChunk.fetch_add(1);
+            if (c >= numChunks_) return;
+
+            // Prepare lazily so that whichever worker claims chunk 0 (always
+            // the first claim overall) does so on a fresh chain.
+            if (!prepared) {
+                if (!reader.open(inputPath, options.rawSampleRate)) {
+                    fail(reader.errorMessage());
+                    return;
+                }
+                if (!chain.prepare(settings, static_cast<float>(sampleRate), blockSize)) {
+                    fail(chain.errorMessage());
+                    return;
+                }
+                prepared = true;
+            }
+
+            const int64_t begin = static_cast<int64_t>(c) * chunk;
+            const int64_t end   = std::min(begin + chunk, totalFrames_);
+
+            // Pre-roll start, aligned down to the block grid
+            int64_t pos = 0;
+            if (c > 0) {
+                pos = std::max<int64_t>(begin - preRoll, 0);
+                pos = pos / blockSize * blockSize;
+            }
+
+            if (!reader.seek(pos)) {
+                fail("seek failed in '" + inputPath + "'");
+                return;
+            }
+
+            while (pos < end) {
+                const int want = static_cast<int>(std::min<int64_t>(streamFrames, end - pos));
+                const int n    = reader.read(stream.data(), want, options.inputChannel);
+                if (n <= 0) {
+                    fail("unexpected end of input in '" + inputPath + "'");
+                    return;
+                }
+
+                chain.process(stream.data(), n);
+
+                // Pre-roll output is discarded; only [begin, end) is written.
+                if (pos + n > begin) {
+                    const int64_t from = std::max(pos, begin);
+                    const int     skip = static_cast<int>(from - pos);
+                    if (!writer.writeAt(from, stream.data() + skip, n - skip)) {
+                        fail("write failed: " + writer.errorMessage());
+                        return;
+                    }
+                }
+                pos += n;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<std::size_t>(jobs_));
+    for (int j = 0; j < jobs_; ++j)
+        threads.emplace_back(worker);
+    for (auto& t : threads)
+        t.join();
+
+    return !failed.load();
+}
+
+} // namespace hexcaster
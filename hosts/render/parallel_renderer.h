@@ -0,0 +1,80 @@
+#pragma once
+
+#include "render_chain.h"
+
+#include <cstdint>
+#include <string>
+
+namespace hexcaster {
+
+class WavWriter;
+
+/**
+ * ParallelRenderer: splits a DI file into chunks and renders them on a pool
+ * of worker threads, each with its own RenderChain (and so its own NamStage).
+ *
+ * Chunking:
+ *   The file is cut into contiguous chunks. Workers claim chunks in order
+ *   from a shared atomic counter, so faster workers simply take more chunks.
+ *   Each worker streams its chunk through a bounded buffer and writes the
+ *   result at the chunk's position in the output file.
+ *
+ * Warm-up (pre-roll):
+ *   A chain that starts mid-file has the wrong internal state -- empty
+ *   WaveNet receptive field, cold LSTM state, gate and smoothers at their
+ *   reset values. Before each chunk, the worker renders the preceding
+ *   preRollFrames of real input and discards the result, so by the chunk's
+ *   first sample the chain state has converged to what a single-threaded
+ *   render would have. WaveNet state depends only on the last receptive
+ *   field's worth of input, so a pre-roll at least that long makes it exact;
+ *   LSTM, gate and smoother state decays exponentially and matches within
+ *   a small tolerance.
+ *
+ *   preRollFrames is raised to the chain's minimum for the loaded model
+ *   (RenderChain::minPreRollFrames(): the receptive field read from the
+ *   .nam file plus the gate and EQ settling time), so a short --preroll
+ *   can't break the match. preRollFramesUsed() reports the figure.
+ *
+ *   Chunk 0 is always the first chunk claimed, so it runs on a freshly
+ *   prepared chain exactly like a serial render and needs no pre-roll.
+ *
+ * With jobs == 1 the whole file is a single chunk: identical to a serial
+ * streaming render.
+ */
+class ParallelRenderer {
+public:
+    struct Options {
+        int          jobs          = 1;
+        int64_t      chunkFrames   = 0;      // 0 = choose from file length and job count
+        int64_t      preRollFrames = 12000;  // 250 ms at 48 kHz; raised to the chain's minimum
+        int          blockSize     = 128;
+        int          inputChannel  = 0;
+        unsigned int rawSampleRate = 48000;
+    };
+
+    /**
+     * Render inputPath into writer (already opened by the caller).
+     * Blocks until every chunk is written. Not RT-safe.
+     * Returns false on the first worker failure; errorMessage() has details.
+     */
+    bool render(const std::string&           inputPath,
+                WavWriter&                   writer,
+                const RenderChain::Settings& settings,
+                const Options&               options);
+
+    int     chunksRendered() const { return numChunks_; }
+    int64_t framesRendered() const { return totalFrames_; }
+    int     jobsUsed()       const { return jobs_; }
+    int64_t preRollFramesUsed() const { return preRoll_; }
+
+    const std::string& errorMessage() const { return errorMsg_; }
+
+private:
+    int         numChunks_   = 0;
+    int64_t     totalFrames_ = 0;
+    int         jobs_        = 0;
+    int64_t     preRoll_     = 0;
+    std::string errorMsg_;
+};
+
+} // namespace hexcaster
@@ -0,0 +1,94 @@
+#include "render_chain.h"
+#include "hexcaster/nam_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace hexcaster {
+
+// Warm-up for state that only decays instead of filling a finite window:
+// an LSTM/GRU's hidden state (many time constants for NAM-sized nets) and
+// the post-NAM EQ's ringing (Q 3 at 300 Hz is down 60 dB in ~22 ms).
+static constexpr double kRecurrentSettleMs = 200.0;
+static constexpr double kEqSettleMs        = 25.0;
+
+bool RenderChain::prepare(const Settings& settings, float sampleRate, int blockSize)
+{
+    blockSize_ = blockSize;
+
+    noiseGate_.setThresholdDb(settings.gateThresholdDb);
+    inputGain_.setGainDb(settings.gainDb);
+    applyTone(tone_, settings);
+    eq_.setGainDb (settings.eqGainDb);
+    eq_.setSweepHz(settings.eqSweepHz);
+    eq_.setQ      (settings.eqQ);
+    masterVolume_.setGainDb(settings.masterVolumeDb);
+
+    pipeline_.prepare(sampleRate, blockSize);
+
+    if (!nam_.loadModel(settings.modelPath)) {
+        errorMsg_ = "failed to load model '" + settings.modelPath + "'";
+        return false;
+    }
+
+    // Warm-up block: triggers the pending model swap before real audio
+    std::vector<float> warmup(static_cast<std::size_t>(blockSize), 0.f);
+    pipeline_.process(warmup.data(), blockSize);
+
+    return true;
+}
+
+int64_t RenderChain::minPreRollFrames(const Settings& settings, float sampleRate)
+{
+    // The gate's timing as prepare() leaves it: threshold from the
+    // settings, everything else at the stage defaults. Likewise the tone
+    // bands.
+    NoiseGate gate;
+    gate.setThresholdDb(settings.gateThresholdDb);
+    ToneEQ tone;
+    applyTone(tone, settings);
+
+    // The stages settle in chain order: the gate, then the model's receptive
+    // field of gated input, then the EQs' ringing behind it. The gate's
+    // state reaches back over its lookahead and hold, an envelope decay
+    // from full scale to the threshold (release / 3 time constant), and an
+    // opening plus a closing ramp, each ln(1000) time constants to the
+    // 0.001 end points. A tone band's poles decay at w0 / 2Q, so it rings
+    // down 60 dB in ln(1000) * 2Q / w0; the lowest corner sets the figure.
+    const int    field      = NamModel::receptiveField(settings.modelPath);
+    const double msToFrame  = 0.001 * sampleRate;
+    const double ramp       = std::log(1000.0);
+    const double envDecay   = -gate.getThresholdDb() / 20.0 * std::log(10.0);
+    const double gateFrames = (gate.getLookaheadMs() + gate.getHoldMs()
+                               + ramp * (gate.getAttackMs() + gate.getReleaseMs())
+                               + gate.getReleaseMs() / 3.0 * envDecay) * msToFrame;
+    const double model      = field > 0 ? field : kRecurrentSettleMs * msToFrame;
+    double       toneFrames = 0.0;
+    for (int k = 0; k < ParametricEQ::kMaxBands; ++k) {
+        const ParametricEQ::Band b = tone.getBand(k);
+        if (b.type == BiquadType::Off) continue;
+        toneFrames = std::max(toneFrames, ramp * 2.0 * b.q * sampleRate / (2.0 * M_PI * b.freqHz));
+    }
+    return static_cast<int64_t>(std::ceil(gateFrames + model + toneFrames + kEqSettleMs * msToFrame));
+}
+
+void RenderChain::applyTone(ToneEQ& tone, const Settings& settings)
+{
+    tone.setLowCutHz (settings.eqLowCutHz);
+    tone.setBassDb   (settings.eqBassDb);
+    tone.setBassHz   (settings.eqBassHz);
+    tone.setTrebleDb (settings.eqTrebleDb);
+    tone.setTrebleHz (settings.eqTrebleHz);
+    tone.setHighCutHz(settings.eqHighCutHz);
+}
+
+void RenderChain::process(float* buffer, int numSamples)
+{
+    for (int offset = 0; offset < numSamples; offset += blockSize_) {
+        const int n = std::min(blockSize_, numSamples - offset);
+        pipeline_.process(buffer + offset, n);
+    }
+}
+
+} // namespace hexcaster
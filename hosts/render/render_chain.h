@@ -0,0 +1,100 @@
+#pragma once
+
+#include "hexcaster/static_pipeline.h"
+#include "hexcaster/gain_stage.h"
+#include "hexcaster/nam_stage.h"
+#include "hexcaster/noise_gate.h"
+#include "hexcaster/eq.h"
+
+#include <cstdint>
+#include <string>
+
+namespace hexcaster {
+
+/**
+ * RenderChain: the standalone host's signal chain, without an audio device.
+ *
+ * Owns the same stages in the same order as hosts/standalone/main.cpp:
+ *   stage 0: noise gate
+ *   stage 1: input gain
+ *   stage 2: amp model (NAM)
+ *   stage 3: tone EQ (low cut, bass, treble, high cut)
+ *   stage 4: mid sweep EQ
+ *   stage 5: master volume
+ *
+ * The chain is fixed, so it runs as a StaticPipeline: no virtual dispatch,
+ * and both gain stages are fused into the stage before them.
+ *
+ * Parameters are fixed for the whole render (no MIDI, no automation).
+ * One RenderChain is one independent set of DSP state; render workers that
+ * run in parallel each need their own instance.
+ */
+class RenderChain {
+public:
+    struct Settings {
+        std::string modelPath;
+        float       gainDb          = 0.f;
+        float       gateThresholdDb = -60.f;
+        float       eqGainDb        = 0.f;
+        float       eqSweepHz       = 1000.f;
+        float       eqQ             = 0.8f;
+        float       eqLowCutHz      = 20.f;
+        float       eqBassDb        = 0.f;
+        float       eqBassHz        = 120.f;
+        float       eqTrebleDb      = 0.f;
+        float       eqTrebleHz      = 3000.f;
+        float       eqHighCutHz     = 20000.f;
+        float       masterVolumeDb  = 0.f;
+    };
+
+    RenderChain() = default;
+
+    RenderChain(const RenderChain&)            = delete;
+    RenderChain& operator=(const RenderChain&) = delete;
+
+    /**
+     * Apply settings, prepare every stage and load the model. Not RT-safe.
+     * Runs one silent warm-up block so the model is swapped in before the
+     * first real block, exactly as the standalone host does.
+     * Returns false on failure; errorMessage() contains details.
+     */
+    bool prepare(const Settings& settings, float sampleRate, int blockSize);
+
+    /**
+     * Process samples in-place. numSamples may exceed the block size passed
+     * to prepare(); the buffer is fed to the pipeline in block-sized slices.
+     */
+    void process(float* buffer, int numSamples);
+
+    int blockSize() const { return blockSize_; }
+
+    /**
+     * Shortest warm-up after which a chain with these settings, started
+     * mid-file, matches a serial render (exactly for a WaveNet/ConvNet,
+     * within a tolerance for recurrent models). Reads only the .nam file's
+     * header fields, so no chain or model load is needed; see
+     * ParallelRenderer. Not RT-safe (file I/O).
+     */
+    static int64_t minPreRollFrames(const Settings& settings, float sampleRate);
+
+    const std::string& errorMessage() const { return errorMsg_; }
+
+private:
+    NoiseGate  noiseGate_;
+    GainStage  inputGain_;
+    NamStage   nam_;
+    ToneEQ     tone_;
+    MidSweepEQ eq_;
+    GainStage  masterVolume_;
+
+    StaticPipeline<NoiseGate, GainStage, NamStage, ToneEQ, MidSweepEQ, GainStage> pipeline_{
+        noiseGate_, inputGain_, nam_, tone_, eq_, masterVolume_
+    };
+
+    static void applyTone(ToneEQ& tone, const Settings& settings);
+
+    int         blockSize_ = 0;
+    std::string errorMsg_;
+};
+
+} // namespace hexcaster
@@ -0,0 +1,371 @@
+#include "wav_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace hexcaster {
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static constexpr uint16_t kFormatPcm        = 0x0001;
+static constexpr uint16_t kFormatFloat      = 0x0003;
+static constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+static bool hasRawExtension(const std::string& path)
+{
+    auto endsWith = [&](const char* ext) {
+        const std::size_t n = std::strlen(ext);
+        return path.size() >= n && path.compare(path.size() - n, n, ext) == 0;
+    };
+    return endsWith(".f32") || endsWith(".raw");
+}
+
+static uint16_t readU16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+static uint32_t readU32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void putU16(uint8_t* p, uint16_t v) { p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; }
+static void putU32(uint8_t* p, uint32_t v)
+{
+    p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+
+// ---------------------------------------------------------------------------
+// WavReader
+// ---------------------------------------------------------------------------
+
+WavReader::~WavReader()
+{
+    close();
+}
+
+bool WavReader::open(const std::string& path, unsigned int rawSampleRate)
+{
+    close();
+
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        errorMsg_ = "Failed to open input file '" + path + "'";
+        return false;
+    }
+
+    if (hasRawExtension(path)) {
+        fseeko(file_, 0, SEEK_END);
+        const off_t bytes = ftello(file_);
+        fseeko(file_, 0, SEEK_SET);
+
+        encoding_      = Encoding::Float32;
+        sampleRate_    = rawSampleRate;
+        channels_      = 1;
+        bitsPerSample_ = 32;
+        frameBytes_    = 4;
+        dataOffset_    = 0;
+        totalFrames_   = bytes / frameBytes_;
+        framesLeft_    = totalFrames_;
+        return true;
+    }
+
+    if (!parseHeader()) {
+        errorMsg_ = "'" + path + "': " + errorMsg_;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool WavReader::parseHeader()
+{
+    uint8_t riff[12];
+    if (std::fread(riff, 1, sizeof(riff), file_) != sizeof(riff) ||
+        std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        errorMsg_ = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    bool haveFmt = false;
+    uint16_t formatTag = 0;
+
+    // Walk chunks until "data"; skip anything we don't understand (LIST, fact, ...)
+    for (;;) {
+        uint8_t hdr[8];
+        if (std::fread(hdr, 1, sizeof(hdr), file_) != sizeof(hdr)) {
+            errorMsg_ = "no data chunk";
+            return false;
+        }
+        const uint32_t size = readU32(hdr + 4);
+
+        if (std::memcmp(hdr, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {};
+            const uint32_t n = std::min<uint32_t>(size, sizeof(fmt));
+            if (size < 16 || std::fread(fmt, 1, n, file_) != n) {
+                errorMsg_ = "truncated fmt chunk";
+                return false;
+            }
+            formatTag      = readU16(fmt + 0);
+            channels_      = readU16(fmt + 2);
+            sampleRate_    = readU32(fmt + 4);
+            bitsPerSample_ = readU16(fmt + 14);
+            if (formatTag == kFormatExtensible && n >= 26) {
+                // First two bytes of the SubFormat GUID carry the real format tag
+                formatTag = readU16(fmt + 24);
+            }
+            // Chunks are word-aligned
+            fseeko(file_, static_cast<off_t>(size - n + (size & 1)), SEEK_CUR);
+            haveFmt = true;
+        } else if (std::memcmp(hdr, "data", 4) == 0) {
+            if (!haveFmt) {
+                errorMsg_ = "data chunk before fmt chunk";
+                return false;
+            }
+            dataOffset_ = ftello(file_);
+            frameBytes_ = static_cast<int>(channels_ * (bitsPerSample_ / 8));
+            if (frameBytes_ <= 0) {
+                errorMsg_ = "invalid frame size";
+                return false;
+            }
+            totalFrames_ = static_cast<int64_t>(size) / frameBytes_;
+            framesLeft_  = totalFrames_;
+            break;
+        } else {
+            fseeko(file_, static_cast<off_t>(size) + (size & 1), SEEK_CUR);
+        }
+    }
+
+    if (formatTag == kFormatPcm && bitsPerSample_ == 16) {
+        encoding_ = Encoding::Pcm16;
+    } else if (formatTag == kFormatPcm && bitsPerSample_ == 24) {
+        encoding_ = Encoding::Pcm24;
+    } else if (formatTag == kFormatPcm && bitsPerSample_ == 32) {
+        encoding_ = Encoding::Pcm32;
+    } else if (formatTag == kFormatFloat && bitsPerSample_ == 32) {
+        encoding_ = Encoding::Float32;
+    } else {
+        errorMsg_ = "unsupported sample format (tag " + std::to_string(formatTag) +
+                    ", " + std::to_string(bitsPerSample_) + " bits)";
+        return false;
+    }
+    return true;
+}
+
+void WavReader::close()
+{
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool WavReader::seek(int64_t frame)
+{
+    if (!file_ || frame < 0 || frame > totalFrames_) return false;
+    if (fseeko(file_, dataOffset_ + static_cast<off_t>(frame) * frameBytes_, SEEK_SET) != 0)
+        return false;
+    framesLeft_ = totalFrames_ - frame;
+    return true;
+}
+
+int WavReader::read(float* mono, int maxFrames, int channel)
+{
+    if (!file_ || maxFrames <= 0) return 0;
+
+    const int want = static_cast<int>(std::min<int64_t>(maxFrames, framesLeft_));
+    if (want <= 0) return 0;
+
+    raw_.resize(static_cast<std::size_t>(want) * frameBytes_);
+    const int got = static_cast<int>(std::fread(raw_.data(), frameBytes_, want, file_));
+    framesLeft_ -= got;
+
+    const int ch     = std::clamp(channel, 0, static_cast<int>(channels_) - 1);
+    const int stride = frameBytes_;
+    const uint8_t* src = raw_.data() + ch * (bitsPerSample_ / 8);
+
+    switch (encoding_) {
+        case Encoding::Pcm16: {
+            constexpr float kScale = 1.f / 32768.f;
+            for (int i = 0; i < got; ++i, src += stride)
+                mono[i] = static_cast<float>(static_cast<int16_t>(readU16(src))) * kScale;
+            break;
+        }
+        case Encoding::Pcm24: {
+            constexpr float kScale = 1.f / 8388608.f;
+            for (int i = 0; i < got; ++i, src += stride) {
+                // Place the 24-bit sample in the top of an int32 to sign-extend
+                const int32_t v = static_cast<int32_t>(
+                    (static_cast<uint32_t>(src[0]) << 8) |
+                    (static_cast<uint32_t>(src[1]) << 16) |
+                    (static_cast<uint32_t>(src[2]) << 24)) >> 8;
+                mono[i] = static_cast<float>(v) * kScale;
+            }
+            break;
+        }
+        case Encoding::Pcm32: {
+            constexpr float kScale = 1.f / 2147483648.f;
+            for (int i = 0; i < got; ++i, src += stride)
+                mono[i] = static_cast<float>(static_cast<int32_t>(readU32(src))) * kScale;
+            break;
+        }
+        case Encoding::Float32: {
+            for (int i = 0; i < got; ++i, src += stride)
+                std::memcpy(&mono[i], src, sizeof(float));
+            break;
+        }
+    }
+
+    return got;
+}
+
+// ---------------------------------------------------------------------------
+// WavWriter
+// ---------------------------------------------------------------------------
+
+WavWriter::~WavWriter()
+{
+    close();
+}
+
+bool WavWriter::open(const std::string& path, unsigned int sampleRate, Format format)
+{
+    close();
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        errorMsg_ = "Failed to create output file '" + path + "'";
+        return false;
+    }
+
+    raw_           = hasRawExtension(path);
+    format_        = raw_ ? Format::Float32 : format;
+    sampleRate_    = sampleRate;
+    framesWritten_ = 0;
+    cursor_        = 0;
+
+    if (!raw_ && !writeHeader()) {
+        errorMsg_ = "Failed to write WAV header to '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool WavWriter::writeHeader()
+{
+    const uint16_t blockAlgn = static_cast<uint16_t>(bytesPerFrame());
+    const uint16_t bits      = blockAlgn * 8;
+    const uint64_t dataBytes = static_cast<uint64_t>(framesWritten_) * blockAlgn;
+
+    // RIFF sizes are 32-bit; clamp rather than wrap for >4 GB output.
+    const uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(dataBytes, 0xFFFFFFFFu - 36));
+
+    uint8_t h[44];
+    std::memcpy(h + 0,  "RIFF", 4);
+    putU32     (h + 4,  36 + dataSize);
+    std::memcpy(h + 8,  "WAVE", 4);
+    std::memcpy(h + 12, "fmt ", 4);
+    putU32     (h + 16, 16);
+    putU16     (h + 20, format_ == Format::Float32 ? kFormatFloat : kFormatPcm);
+    putU16     (h + 22, 1);
+    putU32     (h + 24, sampleRate_);
+    putU32     (h + 28, sampleRate_ * blockAlgn);
+    putU16     (h + 32, blockAlgn);
+    putU16     (h + 34, bits);
+    std::memcpy(h + 36, "data", 4);
+    putU32     (h + 40, dataSize);
+
+    return fseeko(file_, 0, SEEK_SET) == 0 &&
+           std::fwrite(h, 1, sizeof(h), file_) == sizeof(h);
+}
+
+int WavWriter::bytesPerFrame() const
+{
+    switch (format_) {
+        case Format::Float32: return 4;
+        case Format::Pcm16:   return 2;
+        case Format::Pcm24:   return 3;
+    }
+    return 4;
+}
+
+bool WavWriter::write(const float* mono, int frames)
+{
+    if (!writeAt(cursor_, mono, frames)) return false;
+    cursor_ += frames;
+    return true;
+}
+
+bool WavWriter::writeAt(int64_t frame, const float* mono, int frames)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!file_) return false;
+    if (frames <= 0) return true;
+
+    const off_t headerBytes = raw_ ? 0 : 44;
+    if (fseeko(file_, headerBytes + static_cast<off_t>(frame) * bytesPerFrame(), SEEK_SET) != 0) {
+        errorMsg_ = "Seek failed in output file";
+        return false;
+    }
+    if (!writeFrames(mono, frames)) return false;
+
+    framesWritten_ = std::max(framesWritten_, frame + frames);
+    return true;
+}
+
+bool WavWriter::writeFrames(const float* mono, int frames)
+{
+    std::size_t written = 0;
+
+    switch (format_) {
+        case Format::Float32:
+            written = std::fwrite(mono, sizeof(float), frames, file_);
+            break;
+
+        case Format::Pcm16: {
+            encoded_.resize(static_cast<std::size_t>(frames) * 2);
+            uint8_t* dst = encoded_.data();
+            for (int i = 0; i < frames; ++i, dst += 2) {
+                const float s = std::clamp(mono[i] * 32768.f, -32768.f, 32767.f);
+                putU16(dst, static_cast<uint16_t>(static_cast<int16_t>(std::lround(s))));
+            }
+            written = std::fwrite(encoded_.data(), 2, frames, file_);
+            break;
+        }
+
+        case Format::Pcm24: {
+            encoded_.resize(static_cast<std::size_t>(frames) * 3);
+            uint8_t* dst = encoded_.data();
+            for (int i = 0; i < frames; ++i, dst += 3) {
+                const int32_t v = static_cast<int32_t>(
+                    std::lround(std::clamp(mono[i] * 8388608.f, -8388608.f, 8388607.f)));
+                dst[0] = v & 0xFF; dst[1] = (v >> 8) & 0xFF; dst[2] = (v >> 16) & 0xFF;
+            }
+            written = std::fwrite(encoded_.data(), 3, frames, file_);
+            break;
+        }
+    }
+
+    if (written != static_cast<std::size_t>(frames)) {
+        errorMsg_ = "Short write to output file";
+        return false;
+    }
+    return true;
+}
+
+bool WavWriter::close()
+{
+    if (!file_) return true;
+
+    bool ok = true;
+    if (!raw_) ok = writeHeader();
+    ok = (std::fclose(file_) == 0) && ok;
+    file_ = nullptr;
+
+    if (!ok) errorMsg_ = "Failed to finalise output file";
+    return ok;
+}
+
+} // namespace hexcaster
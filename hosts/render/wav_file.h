@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+// Offsets are off_t: RIFF sizes reach 4 GB, past what a 32-bit long can
+// seek. Targets including this header build with _FILE_OFFSET_BITS=64 so
+// off_t is 64-bit on 32-bit Raspberry Pi OS too (and every translation unit
+// agrees on WavReader's layout).
+static_assert(sizeof(off_t) >= 8, "build with -D_FILE_OFFSET_BITS=64");
+
+namespace hexcaster {
+
+/**
+ * WavReader: streaming reader for WAV and headerless float32 files.
+ *
+ * Supported inputs:
+ *   - RIFF/WAVE, PCM 16/24/32-bit integer or IEEE float 32-bit,
+ *     including WAVE_FORMAT_EXTENSIBLE with a PCM/float subformat.
+ *   - Raw little-endian float32 (".f32" / ".raw"): mono, sample rate
+ *     supplied by the caller since there is no header to read it from.
+ *
+ * Frames are read in caller-sized chunks and a single channel is extracted
+ * to float. Nothing beyond one chunk of raw bytes is ever held in memory,
+ * so arbitrarily long takes stream through a bounded buffer.
+ *
+ * Not real-time safe (file I/O). Intended for offline rendering only.
+ */
+class WavReader {
+public:
+    WavReader() = default;
+    ~WavReader();
+
+    WavReader(const WavReader&)            = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    /**
+     * Open a file for reading. Files ending in .f32 or .raw are treated as
+     * headerless mono float32 at rawSampleRate.
+     * Returns false on failure; errorMessage() contains details.
+     */
+    bool open(const std::string& path, unsigned int rawSampleRate = 48000);
+
+    void close();
+
+    /**
+     * Read up to maxFrames frames, extracting `channel` to float in [-1, 1].
+     * Returns the number of frames read (0 at end of file).
+     */
+    int read(float* mono, int maxFrames, int channel);
+
+    /**
+     * Reposition the read cursor to an absolute frame index.
+     * Returns false if the frame is out of range or the seek fails.
+     */
+    bool seek(int64_t frame);
+
+    unsigned int sampleRate()  const { return sampleRate_; }
+    unsigned int channels()    const { return channels_; }
+    unsigned int bitsPerSample() const { return bitsPerSample_; }
+    int64_t      totalFrames() const { return totalFrames_; }
+
+    const std::string& errorMessage() const { return errorMsg_; }
+
+private:
+    enum class Encoding { Pcm16, Pcm24, Pcm32, Float32 };
+
+    bool parseHeader();
+
+    std::FILE*   file_          = nullptr;
+    Encoding     encoding_      = Encoding::Float32;
+    unsigned int sampleRate_    = 0;
+    unsigned int channels_      = 0;
+    unsigned int bitsPerSample_ = 0;
+    int          frameBytes_    = 0;
+    off_t        dataOffset_    = 0;
+    int64_t      totalFrames_   = 0;
+    int64_t      framesLeft_    = 0;
+
+    // Raw chunk buffer -- grows to the largest read() request, then reused
+    std::vector<uint8_t> raw_;
+
+    std::string errorMsg_;
+};
+
+/**
+ * WavWriter: streaming mono WAV / raw float32 writer.
+ *
+ * The RIFF header is written with placeholder sizes on open() and patched
+ * on close(), so the writer never needs to know the total length up front.
+ * Output is mono. Integer formats use WavReader's full scale (2^(bits-1)),
+ * rounded to nearest and clipped, so PCM read and re-written at unity gain
+ * comes back bit-exact.
+ *
+ * write() appends; writeAt() places frames at an absolute position and may
+ * be called concurrently from several render workers (serialised
+ * internally), which lets chunks finish out of order.
+ *
+ * Not real-time safe (file I/O). Intended for offline rendering only.
+ */
+class WavWriter {
+public:
+    enum class Format { Float32, Pcm16, Pcm24 };
+
+    WavWriter() = default;
+    ~WavWriter();
+
+    WavWriter(const WavWriter&)            = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    /**
+     * Create (truncate) the output file. Files ending in .f32 or .raw are
+     * written headerless as float32 regardless of `format`.
+     */
+    bool open(const std::string& path, unsigned int sampleRate, Format format);
+
+    /**
+     * Append frames. Returns false on a write error.
+     */
+    bool write(const float* mono, int frames);
+
+    /**
+     * Write frames starting at an absolute frame index. Thread-safe.
+     * Gaps left between regions read back as zeros once the file is closed.
+     */
+    bool writeAt(int64_t frame, const float* mono, int frames);
+
+    /**
+     * Patch the header sizes and close the file. Returns false if the
+     * final header update fails. Called by the destructor if needed.
+     */
+    bool close();
+
+    int64_t framesWritten() const { return framesWritten_; }
+
+    const std::string& errorMessage() const { return errorMsg_; }
+
+private:
+    bool writeHeader();
+    bool writeFrames(const float* mono, int frames);
+    int  bytesPerFrame() const;
+
+    std::FILE*   file_          = nullptr;
+    Format       format_        = Format::Float32;
+    bool         raw_           = false;
+    unsigned int sampleRate_    = 0;
+    int64_t      framesWritten_ = 0;   // end of the furthest region written
+    int64_t      cursor_        = 0;   // append position for write()
+
+    // Conversion buffer for integer formats -- grows to the largest write()
+    std::vector<uint8_t> encoded_;
+
+    // Serialises seek + write pairs from concurrent writeAt() callers
+    std::mutex mutex_;
+
+    std::string errorMsg_;
+};
+
+} // namespace hexcaster
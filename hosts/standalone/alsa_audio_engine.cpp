@@ -1,12 +1,16 @@
 #include "alsa_audio_engine.h"
 
+#include "hexcaster/rt_sanitizer.h"
+
 #include <alsa/asoundlib.h>
 #include <pthread.h>
 #include <sched.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstdio>
-#include <cstring>
+#include <string>
 
 namespace hexcaster {
 
@@ -14,14 +18,14 @@ namespace hexcaster {
 // Helpers
 // ---------------------------------------------------------------------------
 
-int AlsaAudioEngine::bytesPerSample(SampleFormat fmt)
+// Playback channels needed to reach the highest output in the mask.
+static int channelMaskSpan(int channelMask)
 {
-    switch (fmt) {
-        case SampleFormat::Float32: return 4;
-        case SampleFormat::Int32:   return 4;
-        case SampleFormat::Int16:   return 2;
+    int span = 0;
+    for (int c = 0; c < 32; ++c) {
+        if (channelMask & (1 << c)) span = c + 1;
     }
-    return 2;
+    return span;
 }
 
 // ---------------------------------------------------------------------------
@@ -40,23 +44,78 @@ AlsaAudioEngine::~AlsaAudioEngine()
 bool AlsaAudioEngine::open(const Config& config)
 {
     config_ = config;
-    captureChannels_  = 2;
-    playbackChannels_ = 2;
 
-    if (!openHandle(config_.inputDevice,  true,  captureHandle_,  captureChannels_,  captureFmt_))
+    if (config_.numChannels < 1 || config_.numChannels > AudioBlock::kMaxChannels) {
+        errorMsg_ = "numChannels must be 1.." + std::to_string(AudioBlock::kMaxChannels);
+        return false;
+    }
+
+    const int inputSpan = config_.inputChannel + config_.numChannels;
+    const int outputSpan = channelMaskSpan(config_.outputChannels);
+    captureChannels_  = std::max(2u, static_cast<unsigned int>(inputSpan));
+    playbackChannels_ = std::max(2u, static_cast<unsigned int>(outputSpan));
+
+    if (!openHandle(config_.inputDevice, true, captureHandle_, captureChannels_,
+                    captureFmt_, captureAccess_))
         return false;
 
-    if (!openHandle(config_.outputDevice, false, playbackHandle_, playbackChannels_, playbackFmt_))
+    if (static_cast<int>(captureChannels_) < inputSpan) {
+        errorMsg_ = "Capture device '" + config_.inputDevice + "' has "
+                  + std::to_string(captureChannels_) + " channel(s); input needs "
+                  + std::to_string(inputSpan);
         return false;
+    }
+
+    if (!openHandle(config_.outputDevice, false, playbackHandle_, playbackChannels_,
+                    playbackFmt_, playbackAccess_))
+        return false;
+
+    // Outputs past stereo must exist; L/R on a mono device keeps playing L.
+    if (outputSpan > 2 && static_cast<int>(playbackChannels_) < outputSpan) {
+        errorMsg_ = "Playback device '" + config_.outputDevice + "' has "
+                  + std::to_string(playbackChannels_) + " channel(s); output needs "
+                  + std::to_string(outputSpan);
+        return false;
+    }
 
-    // Pre-allocate raw interleaved buffers using actual negotiated format sizes
+    // Pre-allocate raw interleaved buffers using actual negotiated format
+    // sizes -- read/write access only; mmap converts in the device ring.
     const int frames = static_cast<int>(actualFrames_);
-    captureRaw_.assign(
-        static_cast<std::size_t>(frames) * captureChannels_ * bytesPerSample(captureFmt_), 0);
-    playbackRaw_.assign(
-        static_cast<std::size_t>(frames) * playbackChannels_ * bytesPerSample(playbackFmt_), 0);
-    silenceRaw_.assign(playbackRaw_.size(), 0);
-    monoBuffer_.assign(static_cast<std::size_t>(frames), 0.f);
+    auto setUpRaw = [frames](Access access, SampleFormat fmt, unsigned int channels,
+                             std::vector<uint8_t>& raw, std::vector<RawChannel>& layout) {
+        const int bytes = bytesPerSample(fmt);
+        layout.assign(channels, RawChannel{});
+        if (access != Access::ReadWrite) {
+            raw.clear();
+            return;
+        }
+        raw.assign(static_cast<std::size_t>(frames) * channels * bytes, 0);
+        for (unsigned int c = 0; c < channels; ++c) {
+            layout[c].data   = raw.data() + static_cast<std::size_t>(c) * bytes;
+            layout[c].stride = static_cast<int>(channels);
+        }
+    };
+    setUpRaw(captureAccess_,  captureFmt_,  captureChannels_,  captureRaw_,  captureLayout_);
+    setUpRaw(playbackAccess_, playbackFmt_, playbackChannels_, playbackRaw_, playbackLayout_);
+
+    // Kernels for the stride every period will use: 1 non-interleaved, the
+    // channel count otherwise (mapAreas() may still report another).
+    auto strideOf = [](Access access, unsigned int channels) {
+        return access == Access::MmapNonInterleaved ? 1 : static_cast<int>(channels);
+    };
+    captureConverter_.setUp(captureFmt_, strideOf(captureAccess_, captureChannels_));
+    playbackConverters_.assign(playbackChannels_, PlaybackConverter{});
+    for (unsigned int c = 0; c < playbackChannels_; ++c) {
+        playbackConverters_[c].setUp(playbackFmt_, strideOf(playbackAccess_, playbackChannels_),
+                                     config_.dither, c + 1);
+    }
+    channelBuffer_.assign(static_cast<std::size_t>(frames) * config_.numChannels, 0.f);
+    block_             = AudioBlock{};
+    block_.numChannels = config_.numChannels;
+    block_.numSamples  = frames;
+    for (int c = 0; c < config_.numChannels; ++c) {
+        block_.channels[c] = channelBuffer_.data() + static_cast<std::size_t>(c) * frames;
+    }
 
     return true;
 }
@@ -70,7 +129,7 @@ bool AlsaAudioEngine::open(const Config& config)
 
 bool AlsaAudioEngine::openHandle(const std::string& device, bool isCapture,
                                    snd_pcm_t*& handle, unsigned int& channels,
-                                   SampleFormat& fmt)
+                                   SampleFormat& fmt, Access& access)
 {
     const snd_pcm_stream_t stream = isCapture
         ? SND_PCM_STREAM_CAPTURE
@@ -85,11 +144,23 @@ bool AlsaAudioEngine::openHandle(const std::string& device, bool isCapture,
     }
 
     // Format probe list -- S16_LE first as it has universal USB support.
+    // The 24-bit formats come last: interfaces that offer nothing else
+    // would otherwise need plughw and its conversion copy.
     // The ProcessCallback always receives float; conversion happens at the edge.
     const struct { snd_pcm_format_t alsa; SampleFormat our; const char* name; } formats[] = {
-        { SND_PCM_FORMAT_S16_LE,   SampleFormat::Int16,   "S16_LE"   },
-        { SND_PCM_FORMAT_S32_LE,   SampleFormat::Int32,   "S32_LE"   },
-        { SND_PCM_FORMAT_FLOAT_LE, SampleFormat::Float32, "FLOAT_LE" },
+        { SND_PCM_FORMAT_S16_LE,   SampleFormat::Int16,       "S16_LE"   },
+        { SND_PCM_FORMAT_S32_LE,   SampleFormat::Int32,       "S32_LE"   },
+        { SND_PCM_FORMAT_FLOAT_LE, SampleFormat::Float32,     "FLOAT_LE" },
+        { SND_PCM_FORMAT_S24_LE,   SampleFormat::Int24,       "S24_LE"   },
+        { SND_PCM_FORMAT_S24_3LE,  SampleFormat::Int24Packed, "S24_3LE"  },
+    };
+
+    // Access probe list, per format -- mmap first: the conversion then works
+    // in the device ring itself instead of on a readi/writei copy.
+    const struct { snd_pcm_access_t alsa; Access our; const char* name; } accessModes[] = {
+        { SND_PCM_ACCESS_MMAP_INTERLEAVED,    Access::MmapInterleaved,    "mmap"    },
+        { SND_PCM_ACCESS_MMAP_NONINTERLEAVED, Access::MmapNonInterleaved, "mmap-ni" },
+        { SND_PCM_ACCESS_RW_INTERLEAVED,      Access::ReadWrite,          "rw"      },
     };
 
     snd_pcm_hw_params_t* hw = nullptr;
@@ -97,58 +168,67 @@ bool AlsaAudioEngine::openHandle(const std::string& device, bool isCapture,
     bool configured = false;
 
     for (auto& f : formats) {
-        // Start fresh each attempt
-        snd_pcm_hw_params_any(handle, hw);
+        for (auto& a : accessModes) {
+            if (a.our != Access::ReadWrite && !config_.mmapAccess)
+                continue;
 
-        if (snd_pcm_hw_params_set_access(handle, hw, SND_PCM_ACCESS_RW_INTERLEAVED) < 0)
-            continue;
-        if (snd_pcm_hw_params_set_format(handle, hw, f.alsa) < 0)
-            continue;
+            // Start fresh each attempt
+            snd_pcm_hw_params_any(handle, hw);
 
-        // Rate
-        unsigned int rate = config_.sampleRate;
-        if (snd_pcm_hw_params_set_rate_near(handle, hw, &rate, nullptr) < 0)
-            continue;
-        actualRate_ = rate;
-
-        // Channels -- try requested count, fall back to min/max
-        if (snd_pcm_hw_params_set_channels(handle, hw, channels) < 0) {
-            unsigned int minCh = 1, maxCh = 2;
-            snd_pcm_hw_params_get_channels_min(hw, &minCh);
-            snd_pcm_hw_params_get_channels_max(hw, &maxCh);
-            channels = isCapture ? (unsigned int)(config_.inputChannel + 1) : 2u;
-            channels = std::max(channels, minCh);
-            channels = std::min(channels, maxCh);
-            if (snd_pcm_hw_params_set_channels(handle, hw, channels) < 0)
+            if (snd_pcm_hw_params_set_access(handle, hw, a.alsa) < 0)
+                continue;
+            if (snd_pcm_hw_params_set_format(handle, hw, f.alsa) < 0)
                 continue;
-        }
 
-        // Period size
-        snd_pcm_uframes_t periodSize = config_.bufferFrames;
-        if (snd_pcm_hw_params_set_period_size_near(handle, hw, &periodSize, nullptr) < 0)
-            continue;
+            // Rate
+            unsigned int rate = config_.sampleRate;
+            if (snd_pcm_hw_params_set_rate_near(handle, hw, &rate, nullptr) < 0)
+                continue;
+            actualRate_ = rate;
+
+            // Channels -- try requested count, fall back to min/max
+            if (snd_pcm_hw_params_set_channels(handle, hw, channels) < 0) {
+                unsigned int minCh = 1, maxCh = 2;
+                snd_pcm_hw_params_get_channels_min(hw, &minCh);
+                snd_pcm_hw_params_get_channels_max(hw, &maxCh);
+                channels = isCapture
+                    ? (unsigned int)(config_.inputChannel + config_.numChannels)
+                    : (unsigned int)std::max(2, channelMaskSpan(config_.outputChannels));
+                channels = std::max(channels, minCh);
+                channels = std::min(channels, maxCh);
+                if (snd_pcm_hw_params_set_channels(handle, hw, channels) < 0)
+                    continue;
+            }
+
+            // Period size
+            snd_pcm_uframes_t periodSize = config_.bufferFrames;
+            if (snd_pcm_hw_params_set_period_size_near(handle, hw, &periodSize, nullptr) < 0)
+                continue;
 
-        // Number of periods (buffer = periods * period_size)
-        unsigned int periods = config_.periods;
-        snd_pcm_hw_params_set_periods_near(handle, hw, &periods, nullptr);
+            // Number of periods (buffer = periods * period_size)
+            unsigned int periods = config_.periods;
+            snd_pcm_hw_params_set_periods_near(handle, hw, &periods, nullptr);
 
-        // Commit
-        err = snd_pcm_hw_params(handle, hw);
-        if (err < 0) {
-            std::fprintf(stderr, "hw_params commit failed for %s with %s: %s\n",
-                         device.c_str(), f.name, snd_strerror(err));
-            continue;
-        }
+            // Commit
+            err = snd_pcm_hw_params(handle, hw);
+            if (err < 0) {
+                std::fprintf(stderr, "hw_params commit failed for %s with %s/%s: %s\n",
+                             device.c_str(), f.name, a.name, snd_strerror(err));
+                continue;
+            }
 
-        fmt = f.our;
-        actualFrames_ = static_cast<unsigned int>(periodSize);
-        configured = true;
+            fmt    = f.our;
+            access = a.our;
+            actualFrames_ = static_cast<unsigned int>(periodSize);
+            configured = true;
 
-        std::fprintf(stderr,
-            "ALSA %s: device=%s format=%s channels=%u rate=%u period=%u\n",
-            isCapture ? "capture " : "playback",
-            device.c_str(), f.name, channels, actualRate_, actualFrames_);
-        break;
+            std::fprintf(stderr,
+                "ALSA %s: device=%s format=%s access=%s channels=%u rate=%u period=%u\n",
+                isCapture ? "capture " : "playback",
+                device.c_str(), f.name, a.name, channels, actualRate_, actualFrames_);
+            break;
+        }
+        if (configured) break;
     }
 
     if (!configured) {
@@ -160,7 +240,8 @@ bool AlsaAudioEngine::openHandle(const std::string& device, bool isCapture,
         return false;
     }
 
-    // SW params: start when the first period is written/read
+    // SW params: start when the first period is written/read (read/write
+    // access; mmap handles are started explicitly, see startMmapStreams())
     snd_pcm_sw_params_t* sw = nullptr;
     snd_pcm_sw_params_alloca(&sw);
     snd_pcm_sw_params_current(handle, sw);
@@ -182,6 +263,11 @@ void AlsaAudioEngine::setCallback(ProcessCallback cb)
     callback_ = std::move(cb);
 }
 
+void AlsaAudioEngine::setBlockCallback(BlockCallback cb)
+{
+    blockCallback_ = std::move(cb);
+}
+
 // ---------------------------------------------------------------------------
 // run()
 // ---------------------------------------------------------------------------
@@ -192,8 +278,10 @@ void AlsaAudioEngine::run()
         errorMsg_ = "run() called before open()";
         return;
     }
-    if (!callback_) {
-        errorMsg_ = "run() called without a process callback";
+    if (!blockCallback_ && (!callback_ || config_.numChannels > 1)) {
+        errorMsg_ = config_.numChannels > 1
+                  ? "run() called without a block callback for a multichannel input"
+                  : "run() called without a process callback";
         return;
     }
 
@@ -216,6 +304,7 @@ void AlsaAudioEngine::run()
 
     // Prime the playback buffer to prevent underrun before the first read
     primePlayback();
+    startMmapStreams();
 
     running_.store(true, std::memory_order_release);
 
@@ -227,9 +316,11 @@ void AlsaAudioEngine::run()
         actualRate_, frames);
 
     while (running_.load(std::memory_order_acquire)) {
+        // One period is the real-time section (HEXCASTER_RT_SANITIZE).
+        const RtScope rtScope;
 
-        // --- Capture ---
-        snd_pcm_sframes_t n = snd_pcm_readi(captureHandle_, captureRaw_.data(), frames);
+        // --- Capture, converted to planar float ---
+        long n = readCapture();
 
         if (n < 0) {
             std::fprintf(stderr, "Capture error: %s -- recovering\n", snd_strerror(static_cast<int>(n)));
@@ -240,19 +331,12 @@ void AlsaAudioEngine::run()
         // Short read -- skip block, don't write garbage to output
         if (n != frames) continue;
 
-        // --- Convert capture -> mono float ---
-        deinterleaveCapture(captureRaw_.data(), monoBuffer_.data(),
-                             frames, captureChannels_, config_.inputChannel);
-
         // --- DSP ---
-        callback_(monoBuffer_.data(), frames);
+        if (blockCallback_) blockCallback_(block_);
+        else                callback_(block_.channels[0], frames);
 
-        // --- Convert mono float -> playback ---
-        interleavePlayback(monoBuffer_.data(), playbackRaw_.data(),
-                            frames, playbackChannels_, config_.outputChannels);
-
-        // --- Playback ---
-        n = snd_pcm_writei(playbackHandle_, playbackRaw_.data(), frames);
+        // --- Playback, converted from planar float ---
+        n = writePlayback(config_.outputChannels);
 
         if (n < 0) {
             std::fprintf(stderr, "Playback error: %s -- recovering\n", snd_strerror(static_cast<int>(n)));
@@ -318,6 +402,7 @@ bool AlsaAudioEngine::recoverBoth()
     }
 
     primePlayback();
+    startMmapStreams();
     return true;
 }
 
@@ -326,82 +411,141 @@ void AlsaAudioEngine::primePlayback()
     // Write `periods` blocks of silence to fill the playback buffer
     // before capture starts, so the output never starves on first block.
     for (unsigned int p = 0; p < config_.periods; ++p) {
-        snd_pcm_writei(playbackHandle_, silenceRaw_.data(),
-                       static_cast<snd_pcm_uframes_t>(actualFrames_));
+        // An mmap ring that holds fewer periods than asked is simply full.
+        if (playbackAccess_ != Access::ReadWrite
+            && snd_pcm_avail_update(playbackHandle_) < static_cast<snd_pcm_sframes_t>(actualFrames_))
+            break;
+        writePlayback(0);
+    }
+}
+
+void AlsaAudioEngine::startMmapStreams()
+{
+    if (playbackAccess_ != Access::ReadWrite) snd_pcm_start(playbackHandle_);
+    if (captureAccess_  != Access::ReadWrite) snd_pcm_start(captureHandle_);
+}
+
+// ---------------------------------------------------------------------------
+// Period transfer
+//
+// Read/write access: readi/writei through captureRaw_/playbackRaw_.
+// mmap access: wait for a full period, then convert straight from/into the
+// ring, in two chunks when the period wraps around its end.
+// ---------------------------------------------------------------------------
+
+// Wait until handle has at least frames available. Returns the available
+// count, 0 on timeout, or a negative ALSA error (-EPIPE on xrun).
+static snd_pcm_sframes_t waitAvailable(snd_pcm_t* handle, snd_pcm_uframes_t frames)
+{
+    constexpr int kTimeoutMs = 1000;
+    for (;;) {
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+        if (avail < 0 || static_cast<snd_pcm_uframes_t>(avail) >= frames) return avail;
+
+        const int err = snd_pcm_wait(handle, kTimeoutMs);
+        if (err < 0)  return err;
+        if (err == 0) return 0;
+    }
+}
+
+void AlsaAudioEngine::mapAreas(const snd_pcm_channel_area_t* areas, unsigned long offset,
+                               SampleFormat fmt, std::vector<RawChannel>& layout)
+{
+    const unsigned int bits = 8u * static_cast<unsigned int>(bytesPerSample(fmt));
+    for (std::size_t c = 0; c < layout.size(); ++c) {
+        const snd_pcm_channel_area_t& area = areas[c];
+        layout[c].data   = static_cast<uint8_t*>(area.addr) + (area.first + offset * area.step) / 8;
+        layout[c].stride = static_cast<int>(area.step / bits);
+    }
+}
+
+long AlsaAudioEngine::readCapture()
+{
+    const snd_pcm_uframes_t frames = actualFrames_;
+
+    if (captureAccess_ == Access::ReadWrite) {
+        const snd_pcm_sframes_t n = snd_pcm_readi(captureHandle_, captureRaw_.data(), frames);
+        if (n == static_cast<snd_pcm_sframes_t>(frames))
+            deinterleaveCapture(captureLayout_.data() + config_.inputChannel, block_);
+        return n;
+    }
+
+    const snd_pcm_sframes_t avail = waitAvailable(captureHandle_, frames);
+    if (avail < static_cast<snd_pcm_sframes_t>(frames)) return avail;
+
+    for (snd_pcm_uframes_t done = 0; done < frames; ) {
+        const snd_pcm_channel_area_t* areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t chunk  = frames - done;
+        const int err = snd_pcm_mmap_begin(captureHandle_, &areas, &offset, &chunk);
+        if (err < 0) return err;
+
+        mapAreas(areas, offset, captureFmt_, captureLayout_);
+        deinterleaveCapture(captureLayout_.data() + config_.inputChannel,
+                            block_.slice(static_cast<int>(done), static_cast<int>(chunk)));
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(captureHandle_, offset, chunk);
+        if (committed < 0) return committed;
+        if (static_cast<snd_pcm_uframes_t>(committed) != chunk) return -EPIPE;
+        done += chunk;
     }
+    return static_cast<long>(frames);
+}
+
+long AlsaAudioEngine::writePlayback(int channelMask)
+{
+    const snd_pcm_uframes_t frames = actualFrames_;
+
+    if (playbackAccess_ == Access::ReadWrite) {
+        interleavePlayback(block_, playbackLayout_.data(), channelMask);
+        return snd_pcm_writei(playbackHandle_, playbackRaw_.data(), frames);
+    }
+
+    const snd_pcm_sframes_t avail = waitAvailable(playbackHandle_, frames);
+    if (avail < static_cast<snd_pcm_sframes_t>(frames)) return avail;
+
+    for (snd_pcm_uframes_t done = 0; done < frames; ) {
+        const snd_pcm_channel_area_t* areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t chunk  = frames - done;
+        const int err = snd_pcm_mmap_begin(playbackHandle_, &areas, &offset, &chunk);
+        if (err < 0) return err;
+
+        mapAreas(areas, offset, playbackFmt_, playbackLayout_);
+        interleavePlayback(block_.slice(static_cast<int>(done), static_cast<int>(chunk)),
+                           playbackLayout_.data(), channelMask);
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(playbackHandle_, offset, chunk);
+        if (committed < 0) return committed;
+        if (static_cast<snd_pcm_uframes_t>(committed) != chunk) return -EPIPE;
+        done += chunk;
+    }
+    return static_cast<long>(frames);
 }
 
 // ---------------------------------------------------------------------------
 // Format conversion helpers
 // ---------------------------------------------------------------------------
 
-void AlsaAudioEngine::deinterleaveCapture(const void* raw, float* mono,
-                                            int frames, int totalChannels,
-                                            int channel)
+void AlsaAudioEngine::deinterleaveCapture(const RawChannel* raw, const AudioBlock& block)
 {
-    switch (captureFmt_) {
-        case SampleFormat::Int16: {
-            const int16_t* src = static_cast<const int16_t*>(raw);
-            constexpr float kScale = 1.f / 32768.f;
-            for (int i = 0; i < frames; ++i)
-                mono[i] = static_cast<float>(src[i * totalChannels + channel]) * kScale;
-            break;
-        }
-        case SampleFormat::Int32: {
-            const int32_t* src = static_cast<const int32_t*>(raw);
-            constexpr float kScale = 1.f / 2147483648.f;
-            for (int i = 0; i < frames; ++i)
-                mono[i] = static_cast<float>(src[i * totalChannels + channel]) * kScale;
-            break;
-        }
-        case SampleFormat::Float32: {
-            const float* src = static_cast<const float*>(raw);
-            for (int i = 0; i < frames; ++i)
-                mono[i] = src[i * totalChannels + channel];
-            break;
-        }
+    for (int ch = 0; ch < block.numChannels; ++ch) {
+        captureConverter_.convert(raw[ch], block.channels[ch], block.numSamples);
     }
 }
 
-void AlsaAudioEngine::interleavePlayback(const float* mono, void* raw,
-                                          int frames, int totalChannels,
+// Output channel c plays processed channel c % numChannels: mono goes to
+// every selected output, stereo L/R to L/R.
+void AlsaAudioEngine::interleavePlayback(const AudioBlock& block, const RawChannel* raw,
                                           int channelMask)
 {
-    switch (playbackFmt_) {
-        case SampleFormat::Int16: {
-            int16_t* dst = static_cast<int16_t*>(raw);
-            std::memset(dst, 0,
-                static_cast<std::size_t>(frames) * totalChannels * sizeof(int16_t));
-            constexpr float kScale = 32767.f;
-            for (int i = 0; i < frames; ++i)
-                for (int c = 0; c < totalChannels; ++c)
-                    if (channelMask & (1 << c))
-                        dst[i * totalChannels + c] =
-                            static_cast<int16_t>(mono[i] * kScale);
-            break;
-        }
-        case SampleFormat::Int32: {
-            int32_t* dst = static_cast<int32_t*>(raw);
-            std::memset(dst, 0,
-                static_cast<std::size_t>(frames) * totalChannels * sizeof(int32_t));
-            constexpr float kScale = 2147483647.f;
-            for (int i = 0; i < frames; ++i)
-                for (int c = 0; c < totalChannels; ++c)
-                    if (channelMask & (1 << c))
-                        dst[i * totalChannels + c] =
-                            static_cast<int32_t>(mono[i] * kScale);
-            break;
-        }
-        case SampleFormat::Float32: {
-            float* dst = static_cast<float*>(raw);
-            std::memset(dst, 0,
-                static_cast<std::size_t>(frames) * totalChannels * sizeof(float));
-            for (int i = 0; i < frames; ++i)
-                for (int c = 0; c < totalChannels; ++c)
-                    if (channelMask & (1 << c))
-                        dst[i * totalChannels + c] = mono[i];
-            break;
-        }
+    const int totalChannels = static_cast<int>(playbackChannels_);
+    for (int c = 0; c < totalChannels; ++c) {
+        PlaybackConverter& converter = playbackConverters_[static_cast<std::size_t>(c)];
+        if (channelMask & (1 << c))
+            converter.convert(block.channels[c % block.numChannels], raw[c], block.numSamples);
+        else
+            converter.silence(raw[c], block.numSamples);
     }
 }
 
@@ -2,6 +2,8 @@
 
 #include "audio_engine.h"
 
+#include "hexcaster/sample_convert.h"
+
 #include <atomic>
 #include <string>
 #include <vector>
@@ -9,6 +11,7 @@
 // Forward-declare ALSA types to avoid pulling alsa/asoundlib.h into consumer headers
 struct _snd_pcm;
 typedef struct _snd_pcm snd_pcm_t;
+struct _snd_pcm_channel_area;
 
 namespace hexcaster {
 
@@ -22,15 +25,29 @@ namespace hexcaster {
  * SCHED_FIFO real-time priority.
  *
  * Channel handling:
- *   - Capture: reads N-channel interleaved audio, extracts config.inputChannel
- *              to a mono float buffer.
- *   - Playback: takes mono float buffer, writes to channels selected by
- *               config.outputChannels bitmask. Unused channels get silence.
+ *   - Capture: reads N-channel interleaved audio, extracts config.numChannels
+ *              channels from config.inputChannel on into planar float
+ *              buffers (one for mono).
+ *   - Playback: writes the processed channels to the channels selected by
+ *               config.outputChannels bitmask (output c gets processed
+ *               channel c % numChannels). Opens at least stereo, more if
+ *               the mask reaches past output 1. Unused channels get silence.
  *
  * Sample format negotiation:
- *   Probes for S16_LE first (universal USB support), then S32_LE, then
- *   FLOAT_LE. Conversion to/from float is handled internally -- the
- *   ProcessCallback always sees float.
+ *   Probes for S16_LE first (universal USB support), then S32_LE,
+ *   FLOAT_LE, S24_LE and S24_3LE (interfaces that only do 24-bit stay on
+ *   hw: instead of plughw). Conversion to/from float is handled
+ *   internally -- the ProcessCallback always sees float. The
+ *   Capture/PlaybackConverter kernels are picked in open() for the
+ *   negotiated format and stride; playback saturates, and dithers 16-bit
+ *   output unless config.dither is false.
+ *
+ * Access negotiation (per handle, for each format):
+ *   MMAP_INTERLEAVED, then MMAP_NONINTERLEAVED, then RW_INTERLEAVED.
+ *   With mmap the conversion reads straight from the capture ring and
+ *   writes straight into the playback ring (snd_pcm_mmap_begin/commit):
+ *   no readi/writei copy through an intermediate buffer. Config::mmapAccess
+ *   = false forces read/write.
  *
  * Xrun recovery:
  *   On EPIPE (underrun/overrun), prepares both handles and re-primes the
@@ -46,6 +63,7 @@ public:
 
     bool open(const Config& config) override;
     void setCallback(ProcessCallback cb) override;
+    void setBlockCallback(BlockCallback cb) override;
     void run() override;
     void stop() override;
     void close() override;
@@ -55,25 +73,37 @@ public:
     unsigned int actualBufferFrames() const override { return actualFrames_; }
 
 private:
-    enum class SampleFormat { Float32, Int32, Int16 };
-
-    static int bytesPerSample(SampleFormat fmt);
+    // How a handle exchanges samples: converted in place in the mmap'd
+    // ring, or copied by readi/writei through captureRaw_/playbackRaw_.
+    enum class Access { MmapInterleaved, MmapNonInterleaved, ReadWrite };
 
     bool openHandle(const std::string& device, bool isCapture,
                     snd_pcm_t*& handle, unsigned int& channels,
-                    SampleFormat& fmt);
+                    SampleFormat& fmt, Access& access);
 
     bool recoverBoth();
 
     void primePlayback();
 
-    // Interleaved raw buffer -> mono float (extract one channel)
-    void deinterleaveCapture(const void* raw, float* mono,
-                              int frames, int totalChannels, int channel);
+    // mmap handles do not start on their own; read/write ones do.
+    void startMmapStreams();
+
+    // One period: capture into block_ / play block_ (channelMask 0 plays
+    // silence). Return frames transferred, 0 on a wait timeout, or a
+    // negative ALSA error.
+    long readCapture();
+    long writePlayback(int channelMask);
 
-    // Mono float -> interleaved raw buffer (write selected channels)
-    void interleavePlayback(const float* mono, void* raw,
-                             int frames, int totalChannels, int channelMask);
+    // Point layout at frame offset of an mmap area set.
+    static void mapAreas(const _snd_pcm_channel_area* areas, unsigned long offset,
+                         SampleFormat fmt, std::vector<RawChannel>& layout);
+
+    // Raw device channels -> planar float: raw[ch] feeds block.channels[ch]
+    void deinterleaveCapture(const RawChannel* raw, const AudioBlock& block);
+
+    // Planar float -> raw device channels (selected ones; others get silence)
+    void interleavePlayback(const AudioBlock& block, const RawChannel* raw,
+                             int channelMask);
 
     snd_pcm_t*    captureHandle_  = nullptr;
     snd_pcm_t*    playbackHandle_ = nullptr;
@@ -81,22 +111,34 @@ private:
     Config        config_;
     SampleFormat  captureFmt_       = SampleFormat::Int16;
     SampleFormat  playbackFmt_      = SampleFormat::Int16;
+    Access        captureAccess_    = Access::ReadWrite;
+    Access        playbackAccess_   = Access::ReadWrite;
     unsigned int  captureChannels_  = 2;
     unsigned int  playbackChannels_ = 2;
     unsigned int  actualRate_       = 0;
     unsigned int  actualFrames_     = 0;
 
-    // Raw interleaved capture/playback buffers (allocated at open time)
+    // Raw interleaved capture/playback buffers, read/write access only
+    // (allocated at open time)
     std::vector<uint8_t> captureRaw_;
     std::vector<uint8_t> playbackRaw_;
 
-    // Silence buffer for playback priming (same size as playbackRaw_)
-    std::vector<uint8_t> silenceRaw_;
+    // Per device channel: into the raw buffers above (fixed), or into the
+    // mmap ring (re-pointed at every snd_pcm_mmap_begin)
+    std::vector<RawChannel> captureLayout_;
+    std::vector<RawChannel> playbackLayout_;
+
+    // Conversion kernels, set up for the negotiated format and layout: one
+    // for capture (stateless), one per playback channel (own dither state)
+    CaptureConverter               captureConverter_;
+    std::vector<PlaybackConverter> playbackConverters_;
 
-    // Mono float working buffer
-    std::vector<float> monoBuffer_;
+    // Planar float working buffers, one plane per processed channel
+    std::vector<float> channelBuffer_;
+    AudioBlock         block_;
 
     ProcessCallback   callback_;
+    BlockCallback     blockCallback_;
     std::atomic<bool> running_{ false };
     std::string       errorMsg_;
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "hexcaster/audio_block.h"
+
 #include <functional>
 #include <string>
 #include <cstdint>
@@ -29,6 +31,12 @@ public:
      */
     using ProcessCallback = std::function<void(float* buffer, int numFrames)>;
 
+    /**
+     * BlockCallback: as ProcessCallback, for config.numChannels planar
+     * channels (see AudioBlock). Required when numChannels > 1.
+     */
+    using BlockCallback = std::function<void(const AudioBlock& block)>;
+
     /**
      * Config: parameters for opening the audio engine.
      *
@@ -41,7 +49,15 @@ public:
      *   Note: clock drift recovery is not yet implemented.
      *
      * inputChannel:   which channel of a stereo interface to use as input (0=L, 1=R)
-     * outputChannels: bitmask of output channels to write to (0x1=L, 0x2=R, 0x3=both)
+     * numChannels:    channels processed, planar: capture channels inputChannel ..
+     *                 inputChannel + numChannels - 1 (1 = mono, up to
+     *                 AudioBlock::kMaxChannels)
+     * outputChannels: bitmask of output channels to write to (0x1=L, 0x2=R, 0x3=both,
+     *                 0xF = outputs 0-3 of a 4-out interface); output channel c
+     *                 plays processed channel c % numChannels
+     * mmapAccess:     convert in place in the device's mmap ring when it
+     *                 supports that (fewer copies per period); false = read/write
+     * dither:         TPDF dither on 16-bit output (no effect on 32-bit/float)
      */
     struct Config {
         std::string  inputDevice    = "hw:2,0";
@@ -50,7 +66,10 @@ public:
         unsigned int bufferFrames   = 128;
         unsigned int periods        = 2;
         int          inputChannel   = 0;    // 0=left, 1=right
+        int          numChannels    = 1;    // planar channels from inputChannel on
         int          outputChannels = 0x3;  // bitmask: 0x1=L, 0x2=R, 0x3=both
+        bool         mmapAccess     = true;
+        bool         dither         = true;
     };
 
     virtual ~AudioEngine() = default;
@@ -67,6 +86,12 @@ public:
      */
     virtual void setCallback(ProcessCallback cb) = 0;
 
+    /**
+     * Set the multichannel processing callback; used instead of the mono
+     * one when set. Must be called before run().
+     */
+    virtual void setBlockCallback(BlockCallback cb) = 0;
+
     /**
      * Start the audio loop. Blocks until stop() is called or a fatal error occurs.
      * Sets real-time thread priority internally (best-effort; continues if not granted).
@@ -3,19 +3,27 @@
 #include "midi_input.h"
 
 #include "hexcaster/pipeline.h"
+#include "hexcaster/chain_scheduler.h"
+#include "hexcaster/static_pipeline.h"
+#include "hexcaster/dual_amp_stage.h"
 #include "hexcaster/gain_stage.h"
+#include "hexcaster/nam_model_bank.h"
 #include "hexcaster/nam_stage.h"
 #include "hexcaster/noise_gate.h"
+#include "hexcaster/bloom_controller.h"
 #include "hexcaster/eq.h"
 #include "hexcaster/param_registry.h"
 #include "hexcaster/midi_map.h"
 #include "hexcaster/param_id.h"
+#include "hexcaster/rt_thread.h"
 
+#include <algorithm>
 #include <atomic>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <thread>
 #include <unistd.h>
@@ -47,17 +55,40 @@ struct Args {
     std::string  inputDevice    = "hw:2,0";
     std::string  outputDevice   = "hw:2,0";
     std::string  modelPath;
+    std::vector<std::string> bankPaths;         // --bank, in program order
+    std::string  ampBPath;                      // empty = single amp
+    float        ampMix         = 0.5f;
+    int          ampBCpu        = -1;
+    int          splitCuts[hexcaster::Pipeline::kMaxSegments - 1] = {};
+    int          numSplitCuts   = 0;
+    int          splitCpus[hexcaster::Pipeline::kMaxSegments - 1] = { -1, -1 };
+    int          rackChains     = 0;            // 0 = single chain
+    std::vector<std::string> rackModelPaths;    // --rack-model, in chain order
+    int          rackCpus[hexcaster::ChainScheduler::kMaxWorkers] = {};
+    int          numRackCpus    = -1;           // -1 = one worker per spare core
     std::string  midiDevice;                    // empty = MIDI disabled
     unsigned int sampleRate     = 48000;
     unsigned int bufferFrames   = 128;
+    int          microBlock     = hexcaster::Pipeline::kDefaultMicroBlockSize;
     float        gainDb                = 0.f;
     float        gateThresholdDb      = -60.f;
+    float        gateLookaheadMs      = 0.f;
     float        eqGainDb             = 0.f;
     float        eqSweepHz            = 1000.f;
+    float        eqLowCutHz           = 20.f;
+    float        eqBassDb             = 0.f;
+    float        eqBassHz             = 120.f;
+    float        eqTrebleDb           = 0.f;
+    float        eqTrebleHz           = 3000.f;
+    float        eqHighCutHz          = 20000.f;
     float        masterVolumeDb       = 0.f;
     int          inputChannel         = 0;
     bool         listDevices    = false;
     bool         listMidi       = false;
+    bool         bloom          = false;
+    bool         stats          = false;
+    bool         mmapAccess     = true;
+    bool         dither         = true;
     bool         help           = false;
     std::vector<MidiCcMapping> midiMappings;
 };
@@ -68,29 +99,66 @@ static void printUsage(const char* prog)
         "Usage: %s --model <path.nam> [options]\n"
         "\n"
         "Options:\n"
-        "  --model <path>              NAM model file (.nam)  [required]\n"
+        "  --model <path>              NAM model file (.nam)  [required unless --bank]\n"
+        "  --bank <path>               Add a model to the preloaded bank (repeatable);\n"
+        "                              MIDI Program Change N selects the Nth --bank.\n"
+        "                              Without --model, starts on the first one.\n"
+        "  --amp-b <path>              Second NAM model, run in parallel on another core\n"
+        "  --amp-mix <0-1>             Blend amp A (0) -> amp B (1)  [default: 0.5]\n"
+        "  --amp-b-cpu <N>             Pin the amp B worker to CPU N  [default: unpinned]\n"
+        "  --split <i>[,<j>]           Run stages from index i (and j) on worker threads;\n"
+        "                              adds one block of latency per cut\n"
+        "  --split-cpus <c>[,<d>]      Pin the --split workers to these CPUs\n"
+        "  --rack <N>                  Run N independent chains (2-8), one per player:\n"
+        "                              chain i takes capture channel --input-channel + i\n"
+        "                              and plays on output i; each chain has its own\n"
+        "                              parameters, driven by MIDI CCs on channel i + 1\n"
+        "  --rack-model <path>         Model for the next rack chain (repeatable);\n"
+        "                              chains without one use --model\n"
+        "  --rack-cpus <c>[,<d>...]    One rack worker per listed CPU, pinned\n"
+        "                              [default: one per spare core, CPUs 1, 2, ...,\n"
+        "                              with the audio thread pinned to CPU 0]\n"
         "  --device <hw:X,Y>           Set both input and output device\n"
         "  --input-device <dev>        Input audio device\n"
         "  --output-device <dev>       Output audio device\n"
         "  --sample-rate <Hz>          Sample rate  [default: 48000]\n"
         "  --buffer <frames>           Buffer size in frames  [default: 128]\n"
+        "  --no-mmap                   Use read/write device access even where mmap\n"
+        "                              is supported\n"
+        "  --no-dither                 No TPDF dither on 16-bit output\n"
+        "  --micro-block <frames>      Run the chain in slices of at most this size;\n"
+        "                              0 = whole periods  [default: 128]\n"
         "  --gain <dB>                 Initial input gain in dB  [default: 0.0]\n"
         "  --gate-threshold <dB>       Noise gate threshold  [-80, 0] dB  [default: -60]\n"
+        "  --gate-lookahead <ms>       Gate detection lead; delays the signal by the\n"
+        "                              same amount  [0, 5] ms  [default: 0]\n"
         "  --eq-gain <dB>              Post-NAM EQ gain  [-12, +12] dB  [default: 0]\n"
         "  --eq-sweep <Hz>             Post-NAM EQ center frequency  [300, 2500] Hz  [default: 1000]\n"
+        "  --eq-low-cut <Hz>           Post-NAM high-pass  [20, 300] Hz, 20 = off  [default: 20]\n"
+        "  --eq-bass <dB>              Post-NAM low shelf  [-12, +12] dB  [default: 0]\n"
+        "  --eq-bass-freq <Hz>         Low shelf corner  [60, 400] Hz  [default: 120]\n"
+        "  --eq-treble <dB>            Post-NAM high shelf  [-12, +12] dB  [default: 0]\n"
+        "  --eq-treble-freq <Hz>       High shelf corner  [1500, 8000] Hz  [default: 3000]\n"
+        "  --eq-high-cut <Hz>          Post-NAM low-pass  [2000, 20000] Hz, 20000 = off\n"
+        "                              [default: 20000]\n"
         "  --master-volume <dB>        Final output level to power amp  [-60, +24] dB  [default: 0]\n"
         "  --input-channel <N>         Capture channel: 0=left, 1=right  [default: 0]\n"
+        "  --bloom                     Envelope-driven pre/post gain around the amp model\n"
+        "                              (Bloom* and Env* parameters)\n"
         "  --midi-device <hw:X,Y,Z>    ALSA raw MIDI input device\n"
         "  --midi-cc <cc>:<ParamName>  Map a MIDI CC to a parameter  (repeatable)\n"
         "  --list-devices              Print ALSA PCM devices and exit\n"
         "  --list-midi                 Print ALSA raw MIDI devices and exit\n"
+        "  --stats                     Print per-stage timing on exit\n"
+        "                              (needs -DHEXCASTER_PIPELINE_STATS=ON)\n"
         "  --help                      Show this help and exit\n"
         "\n"
         "Parameter names for --midi-cc:\n"
         "  InputGain_dB         BloomBasePre_dB    BloomBasePost_dB\n"
         "  BloomPreDepth        BloomPostDepth     EnvAttackMs  EnvReleaseMs\n"
         "  NoiseGateThreshold_dB  NoiseGateAttackMs  NoiseGateReleaseMs  NoiseGateHoldMs\n"
-        "  EqGain_dB  EqSweepHz  EqQ  MasterVolume_dB\n"
+        "  EqGain_dB  EqSweepHz  EqQ  EqLowCutHz  EqBass_dB  EqBassHz\n"
+        "  EqTreble_dB  EqTrebleHz  EqHighCutHz  MasterVolume_dB  AmpMix_Norm\n"
         "\n"
         "Examples:\n"
         "  %s --model ~/amp.nam --input-device hw:CARD=V276,DEV=0 \\\n"
@@ -99,8 +167,11 @@ static void printUsage(const char* prog)
         "  %s --model ~/amp.nam --input-device hw:CARD=V276,DEV=0 \\\n"
         "     --output-device hw:CARD=sndrpihifiberry,DEV=0 \\\n"
         "     --midi-device hw:1,0,0 \\\n"
-        "     --midi-cc 7:InputGain_dB --midi-cc 1:BloomBasePre_dB\n",
-        prog, prog, prog);
+        "     --midi-cc 7:InputGain_dB --midi-cc 1:BloomBasePre_dB\n"
+        "\n"
+        "  %s --bank ~/clean.nam --bank ~/crunch.nam --bank ~/lead.nam \\\n"
+        "     --midi-device hw:1,0,0\n",
+        prog, prog, prog, prog);
 }
 
 static bool parseMidiCc(const char* arg, MidiCcMapping& out)
@@ -129,6 +200,22 @@ static bool parseMidiCc(const char* arg, MidiCcMapping& out)
     return true;
 }
 
+// Parse "a[,b...]" into at most maxCount ints. Returns the count, or -1.
+static int parseIntList(const char* arg, int* out, int maxCount)
+{
+    int count = 0;
+    for (const char* p = arg; *p; ) {
+        if (count == maxCount) return -1;
+        char* end = nullptr;
+        out[count++] = static_cast<int>(std::strtol(p, &end, 10));
+        if (end == p) return -1;
+        if (*end == ',') ++end;
+        else if (*end != '\0') return -1;
+        p = end;
+    }
+    return count;
+}
+
 static bool parseArgs(int argc, char** argv, Args& args)
 {
     for (int i = 1; i < argc; ++i) {
@@ -155,6 +242,47 @@ static bool parseArgs(int argc, char** argv, Args& args)
         if (std::strcmp(key, "--model") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.modelPath = v;
+        } else if (std::strcmp(key, "--bank") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.bankPaths.emplace_back(v);
+        } else if (std::strcmp(key, "--amp-b") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.ampBPath = v;
+        } else if (std::strcmp(key, "--amp-mix") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.ampMix = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--amp-b-cpu") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.ampBCpu = std::atoi(v);
+        } else if (std::strcmp(key, "--split") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.numSplitCuts = parseIntList(v, args.splitCuts, hexcaster::Pipeline::kMaxSegments - 1);
+            if (args.numSplitCuts < 0) {
+                std::fprintf(stderr, "Error: --split expects up to %d stage indices, got '%s'\n",
+                             hexcaster::Pipeline::kMaxSegments - 1, v);
+                return false;
+            }
+        } else if (std::strcmp(key, "--split-cpus") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            if (parseIntList(v, args.splitCpus, hexcaster::Pipeline::kMaxSegments - 1) < 0) {
+                std::fprintf(stderr, "Error: --split-cpus expects up to %d CPU numbers, got '%s'\n",
+                             hexcaster::Pipeline::kMaxSegments - 1, v);
+                return false;
+            }
+        } else if (std::strcmp(key, "--rack") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.rackChains = std::atoi(v);
+        } else if (std::strcmp(key, "--rack-model") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.rackModelPaths.emplace_back(v);
+        } else if (std::strcmp(key, "--rack-cpus") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.numRackCpus = parseIntList(v, args.rackCpus, hexcaster::ChainScheduler::kMaxWorkers);
+            if (args.numRackCpus < 0) {
+                std::fprintf(stderr, "Error: --rack-cpus expects up to %d CPU numbers, got '%s'\n",
+                             hexcaster::ChainScheduler::kMaxWorkers, v);
+                return false;
+            }
         } else if (std::strcmp(key, "--device") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.inputDevice = args.outputDevice = v;
@@ -170,24 +298,56 @@ static bool parseArgs(int argc, char** argv, Args& args)
         } else if (std::strcmp(key, "--buffer") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.bufferFrames = static_cast<unsigned int>(std::atoi(v));
+        } else if (std::strcmp(key, "--no-mmap") == 0) {
+            args.mmapAccess = false;
+        } else if (std::strcmp(key, "--no-dither") == 0) {
+            args.dither = false;
+        } else if (std::strcmp(key, "--micro-block") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.microBlock = std::atoi(v);
         } else if (std::strcmp(key, "--gain") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.gainDb = static_cast<float>(std::atof(v));
         } else if (std::strcmp(key, "--gate-threshold") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.gateThresholdDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--gate-lookahead") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.gateLookaheadMs = static_cast<float>(std::atof(v));
         } else if (std::strcmp(key, "--eq-gain") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.eqGainDb = static_cast<float>(std::atof(v));
         } else if (std::strcmp(key, "--eq-sweep") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.eqSweepHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-low-cut") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqLowCutHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-bass") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqBassDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-bass-freq") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqBassHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-treble") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqTrebleDb = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-treble-freq") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqTrebleHz = static_cast<float>(std::atof(v));
+        } else if (std::strcmp(key, "--eq-high-cut") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.eqHighCutHz = static_cast<float>(std::atof(v));
         } else if (std::strcmp(key, "--master-volume") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.masterVolumeDb = static_cast<float>(std::atof(v));
         } else if (std::strcmp(key, "--input-channel") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.inputChannel = std::atoi(v);
+        } else if (std::strcmp(key, "--bloom") == 0) {
+            args.bloom = true;
+        } else if (std::strcmp(key, "--stats") == 0) {
+            args.stats = true;
         } else if (std::strcmp(key, "--midi-device") == 0) {
             const char* v = nextArg(); if (!v) return false;
             args.midiDevice = v;
@@ -204,6 +364,23 @@ static bool parseArgs(int argc, char** argv, Args& args)
     return true;
 }
 
+// ---------------------------------------------------------------------------
+// Rack mode (--rack): one default chain per player, each with its own state
+// ---------------------------------------------------------------------------
+
+struct RackChain {
+    hexcaster::ParamRegistry params;   // this player's controls (MIDI channel = chain + 1)
+    hexcaster::NoiseGate  noiseGate;
+    hexcaster::GainStage  inputGain;
+    hexcaster::NamStage   nam;
+    hexcaster::ToneEQ     tone;
+    hexcaster::MidSweepEQ eq;
+    hexcaster::GainStage  masterVolume;
+    hexcaster::StaticPipeline<hexcaster::NoiseGate, hexcaster::GainStage, hexcaster::NamStage,
+                              hexcaster::ToneEQ, hexcaster::MidSweepEQ, hexcaster::GainStage>
+        chain{ noiseGate, inputGain, nam, tone, eq, masterVolume };
+};
+
 // ---------------------------------------------------------------------------
 // Device listing
 // ---------------------------------------------------------------------------
@@ -250,6 +427,46 @@ static void listMidiDevices()
     snd_device_name_free_hint(hints);
 }
 
+// ---------------------------------------------------------------------------
+// Pipeline timing report (--stats)
+// ---------------------------------------------------------------------------
+
+static void printPipelineStats(const hexcaster::Pipeline& pipeline,
+                               const char* const* stageNames,
+                               double blockBudgetUs)
+{
+    const hexcaster::Pipeline::Stats st = pipeline.stats();
+    if (!st.enabled) {
+        std::fprintf(stdout, "Stats: not compiled in (configure with -DHEXCASTER_PIPELINE_STATS=ON)\n");
+        return;
+    }
+
+    const double usPerCycle = 1e6 / st.cycleHz;
+    auto row = [&](const char* name, const hexcaster::TimingSnapshot& t) {
+        std::fprintf(stdout, "  %-14s %10llu  %9.2f  %9.2f  %9.2f  %9.2f  %5.1f%%\n",
+            name, static_cast<unsigned long long>(t.count),
+            t.meanCycles() * usPerCycle,
+            t.percentileCycles(0.50) * usPerCycle,
+            t.percentileCycles(0.99) * usPerCycle,
+            static_cast<double>(t.maxCycles) * usPerCycle,
+            blockBudgetUs > 0.0 ? 100.0 * t.meanCycles() * usPerCycle / blockBudgetUs : 0.0);
+    };
+
+    std::fprintf(stdout,
+        "Stats: per-block timing in us (budget %.1f us, p50/p99 are power-of-two upper bounds)\n"
+        "  %-14s %10s  %9s  %9s  %9s  %9s  %6s\n",
+        blockBudgetUs, "slot", "blocks", "mean", "p50", "p99", "max", "budget");
+    for (int i = 0; i < st.numStages; ++i)
+        row(stageNames[i], st.stages[i]);
+    for (int i = 0; i < st.numControllers; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "controller %d", i);
+        row(name, st.controllers[i]);
+    }
+    // Pipelined, the workers' segments run beside the audio thread's block
+    row(pipeline.numSegments() > 1 ? "audio thread" : "total", st.block);
+}
+
 // ---------------------------------------------------------------------------
 // main
 // ---------------------------------------------------------------------------
@@ -268,22 +485,58 @@ int main(int argc, char** argv)
     if (args.listDevices) { listAlsaDevices();    return 0; }
     if (args.listMidi)    { listMidiDevices();    return 0; }
 
-    if (args.modelPath.empty()) {
-        std::fprintf(stderr, "Error: --model is required.\n\n");
+    if (args.modelPath.empty() && args.bankPaths.empty() && args.rackModelPaths.empty()) {
+        std::fprintf(stderr, "Error: --model or --bank is required.\n\n");
         printUsage(argv[0]);
         return 1;
     }
 
+    const bool rackMode = args.rackChains != 0;
+    if (rackMode) {
+        if (args.rackChains < 2 || args.rackChains > hexcaster::AudioBlock::kMaxChannels) {
+            std::fprintf(stderr, "Error: --rack expects 2-%d chains\n",
+                         hexcaster::AudioBlock::kMaxChannels);
+            return 1;
+        }
+        if (!args.bankPaths.empty() || !args.ampBPath.empty() || args.bloom
+            || args.numSplitCuts > 0 || args.stats) {
+            std::fprintf(stderr, "Error: --rack runs the default chain; --bank, --amp-b, --bloom, "
+                                 "--split and --stats are single-chain only\n");
+            return 1;
+        }
+        const int numModels = static_cast<int>(args.rackModelPaths.size());
+        if (numModels > args.rackChains
+            || (args.modelPath.empty() && numModels < args.rackChains)) {
+            std::fprintf(stderr, "Error: give one --rack-model per chain (%d), or --model for "
+                                 "the chains without one\n", args.rackChains);
+            return 1;
+        }
+    } else if (!args.rackModelPaths.empty() || args.numRackCpus >= 0) {
+        std::fprintf(stderr, "Error: --rack-model and --rack-cpus need --rack\n");
+        return 1;
+    }
+
     // -------------------------------------------------------------------------
     // Parameter registry and MIDI map
     // -------------------------------------------------------------------------
 
+    auto initParams = [&](hexcaster::ParamRegistry& registry) {
+        registry.set(hexcaster::ParamId::InputGain_dB,          args.gainDb);
+        registry.set(hexcaster::ParamId::NoiseGateThreshold_dB, args.gateThresholdDb);
+        registry.set(hexcaster::ParamId::EqGain_dB,             args.eqGainDb);
+        registry.set(hexcaster::ParamId::EqSweepHz,             args.eqSweepHz);
+        registry.set(hexcaster::ParamId::EqLowCutHz,            args.eqLowCutHz);
+        registry.set(hexcaster::ParamId::EqBass_dB,             args.eqBassDb);
+        registry.set(hexcaster::ParamId::EqBassHz,              args.eqBassHz);
+        registry.set(hexcaster::ParamId::EqTreble_dB,           args.eqTrebleDb);
+        registry.set(hexcaster::ParamId::EqTrebleHz,            args.eqTrebleHz);
+        registry.set(hexcaster::ParamId::EqHighCutHz,           args.eqHighCutHz);
+        registry.set(hexcaster::ParamId::MasterVolume_dB,       args.masterVolumeDb);
+        registry.set(hexcaster::ParamId::AmpMix_Norm,           args.ampMix);
+    };
+
     hexcaster::ParamRegistry params;
-    params.set(hexcaster::ParamId::InputGain_dB,          args.gainDb);
-    params.set(hexcaster::ParamId::NoiseGateThreshold_dB, args.gateThresholdDb);
-    params.set(hexcaster::ParamId::EqGain_dB,             args.eqGainDb);
-    params.set(hexcaster::ParamId::EqSweepHz,             args.eqSweepHz);
-    params.set(hexcaster::ParamId::MasterVolume_dB,       args.masterVolumeDb);
+    initParams(params);
 
     hexcaster::MidiMap midiMap;
     for (const auto& m : args.midiMappings) {
@@ -306,7 +559,14 @@ int main(int argc, char** argv)
             {"EqGain_dB",             hexcaster::ParamId::EqGain_dB},
             {"EqSweepHz",             hexcaster::ParamId::EqSweepHz},
             {"EqQ",                   hexcaster::ParamId::EqQ},
+            {"EqLowCutHz",            hexcaster::ParamId::EqLowCutHz},
+            {"EqBass_dB",             hexcaster::ParamId::EqBass_dB},
+            {"EqBassHz",              hexcaster::ParamId::EqBassHz},
+            {"EqTreble_dB",           hexcaster::ParamId::EqTreble_dB},
+            {"EqTrebleHz",            hexcaster::ParamId::EqTrebleHz},
+            {"EqHighCutHz",           hexcaster::ParamId::EqHighCutHz},
             {"MasterVolume_dB",       hexcaster::ParamId::MasterVolume_dB},
+            {"AmpMix_Norm",           hexcaster::ParamId::AmpMix_Norm},
         };
         for (auto& e : kNames)
             if (e.id == m.paramId) { paramName = e.n; break; }
@@ -319,12 +579,29 @@ int main(int argc, char** argv)
 
     hexcaster::NoiseGate noiseGate;
     noiseGate.setThresholdDb(args.gateThresholdDb);
+    noiseGate.setLookaheadMs(args.gateLookaheadMs);
 
     hexcaster::GainStage inputGain;
     inputGain.setGainDb(args.gainDb);
 
     hexcaster::NamStage nam;
 
+    // Optional second amp: nam becomes amp A of a DualAmpStage and amp B
+    // runs on its own worker thread.
+    hexcaster::NamStage     ampB;
+    hexcaster::DualAmpStage dualAmp(nam, ampB);
+    dualAmp.setMix(args.ampMix);
+    dualAmp.setWorkerCpu(args.ampBCpu);
+    const bool useDualAmp = !args.ampBPath.empty();
+
+    hexcaster::ToneEQ tone;
+    tone.setLowCutHz (args.eqLowCutHz);
+    tone.setBassDb   (args.eqBassDb);
+    tone.setBassHz   (args.eqBassHz);
+    tone.setTrebleDb (args.eqTrebleDb);
+    tone.setTrebleHz (args.eqTrebleHz);
+    tone.setHighCutHz(args.eqHighCutHz);
+
     hexcaster::MidSweepEQ eq;
     eq.setGainDb (args.eqGainDb);
     eq.setSweepHz(args.eqSweepHz);
@@ -332,34 +609,180 @@ int main(int argc, char** argv)
     hexcaster::GainStage masterVolume;
     masterVolume.setGainDb(args.masterVolumeDb);
 
-    hexcaster::Pipeline pipeline;
-    pipeline.addStage(&noiseGate);    // stage 0: noise gate
-    pipeline.addStage(&inputGain);    // stage 1: input gain
-    pipeline.addStage(&nam);          // stage 2: amp model
-    pipeline.addStage(&eq);           // stage 3: post-NAM EQ
-    pipeline.addStage(&masterVolume); // stage 4: master volume
-    pipeline.prepare(static_cast<float>(args.sampleRate),
-                     static_cast<int>(args.bufferFrames));
+    // Optional Bloom: gain stages either side of the amp model, driven
+    // per sample by the BloomController.
+    hexcaster::GainStage bloomPre;
+    hexcaster::GainStage bloomPost;
+
+    // Stage indices shift by one on each side of the amp when Bloom is on.
+    hexcaster::Pipeline      pipeline;
+    std::vector<const char*> stageNames;
+    auto addStage = [&](hexcaster::ProcessorStage* stage, const char* name) {
+        pipeline.addStage(stage);
+        stageNames.push_back(name);
+        return pipeline.numStages() - 1;
+    };
+    addStage(&noiseGate, "noise gate");
+    addStage(&inputGain, "input gain");
+    const int bloomPreIndex = args.bloom ? addStage(&bloomPre, "bloom pre") : -1;
+    if (useDualAmp)
+        addStage(&dualAmp, "nam (A + B)");
+    else
+        addStage(&nam, "nam");
+    const int bloomPostIndex = args.bloom ? addStage(&bloomPost, "bloom post") : -1;
+    addStage(&tone, "tone eq");
+    addStage(&eq, "mid eq");
+    addStage(&masterVolume, "master volume");
+
+    hexcaster::BloomController bloom(bloomPre, bloomPost, bloomPreIndex, bloomPostIndex, params);
+    if (args.bloom) {
+        // Controllers only run with segment 0, on the audio thread: both
+        // Bloom gain stages have to come before the first cut.
+        for (int i = 0; i < args.numSplitCuts; ++i) {
+            if (args.splitCuts[i] <= bloomPostIndex) {
+                std::fprintf(stderr, "Error: with --bloom, --split indices must be above %d\n",
+                             bloomPostIndex);
+                return 1;
+            }
+        }
+        pipeline.addController(&bloom);
+    }
 
-    std::fprintf(stdout, "Pipeline: %d stage(s)\n", pipeline.numStages());
+    if (args.numSplitCuts > 0
+        && !pipeline.setCutPoints(args.splitCuts, args.numSplitCuts, args.splitCpus)) {
+        std::fprintf(stderr, "Error: --split indices must be increasing and within 1-%d\n",
+                     pipeline.numStages() - 1);
+        return 1;
+    }
+    pipeline.setMicroBlockSize(args.microBlock);
+
+    // The default chain never changes shape at runtime, so it runs as a
+    // StaticPipeline (direct calls, gain stages fused). Dual amp, Bloom,
+    // --split and --stats need the runtime Pipeline.
+    hexcaster::StaticPipeline fixedChain(noiseGate, inputGain, nam, tone, eq, masterVolume);
+    fixedChain.setMicroBlockSize(args.microBlock);
+    const bool useFixedChain = !useDualAmp && !args.bloom && args.numSplitCuts == 0 && !args.stats;
+
+    // Rack mode: args.rackChains copies of the default chain, one per
+    // player; the ChainScheduler below runs them in parallel each period.
+    std::vector<std::unique_ptr<RackChain>> rack;
+    for (int i = 0; i < args.rackChains; ++i) {
+        auto r = std::make_unique<RackChain>();
+        initParams(r->params);
+        r->noiseGate.setThresholdDb(args.gateThresholdDb);
+        r->noiseGate.setLookaheadMs(args.gateLookaheadMs);
+        r->inputGain.setGainDb(args.gainDb);
+        r->tone.setLowCutHz (args.eqLowCutHz);
+        r->tone.setBassDb   (args.eqBassDb);
+        r->tone.setBassHz   (args.eqBassHz);
+        r->tone.setTrebleDb (args.eqTrebleDb);
+        r->tone.setTrebleHz (args.eqTrebleHz);
+        r->tone.setHighCutHz(args.eqHighCutHz);
+        r->eq.setGainDb (args.eqGainDb);
+        r->eq.setSweepHz(args.eqSweepHz);
+        r->masterVolume.setGainDb(args.masterVolumeDb);
+        r->chain.setMicroBlockSize(args.microBlock);
+        rack.push_back(std::move(r));
+    }
+
+    auto prepareChain = [&](unsigned int sampleRate, unsigned int frames) {
+        if (rackMode) {
+            for (auto& r : rack)
+                r->chain.prepare(static_cast<float>(sampleRate), static_cast<int>(frames));
+        } else if (useFixedChain) {
+            fixedChain.prepare(static_cast<float>(sampleRate), static_cast<int>(frames));
+        } else {
+            pipeline.prepare(static_cast<float>(sampleRate), static_cast<int>(frames));
+            bloom.prepare(static_cast<float>(sampleRate), pipeline.stageBlockSize());
+        }
+    };
+    auto processChain = [&](float* buf, int n) {
+        if (useFixedChain) fixedChain.process(buf, n);
+        else               pipeline.process(buf, n);
+    };
+    auto stageBlockSize = [&] {
+        if (rackMode) return rack[0]->chain.stageBlockSize();
+        return useFixedChain ? fixedChain.stageBlockSize() : pipeline.stageBlockSize();
+    };
+
+    prepareChain(args.sampleRate, args.bufferFrames);
+
+    const int stageLatency = rackMode      ? rack[0]->chain.latencySamples()
+                           : useFixedChain ? fixedChain.latencySamples()
+                                           : pipeline.latencySamples();
+    if (rackMode) {
+        std::fprintf(stdout, "Rack: %d chains of %d stage(s), static\n",
+                     args.rackChains, rack[0]->chain.numStages());
+    } else {
+        std::fprintf(stdout, "Pipeline: %d stage(s)%s\n", pipeline.numStages(),
+                     useFixedChain ? ", static" : "");
+    }
+    if (pipeline.numSegments() > 1) {
+        std::fprintf(stdout, "Pipeline: %d segments, +%d block(s) latency\n",
+                     pipeline.numSegments(), pipeline.latencyBlocks());
+    }
+    if (stageLatency > 0) {
+        std::fprintf(stdout, "Pipeline: +%d sample(s) stage latency\n", stageLatency);
+    }
 
     // -------------------------------------------------------------------------
     // Load NAM model
     // -------------------------------------------------------------------------
 
-    std::fprintf(stdout, "Loading model: %s\n", args.modelPath.c_str());
-    if (!nam.loadModel(args.modelPath)) {
-        std::fprintf(stderr, "Error: failed to load model '%s'\n", args.modelPath.c_str());
-        return 1;
+    // The bank loads in the background while audio runs, unless it has to
+    // supply the starting model.
+    hexcaster::NamModelBank bank;
+    if (!args.bankPaths.empty()) {
+        std::fprintf(stdout, "Loading bank: %zu model(s)\n", args.bankPaths.size());
+        bank.loadAsync(args.bankPaths, stageBlockSize());
+    }
+
+    if (rackMode) {
+        for (int i = 0; i < args.rackChains; ++i) {
+            const std::string& path = i < static_cast<int>(args.rackModelPaths.size())
+                                    ? args.rackModelPaths[static_cast<std::size_t>(i)]
+                                    : args.modelPath;
+            std::fprintf(stdout, "Loading model (chain %d): %s\n", i, path.c_str());
+            if (!rack[static_cast<std::size_t>(i)]->nam.loadModel(path)) {
+                std::fprintf(stderr, "Error: failed to load model '%s'\n", path.c_str());
+                return 1;
+            }
+        }
+    } else if (!args.modelPath.empty()) {
+        std::fprintf(stdout, "Loading model: %s\n", args.modelPath.c_str());
+        if (!nam.loadModel(args.modelPath)) {
+            std::fprintf(stderr, "Error: failed to load model '%s'\n", args.modelPath.c_str());
+            return 1;
+        }
+    } else {
+        if (!bank.wait())
+            std::fprintf(stderr, "Warning: %s\n", bank.errorMessage().c_str());
+        if (!nam.selectBankModel(bank, 0)) {
+            std::fprintf(stderr, "Error: bank slot 0 did not load\n");
+            return 1;
+        }
+    }
+
+    if (useDualAmp) {
+        std::fprintf(stdout, "Loading amp B: %s\n", args.ampBPath.c_str());
+        if (!ampB.loadModel(args.ampBPath)) {
+            std::fprintf(stderr, "Error: failed to load model '%s'\n", args.ampBPath.c_str());
+            return 1;
+        }
     }
 
     // Warm-up block: triggers the pending model swap before the audio thread starts
     {
         std::vector<float> warmup(args.bufferFrames, 0.f);
-        pipeline.process(warmup.data(), static_cast<int>(args.bufferFrames));
+        if (rackMode) {
+            for (auto& r : rack) r->chain.process(warmup.data(), static_cast<int>(args.bufferFrames));
+        } else {
+            processChain(warmup.data(), static_cast<int>(args.bufferFrames));
+        }
     }
 
-    std::fprintf(stdout, "Model loaded: %s\n", nam.modelPath().c_str());
+    if (!rackMode)
+        std::fprintf(stdout, "Model loaded: %s\n", nam.modelPath().c_str());
 
     // -------------------------------------------------------------------------
     // Audio engine
@@ -371,8 +794,11 @@ int main(int argc, char** argv)
     audioConfig.sampleRate     = args.sampleRate;
     audioConfig.bufferFrames   = args.bufferFrames;
     audioConfig.periods        = 2;
+    audioConfig.mmapAccess     = args.mmapAccess;
+    audioConfig.dither         = args.dither;
     audioConfig.inputChannel   = args.inputChannel;
-    audioConfig.outputChannels = 0x3;
+    audioConfig.numChannels    = rackMode ? args.rackChains : 1;
+    audioConfig.outputChannels = rackMode ? (1 << args.rackChains) - 1 : 0x3;
 
     hexcaster::AlsaAudioEngine engine;
     if (!engine.open(audioConfig)) {
@@ -389,25 +815,74 @@ int main(int argc, char** argv)
     if (engine.actualBufferFrames() != args.bufferFrames) {
         std::fprintf(stdout, "Note: requested %u frames, device gave %u\n",
             args.bufferFrames, engine.actualBufferFrames());
-        pipeline.prepare(static_cast<float>(engine.actualSampleRate()),
-                         static_cast<int>(engine.actualBufferFrames()));
-    }
-
-    // Audio callback: sync params -> stages each block, then process.
-    // Param reads are atomic; no locks in this path.
-    engine.setCallback([&](float* buf, int n) {
-        // Sync params -> stages each block. Reads are atomic; no locks.
-        noiseGate.setThresholdDb(params.get(hexcaster::ParamId::NoiseGateThreshold_dB));
-        noiseGate.setAttackMs   (params.get(hexcaster::ParamId::NoiseGateAttackMs));
-        noiseGate.setReleaseMs  (params.get(hexcaster::ParamId::NoiseGateReleaseMs));
-        noiseGate.setHoldMs     (params.get(hexcaster::ParamId::NoiseGateHoldMs));
-        inputGain.setGainDb     (params.get(hexcaster::ParamId::InputGain_dB));
-        eq.setGainDb      (params.get(hexcaster::ParamId::EqGain_dB));
-        eq.setSweepHz     (params.get(hexcaster::ParamId::EqSweepHz));
-        eq.setQ           (params.get(hexcaster::ParamId::EqQ));
-        masterVolume.setGainDb(params.get(hexcaster::ParamId::MasterVolume_dB));
-        pipeline.process(buf, n);
-    });
+        prepareChain(engine.actualSampleRate(), engine.actualBufferFrames());
+        if (bank.size() > 0) {
+            bank.wait();
+            bank.setMaxBlockSize(stageBlockSize());
+        }
+    }
+
+    // Sync params -> stages each block. Reads are atomic; no locks. In rack
+    // mode each chain follows its own registry.
+    auto syncParams = [](const hexcaster::ParamRegistry& p, hexcaster::NoiseGate& gate,
+                         hexcaster::GainStage& input, hexcaster::ToneEQ& toneStage,
+                         hexcaster::MidSweepEQ& eqStage, hexcaster::GainStage& master) {
+        gate.setThresholdDb(p.get(hexcaster::ParamId::NoiseGateThreshold_dB));
+        gate.setAttackMs   (p.get(hexcaster::ParamId::NoiseGateAttackMs));
+        gate.setReleaseMs  (p.get(hexcaster::ParamId::NoiseGateReleaseMs));
+        gate.setHoldMs     (p.get(hexcaster::ParamId::NoiseGateHoldMs));
+        input.setGainDb    (p.get(hexcaster::ParamId::InputGain_dB));
+        toneStage.setLowCutHz (p.get(hexcaster::ParamId::EqLowCutHz));
+        toneStage.setBassDb   (p.get(hexcaster::ParamId::EqBass_dB));
+        toneStage.setBassHz   (p.get(hexcaster::ParamId::EqBassHz));
+        toneStage.setTrebleDb (p.get(hexcaster::ParamId::EqTreble_dB));
+        toneStage.setTrebleHz (p.get(hexcaster::ParamId::EqTrebleHz));
+        toneStage.setHighCutHz(p.get(hexcaster::ParamId::EqHighCutHz));
+        eqStage.setGainDb  (p.get(hexcaster::ParamId::EqGain_dB));
+        eqStage.setSweepHz (p.get(hexcaster::ParamId::EqSweepHz));
+        eqStage.setQ       (p.get(hexcaster::ParamId::EqQ));
+        master.setGainDb   (p.get(hexcaster::ParamId::MasterVolume_dB));
+    };
+
+    // Rack mode: chain i processes channel i. The audio thread hands the
+    // chains to the scheduler's pinned workers and takes part itself;
+    // run() returns once every chain is done, before the playback write.
+    hexcaster::ChainScheduler    scheduler;
+    const hexcaster::AudioBlock* rackBlock = nullptr;   // this period's block
+    bool pinAudioThread = false;                        // to CPU 0, see below
+
+    if (rackMode) {
+        int rackCpus[hexcaster::ChainScheduler::kMaxWorkers];
+        int numWorkers = args.numRackCpus;
+        if (numWorkers < 0) {
+            // One worker per spare core, leaving CPU 0 to the audio thread,
+            // which is pinned there just before engine.run().
+            const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            numWorkers = std::min(args.rackChains, cores) - 1;
+            for (int w = 0; w < numWorkers; ++w) rackCpus[w] = w + 1;
+            pinAudioThread = true;
+        } else {
+            numWorkers = std::min(numWorkers, args.rackChains - 1);
+            std::copy(args.rackCpus, args.rackCpus + numWorkers, rackCpus);
+        }
+
+        scheduler.start(numWorkers, [&](int i) {
+            RackChain& r = *rack[static_cast<std::size_t>(i)];
+            syncParams(r.params, r.noiseGate, r.inputGain, r.tone, r.eq, r.masterVolume);
+            r.chain.process(rackBlock->channels[i], rackBlock->numSamples);
+        }, rackCpus);
+
+        engine.setBlockCallback([&](const hexcaster::AudioBlock& block) {
+            rackBlock = &block;
+            scheduler.run(block.numChannels);
+        });
+    } else {
+        engine.setCallback([&](float* buf, int n) {
+            syncParams(params, noiseGate, inputGain, tone, eq, masterVolume);
+            dualAmp.setMix(params.get(hexcaster::ParamId::AmpMix_Norm));
+            processChain(buf, n);
+        });
+    }
 
     // -------------------------------------------------------------------------
     // MIDI input (optional)
@@ -415,10 +890,27 @@ int main(int argc, char** argv)
 
     hexcaster::MidiInput midiInput;
 
+    if (bank.size() > 0) {
+        // Runs on the MIDI reader thread; selectBankModel() does no I/O.
+        midiInput.setProgramChangeHandler([&](uint8_t program) {
+            if (nam.selectBankModel(bank, program))
+                std::fprintf(stdout, "Program %u: %s\n", program, nam.modelPath().c_str());
+            else
+                std::fprintf(stderr, "Program %u: bank slot empty or still loading\n", program);
+        });
+    }
+
     if (!args.midiDevice.empty()) {
         if (!midiInput.open(args.midiDevice)) {
             std::fprintf(stderr, "Warning: %s\n  Continuing without MIDI.\n",
                          midiInput.errorMessage().c_str());
+        } else if (rackMode) {
+            // MIDI channel n + 1 drives chain n, so each player's controller
+            // sends on its own channel.
+            hexcaster::ParamRegistry* registries[hexcaster::AudioBlock::kMaxChannels];
+            for (int i = 0; i < args.rackChains; ++i)
+                registries[i] = &rack[static_cast<std::size_t>(i)]->params;
+            midiInput.start(midiMap, registries, args.rackChains);
         } else {
             midiInput.start(midiMap, params);
         }
@@ -431,11 +923,19 @@ int main(int argc, char** argv)
     std::signal(SIGINT,  handleSignal);
     std::signal(SIGTERM, handleSignal);
 
-    std::fprintf(stdout,
-        "Running -- press Ctrl+C to stop.\n"
-        "Gate: %.1f dB  |  Input gain: %.1f dB  |  Input ch: %d  |  Output: L+R%s\n",
-        args.gateThresholdDb, args.gainDb, args.inputChannel,
-        midiInput.isOpen() ? "  |  MIDI active" : "");
+    std::fprintf(stdout, "Running -- press Ctrl+C to stop.\n");
+    if (rackMode) {
+        std::fprintf(stdout,
+            "Rack: %d chains  |  Input ch: %d-%d  |  Output ch: 0-%d  |  %d worker(s)%s\n",
+            args.rackChains, args.inputChannel, args.inputChannel + args.rackChains - 1,
+            args.rackChains - 1, scheduler.numWorkers(),
+            midiInput.isOpen() ? "  |  MIDI active" : "");
+    } else {
+        std::fprintf(stdout,
+            "Gate: %.1f dB  |  Input gain: %.1f dB  |  Input ch: %d  |  Output: L+R%s\n",
+            args.gateThresholdDb, args.gainDb, args.inputChannel,
+            midiInput.isOpen() ? "  |  MIDI active" : "");
+    }
 
     std::thread watcher([&]() {
         while (!gQuit.load(std::memory_order_relaxed))
@@ -443,7 +943,13 @@ int main(int argc, char** argv)
         engine.stop();
     });
 
+    // engine.run() processes audio on this thread. Pin it after the MIDI
+    // and watcher threads have been created so they don't inherit CPU 0.
+    if (pinAudioThread && !hexcaster::pinCurrentThreadToCpu(0))
+        std::fprintf(stderr, "Warning: could not pin the audio thread to CPU 0\n");
+
     engine.run();
+    scheduler.stop();
 
     // Shutdown sequence: stop MIDI before audio is fully torn down
     midiInput.stop();
@@ -452,6 +958,11 @@ int main(int argc, char** argv)
     watcher.join();
     engine.close();
 
+    if (args.stats) {
+        printPipelineStats(pipeline, stageNames.data(),
+            1e6 * engine.actualBufferFrames() / engine.actualSampleRate());
+    }
+
     std::fprintf(stdout, "Bye.\n");
     return 0;
 }
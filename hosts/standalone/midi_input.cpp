@@ -1,6 +1,7 @@
 #include "midi_input.h"
 
 #include <alsa/asoundlib.h>
+#include <algorithm>
 #include <cstdio>
 
 namespace hexcaster {
@@ -45,10 +46,22 @@ bool MidiInput::open(const std::string& device)
 
 void MidiInput::start(MidiMap& midiMap, ParamRegistry& registry)
 {
+    registries_.fill(&registry);
     if (!handle_) return;
     running_.store(true, std::memory_order_release);
-    thread_ = std::thread([this, &midiMap, &registry]() {
-        readerLoop(midiMap, registry);
+    thread_ = std::thread([this, &midiMap]() {
+        readerLoop(midiMap);
+    });
+}
+
+void MidiInput::start(MidiMap& midiMap, ParamRegistry* const* registries, int count)
+{
+    registries_.fill(nullptr);
+    std::copy(registries, registries + std::clamp(count, 0, kMidiChannels), registries_.begin());
+    if (!handle_) return;
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this, &midiMap]() {
+        readerLoop(midiMap);
     });
 }
 
@@ -86,11 +99,15 @@ void MidiInput::close()
 //   Byte 1: cc    (controller number, 0-127)
 //   Byte 2: value (controller value, 0-127)
 //
+// MIDI Program Change message format:
+//   Byte 0: 0xCn  (status: Program Change, channel n)
+//   Byte 1: program (0-127)
+//
 // We implement "running status": if the next byte is a data byte (bit 7 = 0)
-// and the last status byte was a CC, we reuse the previous status byte.
+// and the last status byte was a CC or PC, we reuse the previous status byte.
 // ---------------------------------------------------------------------------
 
-void MidiInput::readerLoop(MidiMap& midiMap, ParamRegistry& registry)
+void MidiInput::readerLoop(MidiMap& midiMap)
 {
     // Parser state
     enum class State { WaitStatus, WaitData1, WaitData2 };
@@ -98,6 +115,7 @@ void MidiInput::readerLoop(MidiMap& midiMap, ParamRegistry& registry)
     uint8_t status     = 0;
     uint8_t data1      = 0;
     bool    isCC       = false;
+    bool    isPC       = false;
 
     uint8_t byte = 0;
 
@@ -113,27 +131,38 @@ void MidiInput::readerLoop(MidiMap& midiMap, ParamRegistry& registry)
         if (n == 0) continue;
 
         if (byte & 0x80) {
+            // Realtime messages (clock, active sensing, ...) may be
+            // interleaved anywhere and do not cancel running status.
+            if (byte >= 0xF8) continue;
+
             // Status byte -- start of a new message
             status = byte;
             isCC   = ((status & 0xF0) == 0xB0);  // CC on any channel
-            state  = isCC ? State::WaitData1 : State::WaitStatus;
+            isPC   = ((status & 0xF0) == 0xC0);  // PC on any channel
+            state  = (isCC || isPC) ? State::WaitData1 : State::WaitStatus;
         } else {
             // Data byte -- running status applies
             switch (state) {
                 case State::WaitStatus:
-                    // Unexpected data byte with no active CC status -- ignore
+                    // Unexpected data byte with no active CC/PC status -- ignore
                     break;
 
                 case State::WaitData1:
+                    if (isPC) {
+                        // Single data byte; stay in WaitData1 for running status.
+                        if (programHandler_) programHandler_(byte & 0x7F);
+                        break;
+                    }
                     data1 = byte;
                     state = State::WaitData2;
                     break;
 
                 case State::WaitData2:
                     if (isCC) {
-                        const uint8_t cc    = data1 & 0x7F;
-                        const uint8_t value = byte  & 0x7F;
-                        midiMap.dispatch(cc, value, registry);
+                        const uint8_t  cc       = data1 & 0x7F;
+                        const uint8_t  value    = byte  & 0x7F;
+                        ParamRegistry* registry = registries_[status & 0x0F];
+                        if (registry) midiMap.dispatch(cc, value, *registry);
                     }
                     // Running status: stay in WaitData1 for the next message
                     // using the same status byte.
@@ -3,7 +3,10 @@
 #include "hexcaster/midi_map.h"
 #include "hexcaster/param_registry.h"
 
+#include <array>
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <thread>
 
@@ -18,7 +21,11 @@ namespace hexcaster {
  *
  * Runs a dedicated reader thread that blocks on snd_rawmidi_read().
  * When a CC message arrives, it calls MidiMap::dispatch() which writes
- * the scaled value to ParamRegistry atomically.
+ * the scaled value to the ParamRegistry for its MIDI channel atomically
+ * (the same registry for every channel unless started with one per
+ * channel). When a Program Change
+ * arrives, it calls the program change handler (if set) on the reader
+ * thread -- used to select a NamModelBank slot.
  *
  * Thread model:
  *   - Reader thread: normal priority, blocked in snd_rawmidi_read().
@@ -26,8 +33,8 @@ namespace hexcaster {
  *   - No locks in the dispatch path.
  *
  * MIDI parsing:
- *   - Only CC messages (status 0xBn, any channel) are dispatched.
- *   - All other message types (note on/off, PC, sysex, etc.) are ignored.
+ *   - CC (status 0xBn) and Program Change (0xCn) on any channel are dispatched.
+ *   - All other message types (note on/off, sysex, etc.) are ignored.
  *   - Running status is supported.
  *
  * Usage:
@@ -54,12 +61,28 @@ public:
      */
     bool open(const std::string& device);
 
+    using ProgramChangeHandler = std::function<void(uint8_t program)>;
+
+    /**
+     * Set the callback for Program Change messages. Call before start().
+     * Runs on the reader thread: may block briefly, must not touch the
+     * audio thread's state except through RT-safe handoffs.
+     */
+    void setProgramChangeHandler(ProgramChangeHandler handler) { programHandler_ = std::move(handler); }
+
     /**
      * Start the reader thread.
      * MidiMap and ParamRegistry must outlive the MidiInput.
      */
     void start(MidiMap& midiMap, ParamRegistry& registry);
 
+    /**
+     * Start the reader thread with one registry per MIDI channel: a CC on
+     * channel n (0-based) goes to registries[n]; channels >= count are
+     * ignored. For hosts with one parameter set per player (rack mode).
+     */
+    void start(MidiMap& midiMap, ParamRegistry* const* registries, int count);
+
     /**
      * Signal the reader thread to stop and join it.
      * Blocks until the thread exits.
@@ -75,12 +98,17 @@ public:
     const std::string& errorMessage() const { return errorMsg_; }
 
 private:
-    void readerLoop(MidiMap& midiMap, ParamRegistry& registry);
+    static constexpr int kMidiChannels = 16;
+
+    void readerLoop(MidiMap& midiMap);
 
     snd_rawmidi_t*    handle_  = nullptr;
+    std::array<ParamRegistry*, kMidiChannels> registries_ = {};   // by MIDI channel
     std::thread       thread_;
     std::atomic<bool> running_{ false };
     std::string       errorMsg_;
+
+    ProgramChangeHandler programHandler_;
 };
 
 } // namespace hexcaster
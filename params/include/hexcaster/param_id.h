@@ -40,9 +40,20 @@ enum class ParamId : uint32_t {
     EqSweepHz             = 61,  // Center frequency [300, 2500] Hz
     EqQ                   = 62,  // Bandwidth (Q factor) [0.3, 3.0], default 0.8
 
+    // --- Tone EQ (post-NAM bands around the mid sweep) ---
+    EqLowCutHz            = 63,  // High-pass corner [20, 300] Hz, 20 = off
+    EqBass_dB             = 64,  // Low shelf boost/cut [-12, +12] dB, 0 = off
+    EqBassHz              = 65,  // Low shelf corner [60, 400] Hz, default 120
+    EqTreble_dB           = 66,  // High shelf boost/cut [-12, +12] dB, 0 = off
+    EqTrebleHz            = 67,  // High shelf corner [1500, 8000] Hz, default 3000
+    EqHighCutHz           = 68,  // Low-pass corner [2000, 20000] Hz, 20000 = off
+
     // --- Master Volume ---
     MasterVolume_dB       = 70,  // Final output level before power amp [-60, +24] dB
 
+    // --- Dual Amp ---
+    AmpMix_Norm           = 80,  // Blend amp A (0) -> amp B (1), default 0.5
+
     kCount              // Always last
 };
 
@@ -69,7 +80,14 @@ inline bool paramIdFromName(std::string_view name, ParamId& out)
         { "EqGain_dB",              ParamId::EqGain_dB              },
         { "EqSweepHz",              ParamId::EqSweepHz              },
         { "EqQ",                    ParamId::EqQ                    },
+        { "EqLowCutHz",             ParamId::EqLowCutHz             },
+        { "EqBass_dB",              ParamId::EqBass_dB              },
+        { "EqBassHz",               ParamId::EqBassHz               },
+        { "EqTreble_dB",            ParamId::EqTreble_dB            },
+        { "EqTrebleHz",             ParamId::EqTrebleHz             },
+        { "EqHighCutHz",            ParamId::EqHighCutHz            },
         { "MasterVolume_dB",        ParamId::MasterVolume_dB        },
+        { "AmpMix_Norm",            ParamId::AmpMix_Norm            },
     };
     for (auto& e : kTable) {
         if (e.name == name) { out = e.id; return true; }
@@ -10,6 +10,16 @@ namespace hexcaster {
  *
  * Real-time safe: no allocation, no branching on hot path.
  *
+ * Block form:
+ *   multiplyBlock() applies the same per-sample values as calling next()
+ *   once per sample, but in closed form: within a run of kLanes samples
+ *   value[j] = target + (current - target) * coeff^(j+1), with the powers
+ *   precomputed in prepare(). The lanes are independent, so the compiler
+ *   vectorizes the loop (NEON/SSE/AVX) instead of walking a serial
+ *   dependency chain. Once the remaining distance to the target falls
+ *   below kSettleEpsilon (relative) the smoother snaps to it and the rest
+ *   is a plain multiply.
+ *
  * Usage:
  *   ParamSmoother smoother;
  *   smoother.prepare(48000.f, 20.f);   // 20ms smoothing time
@@ -42,6 +52,15 @@ public:
      */
     float next();
 
+    /**
+     * buffer[i] *= next() for each sample, computed kLanes at a time.
+     * Real-time safe.
+     */
+    void multiplyBlock(float* buffer, int numSamples);
+
+    /** True once current has snapped to target. */
+    bool isSettled() const { return current_ == target_; }
+
     /**
      * Snap immediately to the target (no smoothing).
      * Use after prepare() or reset().
@@ -51,10 +70,14 @@ public:
     float getCurrentValue() const { return current_; }
     float getTargetValue()  const { return target_;  }
 
+    static constexpr int   kLanes         = 8;
+    static constexpr float kSettleEpsilon = 1e-5f;  // relative to |target|
+
 private:
     float current_  = 0.f;
     float target_   = 0.f;
     float coeff_    = 0.f;   // EMA coefficient (1 - alpha)
+    float lanePow_[kLanes] = {};  // coeff_^1 .. coeff_^kLanes
 };
 
 } // namespace hexcaster
@@ -38,9 +38,20 @@ ParamRegistry::kParamInfo = []() {
     info[idx(ParamId::EqSweepHz)]  = { 1000.f, 300.f, 2500.f };
     info[idx(ParamId::EqQ)]        = {    0.8f,  0.3f,   3.f };
 
+    // Tone EQ
+    info[idx(ParamId::EqLowCutHz)]  = {    20.f,   20.f,   300.f };
+    info[idx(ParamId::EqBass_dB)]   = {     0.f,  -12.f,    12.f };
+    info[idx(ParamId::EqBassHz)]    = {   120.f,   60.f,   400.f };
+    info[idx(ParamId::EqTreble_dB)] = {     0.f,  -12.f,    12.f };
+    info[idx(ParamId::EqTrebleHz)]  = {  3000.f, 1500.f,  8000.f };
+    info[idx(ParamId::EqHighCutHz)] = { 20000.f, 2000.f, 20000.f };
+
     // Master Volume
     info[idx(ParamId::MasterVolume_dB)] = { 0.f, -60.f, 24.f };
 
+    // Dual Amp
+    info[idx(ParamId::AmpMix_Norm)] = { 0.5f, 0.f, 1.f };
+
     return info;
 }();
 
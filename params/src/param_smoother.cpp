@@ -1,4 +1,5 @@
 #include "hexcaster/param_smoother.h"
+#include <algorithm>
 #include <cmath>
 
 namespace hexcaster {
@@ -14,6 +15,12 @@ void ParamSmoother::prepare(float sampleRate, float smoothingMs)
     } else {
         coeff_ = 0.f; // instant snap
     }
+
+    double p = 1.0;
+    for (int j = 0; j < kLanes; ++j) {
+        p *= coeff_;
+        lanePow_[j] = static_cast<float>(p);
+    }
 }
 
 void ParamSmoother::setTarget(float target)
@@ -27,6 +34,35 @@ float ParamSmoother::next()
     return current_;
 }
 
+void ParamSmoother::multiplyBlock(float* buffer, int numSamples)
+{
+    const float target = target_;
+    const float settle = kSettleEpsilon * std::fabs(target);
+
+    // Distance still to go; each run of kLanes samples shrinks it by coeff^kLanes.
+    float d = current_ - target;
+    int   i = 0;
+
+    while (i < numSamples && std::fabs(d) > settle) {
+        const int len = std::min(kLanes, numSamples - i);
+        float* x = buffer + i;
+        for (int j = 0; j < len; ++j) {
+            x[j] *= target + d * lanePow_[j];
+        }
+        d *= lanePow_[len - 1];
+        i += len;
+    }
+
+    if (std::fabs(d) <= settle) {
+        d = 0.f;
+        for (; i < numSamples; ++i) {
+            buffer[i] *= target;
+        }
+    }
+
+    current_ = target + d;
+}
+
 void ParamSmoother::snap(float value)
 {
     current_ = value;
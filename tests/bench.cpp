@@ -0,0 +1,583 @@
+#include "hexcaster/eq.h"
+#include "hexcaster/gain_stage.h"
+#include "hexcaster/nam_stage.h"
+#include "hexcaster/noise_gate.h"
+#include "hexcaster/pipeline.h"
+#include "hexcaster/sample_convert.h"
+#include "hexcaster/static_pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+// hexcaster_bench -- times each stage's process() and the full chain over a
+// matrix of block sizes and sample rates, and prints the results as JSON.
+//
+// Not a test: nothing here asserts on timing. Run it on the target (Pi 5)
+// before and after a change and diff the numbers.
+
+#ifndef HEXCASTER_BENCH_MODELS_DIR
+#define HEXCASTER_BENCH_MODELS_DIR "models"
+#endif
+
+#ifndef HEXCASTER_VERSION
+#define HEXCASTER_VERSION "unknown"
+#endif
+
+// ---------------------------------------------------------------------------
+// CLI argument parsing
+// ---------------------------------------------------------------------------
+
+struct Args {
+    std::string      modelsDir  = HEXCASTER_BENCH_MODELS_DIR;
+    std::string      outputPath;                 // empty = stdout
+    std::vector<int> blockSizes  = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    std::vector<int> sampleRates = { 44100, 48000, 96000 };
+    std::vector<std::string> stages;             // empty = all
+    double           seconds    = 2.0;           // audio rendered per case
+    int              minBlocks  = 64;            // ...but at least this many blocks
+    bool             help       = false;
+};
+
+static const char* const kAllStages[] = {
+    "gain", "noise_gate", "mid_sweep_eq", "parametric_eq", "nam_wavenet", "nam_lstm",
+    "pipeline", "static_pipeline", "gate_eq_4x_mono", "gate_eq_4ch",
+    "convert_s16", "convert_s16_dither", "convert_s32", "convert_s24_3",
+};
+
+static void printUsage(const char* prog)
+{
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "\n"
+        "Times GainStage, NoiseGate, MidSweepEQ, ParametricEQ, NamStage (tiny WaveNet and LSTM\n"
+        "models) and the full chain (Pipeline and StaticPipeline) over a matrix of block sizes and sample\n"
+        "rates, gate + mid EQ on four channels (four mono chains vs one planar chain), and\n"
+        "the ALSA host's stereo S16 (plain and dithered)/S32/S24_3LE capture + playback\n"
+        "conversion.\n"
+        "Results are written as JSON.\n"
+        "\n"
+        "Options:\n"
+        "  --models <dir>          Directory holding tiny_wavenet.nam / tiny_lstm.nam\n"
+        "                          [default: %s]\n"
+        "  --out <path>            Write JSON here instead of stdout\n"
+        "  --stage <name>          Only run this case (repeatable): gain, noise_gate,\n"
+        "                          mid_sweep_eq, parametric_eq, nam_wavenet, nam_lstm,\n"
+        "                          pipeline, static_pipeline, gate_eq_4x_mono,\n"
+        "                          gate_eq_4ch, convert_s16, convert_s16_dither,\n"
+        "                          convert_s32, convert_s24_3\n"
+        "  --block-sizes <list>    Comma-separated block sizes  [default: 16..4096]\n"
+        "  --sample-rates <list>   Comma-separated rates in Hz  [default: 44100,48000,96000]\n"
+        "  --seconds <s>           Audio rendered per case  [default: 2.0]\n"
+        "  --min-blocks <N>        Minimum blocks per case  [default: 64]\n"
+        "  --help                  Show this help and exit\n"
+        "\n"
+        "Example:\n"
+        "  %s --stage nam_wavenet --block-sizes 64,128 --out before.json\n",
+        prog, HEXCASTER_BENCH_MODELS_DIR, prog);
+}
+
+static bool parseIntList(const char* s, std::vector<int>& out)
+{
+    out.clear();
+    while (*s) {
+        char* end = nullptr;
+        const long v = std::strtol(s, &end, 10);
+        if (end == s || v <= 0) return false;
+        out.push_back(static_cast<int>(v));
+        s = (*end == ',') ? end + 1 : end;
+    }
+    return !out.empty();
+}
+
+static bool parseArgs(int argc, char** argv, Args& args)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* key = argv[i];
+        auto nextArg = [&]() -> const char* {
+            if (i + 1 < argc) return argv[++i];
+            std::fprintf(stderr, "Error: %s requires an argument\n", key);
+            return nullptr;
+        };
+
+        if (std::strcmp(key, "--help") == 0 || std::strcmp(key, "-h") == 0) {
+            args.help = true;
+            return true;
+        }
+
+        if (std::strcmp(key, "--models") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.modelsDir = v;
+        } else if (std::strcmp(key, "--out") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.outputPath = v;
+        } else if (std::strcmp(key, "--stage") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            const bool known = std::any_of(std::begin(kAllStages), std::end(kAllStages),
+                [v](const char* s) { return std::strcmp(s, v) == 0; });
+            if (!known) {
+                std::fprintf(stderr, "Error: unknown stage '%s'\n", v);
+                return false;
+            }
+            args.stages.emplace_back(v);
+        } else if (std::strcmp(key, "--block-sizes") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            if (!parseIntList(v, args.blockSizes)) {
+                std::fprintf(stderr, "Error: bad --block-sizes list '%s'\n", v);
+                return false;
+            }
+        } else if (std::strcmp(key, "--sample-rates") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            if (!parseIntList(v, args.sampleRates)) {
+                std::fprintf(stderr, "Error: bad --sample-rates list '%s'\n", v);
+                return false;
+            }
+        } else if (std::strcmp(key, "--seconds") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.seconds = std::atof(v);
+        } else if (std::strcmp(key, "--min-blocks") == 0) {
+            const char* v = nextArg(); if (!v) return false;
+            args.minBlocks = std::max(std::atoi(v), 1);
+        } else {
+            std::fprintf(stderr, "Unknown option: %s\n", key);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Test signal
+// ---------------------------------------------------------------------------
+
+// Deterministic guitar-like DI: decaying plucked notes with a little noise,
+// separated by near-silent gaps so the gate sees opening, holding and
+// closing as well as steady state.
+static std::vector<float> makeSignal(int sampleRate, std::size_t length)
+{
+    std::vector<float> sig(length);
+    uint32_t rng = 0x12345678u;
+
+    const std::size_t noteLen = static_cast<std::size_t>(sampleRate) * 3 / 4;
+    const std::size_t gapLen  = static_cast<std::size_t>(sampleRate) / 4;
+    const float freqs[] = { 82.41f, 110.f, 146.83f, 196.f, 246.94f, 329.63f };
+
+    for (std::size_t i = 0; i < length; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        const float noise = (static_cast<float>(rng >> 8) / 16777216.f - 0.5f) * 2e-4f;
+
+        const std::size_t cycle = i % (noteLen + gapLen);
+        const std::size_t note  = (i / (noteLen + gapLen)) % std::size(freqs);
+        float s = 0.f;
+        if (cycle < noteLen) {
+            const float t   = static_cast<float>(cycle) / static_cast<float>(sampleRate);
+            const float w   = 2.f * 3.14159265f * freqs[note] * t;
+            const float env = 0.5f * std::exp(-3.f * t);
+            s = env * (std::sin(w) + 0.4f * std::sin(2.f * w) + 0.2f * std::sin(3.f * w));
+        }
+        sig[i] = s + noise;
+    }
+    return sig;
+}
+
+// ---------------------------------------------------------------------------
+// Timing
+// ---------------------------------------------------------------------------
+
+struct Result {
+    std::string stage;
+    int         sampleRate = 0;
+    int         blockSize  = 0;
+    int         blocks     = 0;
+    double      nsPerSample      = 0.0;
+    double      realtimeFactor   = 0.0; // audio time / processing time
+    double      budgetUs         = 0.0; // block duration at this rate
+    double      p50Us = 0.0, p99Us = 0.0, maxUs = 0.0;
+};
+
+using ProcessFn = std::function<void(float*, int)>;
+
+static Result timeCase(const std::string& stage, int sampleRate, int blockSize,
+                       const std::vector<float>& signal, int blocks, const ProcessFn& process)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<float>  buf(static_cast<std::size_t>(blockSize));
+    std::vector<double> blockNs(static_cast<std::size_t>(blocks));
+
+    // Warm caches, branch predictors and any lazily-sized model buffers.
+    const int warmupBlocks = std::min(blocks, 8);
+    for (int b = 0; b < warmupBlocks; ++b) {
+        std::memcpy(buf.data(), signal.data() + static_cast<std::size_t>(b) * blockSize,
+                    sizeof(float) * static_cast<std::size_t>(blockSize));
+        process(buf.data(), blockSize);
+    }
+
+    double totalNs = 0.0;
+    for (int b = 0; b < blocks; ++b) {
+        std::memcpy(buf.data(), signal.data() + static_cast<std::size_t>(b) * blockSize,
+                    sizeof(float) * static_cast<std::size_t>(blockSize));
+
+        const auto t0 = Clock::now();
+        process(buf.data(), blockSize);
+        const auto t1 = Clock::now();
+
+        const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        blockNs[static_cast<std::size_t>(b)] = ns;
+        totalNs += ns;
+    }
+
+    std::sort(blockNs.begin(), blockNs.end());
+    auto percentile = [&](double p) {
+        const std::size_t idx = static_cast<std::size_t>(p * static_cast<double>(blockNs.size() - 1) + 0.5);
+        return blockNs[idx] * 1e-3;
+    };
+
+    const double samples      = static_cast<double>(blocks) * blockSize;
+    const double audioSeconds = samples / sampleRate;
+
+    Result r;
+    r.stage          = stage;
+    r.sampleRate     = sampleRate;
+    r.blockSize      = blockSize;
+    r.blocks         = blocks;
+    r.nsPerSample    = totalNs / samples;
+    r.realtimeFactor = totalNs > 0.0 ? audioSeconds / (totalNs * 1e-9) : 0.0;
+    r.budgetUs       = 1e6 * blockSize / sampleRate;
+    r.p50Us          = percentile(0.50);
+    r.p99Us          = percentile(0.99);
+    r.maxUs          = blockNs.back() * 1e-3;
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// Cases
+// ---------------------------------------------------------------------------
+
+// The standalone host's chain as a StaticPipeline, with its stages.
+struct StaticChain {
+    hexcaster::NoiseGate  gate;
+    hexcaster::GainStage  input;
+    hexcaster::NamStage   nam;
+    hexcaster::ToneEQ     tone;
+    hexcaster::MidSweepEQ eq;
+    hexcaster::GainStage  master;
+
+    hexcaster::StaticPipeline<hexcaster::NoiseGate, hexcaster::GainStage, hexcaster::NamStage,
+                              hexcaster::ToneEQ, hexcaster::MidSweepEQ, hexcaster::GainStage>
+        pipeline{ gate, input, nam, tone, eq, master };
+};
+
+// A prepared stage (or chain) plus the objects it keeps alive.
+struct Case {
+    std::vector<std::unique_ptr<hexcaster::ProcessorStage>> stages;
+    std::unique_ptr<hexcaster::Pipeline>                    pipeline;
+    std::unique_ptr<StaticChain>                            staticChain;
+    ProcessFn                                               process;
+};
+
+// Load a model into a prepared NamStage and run one block so the pending
+// model is swapped in before timing starts.
+static bool loadNam(hexcaster::NamStage& nam, const std::string& path, int blockSize)
+{
+    if (!nam.loadModel(path)) return false;
+    std::vector<float> silence(static_cast<std::size_t>(blockSize), 0.f);
+    nam.process(silence.data(), blockSize);
+    return nam.hasModel();
+}
+
+static bool makeCase(const std::string& name, const Args& args,
+                     float sampleRate, int blockSize, Case& c)
+{
+    const std::string wavenet = args.modelsDir + "/tiny_wavenet.nam";
+    const std::string lstm    = args.modelsDir + "/tiny_lstm.nam";
+
+    if (name == "gain") {
+        auto gain = std::make_unique<hexcaster::GainStage>();
+        gain->setGainDb(6.f);   // non-unity so the multiply is actually timed
+        gain->prepare(sampleRate, blockSize);
+        c.process = [g = gain.get()](float* b, int n) { g->process(b, n); };
+        c.stages.push_back(std::move(gain));
+    } else if (name == "noise_gate") {
+        auto gate = std::make_unique<hexcaster::NoiseGate>();
+        gate->setThresholdDb(-50.f);
+        gate->prepare(sampleRate, blockSize);
+        c.process = [g = gate.get()](float* b, int n) { g->process(b, n); };
+        c.stages.push_back(std::move(gate));
+    } else if (name == "mid_sweep_eq") {
+        auto eq = std::make_unique<hexcaster::MidSweepEQ>();
+        eq->setGainDb(6.f);
+        eq->setSweepHz(800.f);
+        eq->prepare(sampleRate, blockSize);
+        c.process = [e = eq.get()](float* b, int n) { e->process(b, n); };
+        c.stages.push_back(std::move(eq));
+    } else if (name == "parametric_eq") {
+        // Every band active: the cascade's worst case.
+        auto eq = std::make_unique<hexcaster::ParametricEQ>();
+        eq->setBand(0, hexcaster::BiquadType::HighPass, 80.f, 0.f, 0.707f);
+        eq->setBand(1, hexcaster::BiquadType::LowShelf, 150.f, 2.f, 0.707f);
+        for (int k = 2; k < hexcaster::ParametricEQ::kMaxBands - 1; ++k) {
+            eq->setBand(k, hexcaster::BiquadType::Peak, 200.f * static_cast<float>(k), 3.f, 1.f);
+        }
+        eq->setBand(hexcaster::ParametricEQ::kMaxBands - 1, hexcaster::BiquadType::LowPass,
+                    7000.f, 0.f, 0.707f);
+        eq->prepare(sampleRate, blockSize);
+        c.process = [e = eq.get()](float* b, int n) { e->process(b, n); };
+        c.stages.push_back(std::move(eq));
+    } else if (name == "nam_wavenet" || name == "nam_lstm") {
+        auto nam = std::make_unique<hexcaster::NamStage>();
+        nam->prepare(sampleRate, blockSize);
+        const std::string& path = (name == "nam_wavenet") ? wavenet : lstm;
+        if (!loadNam(*nam, path, blockSize)) {
+            std::fprintf(stderr, "Warning: could not load '%s', skipping %s\n",
+                         path.c_str(), name.c_str());
+            return false;
+        }
+        c.process = [s = nam.get()](float* b, int n) { s->process(b, n); };
+        c.stages.push_back(std::move(nam));
+    } else if (name == "pipeline") {
+        // Same chain and stage order as the standalone host.
+        auto gate   = std::make_unique<hexcaster::NoiseGate>();
+        auto input  = std::make_unique<hexcaster::GainStage>();
+        auto nam    = std::make_unique<hexcaster::NamStage>();
+        auto eq     = std::make_unique<hexcaster::MidSweepEQ>();
+        auto master = std::make_unique<hexcaster::GainStage>();
+
+        gate->setThresholdDb(-50.f);
+        input->setGainDb(6.f);
+        eq->setGainDb(3.f);
+        master->setGainDb(-6.f);
+
+        c.pipeline = std::make_unique<hexcaster::Pipeline>();
+        c.pipeline->addStage(gate.get());
+        c.pipeline->addStage(input.get());
+        c.pipeline->addStage(nam.get());
+        c.pipeline->addStage(eq.get());
+        c.pipeline->addStage(master.get());
+        c.pipeline->prepare(sampleRate, blockSize);
+
+        if (!loadNam(*nam, wavenet, blockSize)) {
+            std::fprintf(stderr, "Warning: could not load '%s', skipping pipeline\n",
+                         wavenet.c_str());
+            return false;
+        }
+        c.process = [p = c.pipeline.get()](float* b, int n) { p->process(b, n); };
+
+        c.stages.push_back(std::move(gate));
+        c.stages.push_back(std::move(input));
+        c.stages.push_back(std::move(nam));
+        c.stages.push_back(std::move(eq));
+        c.stages.push_back(std::move(master));
+    } else if (name == "static_pipeline") {
+        // Same chain and settings as "pipeline", fused at compile time.
+        auto chain = std::make_unique<StaticChain>();
+        chain->gate.setThresholdDb(-50.f);
+        chain->input.setGainDb(6.f);
+        chain->eq.setGainDb(3.f);
+        chain->master.setGainDb(-6.f);
+        chain->pipeline.prepare(sampleRate, blockSize);
+
+        if (!loadNam(chain->nam, wavenet, blockSize)) {
+            std::fprintf(stderr, "Warning: could not load '%s', skipping static_pipeline\n",
+                         wavenet.c_str());
+            return false;
+        }
+        c.process = [p = &chain->pipeline](float* b, int n) { p->process(b, n); };
+        c.staticChain = std::move(chain);
+    } else if (name == "gate_eq_4x_mono" || name == "gate_eq_4ch") {
+        // The block copied to four channels, then gate + mid EQ: one stage
+        // pair per channel (mono) or one pair with a channel per lane.
+        // ns/sample is per frame of four channels.
+        constexpr int kChannels = 4;
+        const bool    planar    = name == "gate_eq_4ch";
+        const int     pairs     = planar ? 1 : kChannels;
+
+        std::vector<hexcaster::NoiseGate*>  gates;
+        std::vector<hexcaster::MidSweepEQ*> eqs;
+        for (int i = 0; i < pairs; ++i) {
+            auto gate = std::make_unique<hexcaster::NoiseGate>();
+            auto eq   = std::make_unique<hexcaster::MidSweepEQ>();
+            gate->setThresholdDb(-50.f);
+            eq->setGainDb(6.f);
+            eq->setSweepHz(800.f);
+            gate->prepare(sampleRate, blockSize);
+            eq->prepare(sampleRate, blockSize);
+            gates.push_back(gate.get());
+            eqs.push_back(eq.get());
+            c.stages.push_back(std::move(gate));
+            c.stages.push_back(std::move(eq));
+        }
+
+        c.process = [gates, eqs, planar,
+                     planes = std::vector<float>(static_cast<std::size_t>(blockSize) * kChannels)]
+                    (float* b, int n) mutable {
+            hexcaster::AudioBlock block;
+            block.numChannels = kChannels;
+            block.numSamples  = n;
+            for (int ch = 0; ch < kChannels; ++ch) {
+                block.channels[ch] = planes.data() + static_cast<std::size_t>(ch) * n;
+                std::memcpy(block.channels[ch], b, sizeof(float) * static_cast<std::size_t>(n));
+            }
+            if (planar) {
+                gates[0]->processChannels(block);
+                eqs[0]->processChannels(block);
+            } else {
+                for (int ch = 0; ch < kChannels; ++ch) {
+                    gates[static_cast<std::size_t>(ch)]->process(block.channels[ch], n);
+                    eqs[static_cast<std::size_t>(ch)]->process(block.channels[ch], n);
+                }
+            }
+            std::memcpy(b, block.channels[0], sizeof(float) * static_cast<std::size_t>(n));
+        };
+    } else if (name == "convert_s16" || name == "convert_s16_dither"
+               || name == "convert_s32" || name == "convert_s24_3") {
+        // The standalone host's per-period conversions: the block played to
+        // both channels of a stereo interleaved buffer (convert_s16_dither
+        // with TPDF dither, the host's 16-bit default), then captured back
+        // into two planes. ns/sample is per stereo frame.
+        constexpr int kChannels = 2;
+        const bool dither = name == "convert_s16_dither";
+        const hexcaster::SampleFormat fmt = name == "convert_s32"   ? hexcaster::SampleFormat::Int32
+                                          : name == "convert_s24_3" ? hexcaster::SampleFormat::Int24Packed
+                                                                    : hexcaster::SampleFormat::Int16;
+        auto capture  = std::make_shared<hexcaster::CaptureConverter>();
+        auto playback = std::make_shared<std::vector<hexcaster::PlaybackConverter>>(kChannels);
+        capture->setUp(fmt, kChannels);
+        for (int ch = 0; ch < kChannels; ++ch) {
+            (*playback)[static_cast<std::size_t>(ch)].setUp(fmt, kChannels, dither,
+                                                            static_cast<uint32_t>(ch + 1));
+        }
+
+        const std::size_t samples = static_cast<std::size_t>(blockSize) * kChannels;
+        c.process = [capture, playback, fmt,
+                     raw    = std::vector<uint8_t>(samples * static_cast<std::size_t>(hexcaster::bytesPerSample(fmt))),
+                     planes = std::vector<float>(samples)]
+                    (float* b, int n) mutable {
+            const std::size_t bytes = static_cast<std::size_t>(hexcaster::bytesPerSample(fmt));
+            for (int ch = 0; ch < kChannels; ++ch) {
+                const hexcaster::RawChannel rc{ raw.data() + static_cast<std::size_t>(ch) * bytes, kChannels };
+                float* plane = planes.data() + static_cast<std::size_t>(ch) * n;
+                (*playback)[static_cast<std::size_t>(ch)].convert(b, rc, n);
+                capture->convert(rc, plane, n);
+            }
+            std::memcpy(b, planes.data(), sizeof(float) * static_cast<std::size_t>(n));
+        };
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// JSON output
+// ---------------------------------------------------------------------------
+
+static const char* compilerName()
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+static const char* archName()
+{
+#if defined(__aarch64__)
+    return "aarch64";
+#elif defined(__arm__)
+    return "arm";
+#elif defined(__x86_64__)
+    return "x86_64";
+#else
+    return "unknown";
+#endif
+}
+
+static void writeJson(std::FILE* f, const Args& args, const std::vector<Result>& results)
+{
+    std::fprintf(f, "{\n");
+    std::fprintf(f, "  \"benchmark\": \"hexcaster_bench\",\n");
+    std::fprintf(f, "  \"version\": \"%s\",\n", HEXCASTER_VERSION);
+    std::fprintf(f, "  \"compiler\": \"%s\",\n", compilerName());
+    std::fprintf(f, "  \"arch\": \"%s\",\n", archName());
+    std::fprintf(f, "  \"seconds_per_case\": %.3f,\n", args.seconds);
+    std::fprintf(f, "  \"results\": [");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(f,
+            "%s\n    {\"stage\": \"%s\", \"sample_rate\": %d, \"block_size\": %d, "
+            "\"blocks\": %d, \"ns_per_sample\": %.3f, \"realtime_factor\": %.2f, "
+            "\"block_us\": {\"budget\": %.2f, \"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f}}",
+            i == 0 ? "" : ",",
+            r.stage.c_str(), r.sampleRate, r.blockSize, r.blocks,
+            r.nsPerSample, r.realtimeFactor,
+            r.budgetUs, r.p50Us, r.p99Us, r.maxUs);
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    Args args;
+    if (!parseArgs(argc, argv, args)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (args.help) { printUsage(argv[0]); return 0; }
+
+    std::vector<std::string> stages = args.stages;
+    if (stages.empty())
+        stages.assign(std::begin(kAllStages), std::end(kAllStages));
+
+    std::vector<Result> results;
+
+    for (const int sr : args.sampleRates) {
+        for (const int bs : args.blockSizes) {
+            const int blocks = std::max(args.minBlocks,
+                static_cast<int>(std::ceil(args.seconds * sr / bs)));
+            const std::vector<float> signal =
+                makeSignal(sr, static_cast<std::size_t>(blocks) * static_cast<std::size_t>(bs));
+
+            for (const std::string& name : stages) {
+                Case c;
+                if (!makeCase(name, args, static_cast<float>(sr), bs, c))
+                    continue;
+
+                results.push_back(timeCase(name, sr, bs, signal, blocks, c.process));
+
+                const Result& r = results.back();
+                std::fprintf(stderr, "%-15s %6d Hz %5d  %9.2f ns/sample  %8.1fx RT  p99 %9.2f us\n",
+                             name.c_str(), sr, bs, r.nsPerSample, r.realtimeFactor, r.p99Us);
+            }
+        }
+    }
+
+    std::FILE* out = stdout;
+    if (!args.outputPath.empty()) {
+        out = std::fopen(args.outputPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Error: cannot open '%s' for writing\n", args.outputPath.c_str());
+            return 1;
+        }
+    }
+    writeJson(out, args, results);
+    if (out != stdout) std::fclose(out);
+
+    return 0;
+}
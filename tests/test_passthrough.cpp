@@ -1,22 +1,38 @@
 #include "hexcaster/pipeline.h"
+#include "hexcaster/bloom_controller.h"
+#include "hexcaster/chain_scheduler.h"
+#include "hexcaster/dual_amp_stage.h"
+#include "hexcaster/envelope.h"
+#include "hexcaster/eq.h"
 #include "hexcaster/gain_stage.h"
+#include "hexcaster/nam_model.h"
+#include "hexcaster/nam_model_bank.h"
+#include "hexcaster/nam_stage.h"
+#include "hexcaster/noise_gate.h"
 #include "hexcaster/param_registry.h"
+#include "hexcaster/param_smoother.h"
+#include "hexcaster/sample_convert.h"
+#include "hexcaster/static_pipeline.h"
+#include "parallel_renderer.h"
+#include "test_util.h"
+#include "wav_file.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cmath>
 #include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
-// Simple assertion helper -- no external test framework.
-static int gFailures = 0;
-
-#define CHECK(expr, msg)                                                \
-    do {                                                                \
-        if (!(expr)) {                                                  \
-            std::fprintf(stderr, "FAIL [%s:%d]: %s\n",                 \
-                         __FILE__, __LINE__, msg);                      \
-            ++gFailures;                                                \
-        }                                                               \
-    } while (0)
+#ifndef HEXCASTER_TEST_MODELS_DIR
+#define HEXCASTER_TEST_MODELS_DIR "models"
+#endif
 
 // ----------------------------------------------------------------------------
 // Test: Unity gain passthrough
@@ -90,6 +106,53 @@ static void testGainScaling()
     std::printf("testGainScaling:       %s\n", gFailures == 0 ? "PASS" : "FAIL");
 }
 
+// ----------------------------------------------------------------------------
+// Test: Block gain ramp
+//   ParamSmoother::multiplyBlock must track next() sample for sample, then
+//   settle exactly on the target; a settled unity GainStage leaves the
+//   buffer bit-identical.
+// ----------------------------------------------------------------------------
+static void testGainRamp()
+{
+    static constexpr int   kBlockSize  = 37;   // not a multiple of the lane count
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr float kTolerance  = 1e-5f;
+
+    hexcaster::ParamSmoother block, serial;
+    block.prepare(kSampleRate, 10.f);
+    serial.prepare(kSampleRate, 10.f);
+    block.snap(0.25f);
+    serial.snap(0.25f);
+    block.setTarget(2.f);
+    serial.setTarget(2.f);
+
+    bool matches = true;
+    for (int b = 0; b < 20; ++b) {
+        float buffer[kBlockSize];
+        for (int i = 0; i < kBlockSize; ++i) buffer[i] = 1.f;
+        block.multiplyBlock(buffer, kBlockSize);
+        for (int i = 0; i < kBlockSize; ++i) {
+            matches = matches && std::fabs(buffer[i] - serial.next()) < kTolerance;
+        }
+    }
+    CHECK(matches, "multiplyBlock() ramp differs from per-sample next()");
+
+    for (int b = 0; b < 200 && !block.isSettled(); ++b) {
+        float buffer[kBlockSize] = {};
+        block.multiplyBlock(buffer, kBlockSize);
+    }
+    CHECK(block.isSettled() && block.getCurrentValue() == 2.f, "Smoother never settled on target");
+
+    hexcaster::GainStage unity;
+    unity.prepare(kSampleRate, kBlockSize);
+    float buffer[kBlockSize], reference[kBlockSize];
+    for (int i = 0; i < kBlockSize; ++i) buffer[i] = reference[i] = 0.1f * static_cast<float>(i) - 1.3f;
+    unity.process(buffer, kBlockSize);
+    CHECK(std::memcmp(buffer, reference, sizeof(buffer)) == 0, "Settled unity gain modified the buffer");
+
+    std::printf("testGainRamp:          %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
 // ----------------------------------------------------------------------------
 // Test: ParamRegistry stores and retrieves values
 // ----------------------------------------------------------------------------
@@ -114,6 +177,1580 @@ static void testParamRegistry()
     std::printf("testParamRegistry:     %s\n", gFailures == 0 ? "PASS" : "FAIL");
 }
 
+// ----------------------------------------------------------------------------
+// Test: chunk-parallel render matches a serial one
+//   Plucks separated by silence, so the gate opens and closes, rendered
+//   through the WaveNet chain with --jobs 1 and with 3 jobs on half-second
+//   chunks. A pluck decays across the first chunk boundary (gate release)
+//   and one starts just before the second (gate attack). The requested
+//   pre-roll is 0: it must be raised to the model's minimum.
+// ----------------------------------------------------------------------------
+static void testParallelRender()
+{
+    static constexpr unsigned kSampleRate    = 48000;
+    static constexpr int      kFrames        = 3 * kSampleRate;
+    static constexpr int64_t  kChunk         = kSampleRate / 2;
+    static constexpr float    kTolerance     = 1e-3f;   // -60 dBFS
+    static constexpr float    kTailTolerance = 1e-5f;   // -100 dBFS
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string inPath     = (dir / "hexcaster_test_render_in.f32").string();
+    const std::string serialPath = (dir / "hexcaster_test_render_serial.f32").string();
+    const std::string chunkPath  = (dir / "hexcaster_test_render_chunks.f32").string();
+
+    // Decaying 196 Hz plucks (amplitude 0.5, time constant tau seconds).
+    auto plucks = [&](std::initializer_list<float> onsets, float tau) {
+        std::vector<float> input(kFrames, 0.f);
+        for (const float onset : onsets) {
+            const int start = static_cast<int>(onset * kSampleRate);
+            for (int i = start; i < kFrames; ++i) {
+                const float t = static_cast<float>(i - start) / kSampleRate;
+                input[i] += 0.5f * std::exp(-t / tau) * std::sin(kTwoPi * 196.f * t);
+            }
+        }
+        return input;
+    };
+
+    hexcaster::RenderChain::Settings settings;
+    settings.modelPath       = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_wavenet.nam";
+    settings.gainDb          = 6.f;
+    settings.gateThresholdDb = -40.f;
+    settings.eqGainDb        = 6.f;
+    settings.masterVolumeDb  = -3.f;
+
+    // preRollFrames 0 is below any chain's minimum, so the chunked render
+    // runs on exactly the floor minPreRollFrames() computes.
+    auto render = [&](const std::string& outPath, int jobs, int blockSize,
+                      hexcaster::ParallelRenderer& renderer) {
+        hexcaster::WavWriter writer;
+        hexcaster::ParallelRenderer::Options options;
+        options.jobs          = jobs;
+        options.chunkFrames   = kChunk;
+        options.preRollFrames = 0;
+        options.blockSize     = blockSize;
+        options.rawSampleRate = kSampleRate;
+        return writer.open(outPath, kSampleRate, hexcaster::WavWriter::Format::Float32)
+            && renderer.render(inPath, writer, settings, options) && writer.close();
+    };
+    auto readAll = [&](const std::string& path) {
+        hexcaster::WavReader reader;
+        std::vector<float>   out(kFrames, 0.f);
+        const int n = reader.open(path, kSampleRate) ? reader.read(out.data(), kFrames, 0) : 0;
+        out.resize(static_cast<std::size_t>(n));
+        return out;
+    };
+
+    // Render input serially and in 0.5 s chunks on 3 jobs; returns the
+    // serial output and the largest difference between the two.
+    hexcaster::ParallelRenderer chunked;
+    auto renderBoth = [&](const std::vector<float>& input, float& maxDiff, int blockSize = 64) {
+        std::FILE* f = std::fopen(inPath.c_str(), "wb");
+        CHECK(f && std::fwrite(input.data(), sizeof(float), input.size(), f) == input.size(),
+              "Failed to write render test input");
+        if (f) std::fclose(f);
+
+        hexcaster::ParallelRenderer serial;
+        CHECK(render(serialPath, 1, blockSize, serial), "Serial render failed");
+        CHECK(render(chunkPath, 3, blockSize, chunked), "Chunk-parallel render failed");
+        CHECK(chunked.chunksRendered() == kFrames / kChunk, "Unexpected chunk count");
+
+        const std::vector<float> a = readAll(serialPath);
+        const std::vector<float> b = readAll(chunkPath);
+        CHECK(a.size() == static_cast<std::size_t>(kFrames) && b.size() == a.size(),
+              "Rendered files have the wrong length");
+        maxDiff = 0.f;
+        for (std::size_t i = 0; i < std::min(a.size(), b.size()); ++i)
+            maxDiff = std::max(maxDiff, std::fabs(a[i] - b[i]));
+        return a;
+    };
+    auto peakOf = [](const std::vector<float>& x, std::size_t from, std::size_t to) {
+        float peak = 0.f;
+        for (std::size_t i = from; i < std::min(to, x.size()); ++i) peak = std::max(peak, std::fabs(x[i]));
+        return peak;
+    };
+
+    // Pluck onsets in seconds; 0.30 rings out over the 0.5 s boundary,
+    // 0.98 opens the gate 20 ms before the 1.0 s one.
+    float maxDiff = 0.f;
+    std::vector<float> out = renderBoth(plucks({ 0.05f, 0.30f, 0.98f, 1.70f, 2.40f }, 0.06f), maxDiff);
+    CHECK(peakOf(out, 0, out.size()) > 0.01f, "Render test output is silent");
+    CHECK(maxDiff < kTolerance, "Chunk-parallel render differs from the serial render");
+
+    const int64_t minPreRoll = hexcaster::RenderChain::minPreRollFrames(settings, static_cast<float>(kSampleRate));
+    const int field = hexcaster::NamModel::receptiveField(settings.modelPath);
+    CHECK(field == 1 + 2 * (2 * 1023), "Wrong receptive field for tiny_wavenet (2 x kernel 3, dilations 1..512)");
+    CHECK(hexcaster::NamModel::receptiveField(
+              std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_lstm.nam") == 0,
+          "An LSTM has no finite receptive field");
+    CHECK(minPreRoll > field, "Minimum pre-roll does not cover the receptive field");
+    CHECK(chunked.preRollFramesUsed() == minPreRoll,
+          "A zero pre-roll was not raised to the chain's minimum");
+
+    // A slow pluck from 0.20 s falls below the -40 dB threshold around
+    // 1.30 s; after the 50 ms hold the gate is ~150 ms into its closing
+    // ramp at the 1.5 s boundary. A chain whose warm-up starts after the
+    // threshold crossing comes up closed there, so the tail only matches
+    // if the floor reaches back over hold + ramp + envelope decay.
+    out = renderBoth(plucks({ 0.20f }, 0.28f), maxDiff);
+    CHECK(peakOf(out, kSampleRate * 3 / 2, kSampleRate * 3 / 2 + kSampleRate / 20) > 10.f * kTailTolerance,
+          "Release-tail test has no signal at the 1.5 s boundary");
+    CHECK(maxDiff < kTailTolerance, "Chunk-parallel render differs in the gate's release tail");
+
+    // A block size that doesn't divide the renderer's disk reads: chunks
+    // must still start on the serial render's block grid.
+    out = renderBoth(plucks({ 0.20f }, 0.28f), maxDiff, 100);
+    CHECK(maxDiff < kTailTolerance, "Chunk-parallel render differs with a block size off the read grid");
+
+    std::filesystem::remove(inPath);
+    std::filesystem::remove(serialPath);
+    std::filesystem::remove(chunkPath);
+
+    std::printf("testParallelRender:    %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: WAV PCM round trip
+//   Every 16-bit code and a sweep of 24-bit codes, read and re-written at
+//   unity, must come back bit-exact; over-range input clips to the codes'
+//   limits rather than wrapping.
+// ----------------------------------------------------------------------------
+static void testWavRoundTrip()
+{
+    static constexpr unsigned kSampleRate = 48000;
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string firstPath  = (dir / "hexcaster_test_pcm_a.wav").string();
+    const std::string secondPath = (dir / "hexcaster_test_pcm_b.wav").string();
+
+    auto readBytes = [](const std::string& path) {
+        std::vector<char> bytes;
+        if (std::FILE* f = std::fopen(path.c_str(), "rb")) {
+            char buf[4096];
+            std::size_t n;
+            while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+            std::fclose(f);
+        }
+        return bytes;
+    };
+    auto writeAll = [&](const std::string& path, hexcaster::WavWriter::Format format,
+                        const std::vector<float>& x) {
+        hexcaster::WavWriter writer;
+        return writer.open(path, kSampleRate, format)
+            && writer.write(x.data(), static_cast<int>(x.size())) && writer.close();
+    };
+    auto readAll = [&](const std::string& path, std::size_t frames) {
+        hexcaster::WavReader reader;
+        std::vector<float>   out(frames, 0.f);
+        const int n = reader.open(path, kSampleRate)
+                          ? reader.read(out.data(), static_cast<int>(frames), 0) : 0;
+        out.resize(static_cast<std::size_t>(n));
+        return out;
+    };
+
+    auto roundTrip = [&](hexcaster::WavWriter::Format format, int bits, int step) {
+        const int32_t full = 1 << (bits - 1);
+        std::vector<float> codes;
+        for (int32_t v = -full; v < full; v += step)
+            codes.push_back(static_cast<float>(v) / static_cast<float>(full));
+        codes.push_back(static_cast<float>(full - 1) / static_cast<float>(full));
+        // Over-range and near-half values: clip to the limits, round to nearest
+        codes.push_back(1.5f);
+        codes.push_back(-1.5f);
+        codes.push_back(0.6f / static_cast<float>(full));
+        codes.push_back(-0.6f / static_cast<float>(full));
+
+        CHECK(writeAll(firstPath, format, codes), "PCM round-trip write failed");
+        const std::vector<float> decoded = readAll(firstPath, codes.size());
+        CHECK(decoded.size() == codes.size(), "PCM round-trip file has the wrong length");
+        if (decoded.size() != codes.size()) return;
+
+        const std::size_t exact = codes.size() - 4;
+        bool sameCodes = true;
+        for (std::size_t i = 0; i < exact; ++i) sameCodes = sameCodes && decoded[i] == codes[i];
+        CHECK(sameCodes, "PCM codes did not survive a write and read");
+        CHECK(decoded[exact]     == static_cast<float>(full - 1) / static_cast<float>(full),
+              "Positive over-range did not clip to the largest code");
+        CHECK(decoded[exact + 1] == -1.f, "Negative over-range did not clip to the smallest code");
+        CHECK(decoded[exact + 2] ==  1.f / static_cast<float>(full), "0.6 LSB did not round up to 1");
+        CHECK(decoded[exact + 3] == -1.f / static_cast<float>(full), "-0.6 LSB did not round down to -1");
+
+        CHECK(writeAll(secondPath, format, decoded), "PCM round-trip rewrite failed");
+        CHECK(readBytes(firstPath) == readBytes(secondPath), "PCM file re-written at unity is not bit-exact");
+    };
+
+    roundTrip(hexcaster::WavWriter::Format::Pcm16, 16, 1);
+    roundTrip(hexcaster::WavWriter::Format::Pcm24, 24, 257);
+
+    std::filesystem::remove(firstPath);
+    std::filesystem::remove(secondPath);
+
+    std::printf("testWavRoundTrip:      %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: Pipeline timing stats
+//   With HEXCASTER_PIPELINE_STATS every block lands in each stage's and the
+//   total histogram, also for stages on a pipelined worker; without it
+//   stats() reports disabled and stays empty.
+// ----------------------------------------------------------------------------
+static void testPipelineStats()
+{
+    static constexpr int   kBlockSize  = 64;
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kBlocks     = 10;
+
+    hexcaster::GainStage a, b;
+    hexcaster::Pipeline pipeline;
+    pipeline.addStage(&a);
+    pipeline.addStage(&b);
+    pipeline.prepare(kSampleRate, kBlockSize);
+
+    float buffer[kBlockSize] = {};
+    for (int i = 0; i < kBlocks; ++i) pipeline.process(buffer, kBlockSize);
+
+    hexcaster::Pipeline::Stats st = pipeline.stats();
+#if HEXCASTER_PIPELINE_STATS
+    CHECK(st.enabled, "Stats should be enabled");
+    CHECK(st.numStages == 2, "Stats stage count mismatch");
+    CHECK(st.block.count == kBlocks, "Block histogram count mismatch");
+    CHECK(st.stages[0].count == kBlocks && st.stages[1].count == kBlocks,
+          "Stage histogram count mismatch");
+    CHECK(st.block.totalCycles >= st.stages[0].totalCycles + st.stages[1].totalCycles,
+          "Block time less than sum of stage times");
+    CHECK(st.cycleHz > 0.0, "Cycle counter frequency not positive");
+
+    pipeline.resetStats();
+    pipeline.process(buffer, kBlockSize);
+    st = pipeline.stats();
+    CHECK(st.block.count == 1, "resetStats() did not clear histograms");
+
+    // Pipelined: stage b runs on a worker, which times it itself. The
+    // worker is one block behind, so it may not have finished the last one.
+    hexcaster::GainStage c, d;
+    hexcaster::Pipeline split;
+    split.addStage(&c);
+    split.addStage(&d);
+    const int cut = 1;
+    CHECK(split.setCutPoints(&cut, 1), "setCutPoints failed");
+    split.prepare(kSampleRate, kBlockSize);
+    for (int i = 0; i < kBlocks; ++i) split.process(buffer, kBlockSize);
+
+    st = split.stats();
+    CHECK(st.block.count == kBlocks && st.stages[0].count == kBlocks,
+          "Pipelined audio-thread histograms count mismatch");
+    CHECK(st.stages[1].count >= kBlocks - 1 && st.stages[1].count <= kBlocks,
+          "Worker segment's stage was not timed");
+#else
+    CHECK(!st.enabled, "Stats should be disabled");
+    CHECK(st.block.count == 0, "Disabled stats should be empty");
+#endif
+
+    std::printf("testPipelineStats:     %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: NamStage model swap
+//   A control thread swaps models back and forth while the audio thread
+//   keeps processing. Output must stay finite, and unloading must return
+//   the stage to passthrough.
+// ----------------------------------------------------------------------------
+static void testNamModelSwap()
+{
+    static constexpr int   kBlockSize  = 64;
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kSwaps      = 40;
+
+    const std::string wavenet = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_wavenet.nam";
+    const std::string lstm    = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_lstm.nam";
+
+    hexcaster::NamStage nam;
+    nam.prepare(kSampleRate, kBlockSize);
+
+    CHECK(nam.loadModel(lstm), "Failed to load tiny LSTM model");
+    CHECK(!nam.loadModel(wavenet + ".missing"), "Loading a missing file should fail");
+    CHECK(nam.modelPath() == lstm, "Failed load must not change modelPath()");
+
+    float buffer[kBlockSize] = {};
+    nam.process(buffer, kBlockSize);
+    CHECK(nam.hasModel(), "Model not active after first process()");
+
+    std::atomic<bool> done{ false };
+    std::thread control([&]() {
+        for (int i = 0; i < kSwaps; ++i) {
+            nam.loadModel((i & 1) ? lstm : wavenet);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        done.store(true);
+    });
+
+    bool finite = true;
+    int  n      = 0;
+    while (!done.load() || n < 100) {
+        for (int i = 0; i < kBlockSize; ++i)
+            buffer[i] = 0.25f * std::sin(0.05f * static_cast<float>(n * kBlockSize + i));
+        nam.process(buffer, kBlockSize);
+        for (int i = 0; i < kBlockSize; ++i)
+            finite = finite && std::isfinite(buffer[i]);
+        ++n;
+    }
+    control.join();
+    CHECK(finite, "Non-finite output during model swaps");
+
+    // The swap lands at the first block where no fade is running and the
+    // retire queue has room, then fades out over the crossfade window.
+    nam.unloadModel();
+    for (int tries = 0; tries < 100 && nam.hasModel(); ++tries) {
+        nam.process(buffer, kBlockSize);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const int fadeBlocks = static_cast<int>(
+        hexcaster::NamStage::kMaxCrossfadeMs * 0.001f * kSampleRate) / kBlockSize + 1;
+    for (int b = 0; b < fadeBlocks; ++b) nam.process(buffer, kBlockSize);
+    for (int i = 0; i < kBlockSize; ++i) buffer[i] = 0.5f;
+    nam.process(buffer, kBlockSize);
+    CHECK(!nam.hasModel(), "Model still active after unloadModel()");
+    CHECK(nam.modelPath().empty(), "modelPath() not cleared by unloadModel()");
+    CHECK(buffer[0] == 0.5f && buffer[kBlockSize - 1] == 0.5f,
+          "Unloaded NamStage is not passthrough");
+
+    std::printf("testNamModelSwap:      %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: NamStage equal-power crossfade
+//   Two stages run the same model on the same input; one then unloads.
+//   During the fade its output must be cos*model + sin*dry, using the
+//   untouched stage as the model reference, and dry afterwards.
+// ----------------------------------------------------------------------------
+static void testNamCrossfade()
+{
+    static constexpr int   kBlockSize  = 64;
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr float kFadeMs     = 10.f;
+    static constexpr float kTolerance  = 1e-4f;
+
+    const std::string lstm = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_lstm.nam";
+
+    hexcaster::NamStage fading, reference;
+    fading.prepare(kSampleRate, kBlockSize);
+    reference.prepare(kSampleRate, kBlockSize);
+    fading.setCrossfadeMs(kFadeMs);
+    CHECK(fading.loadModel(lstm) && reference.loadModel(lstm), "Failed to load tiny LSTM model");
+
+    auto input = [](int n) { return 0.3f * std::sin(0.031f * static_cast<float>(n)); };
+
+    float a[kBlockSize], b[kBlockSize], dry[kBlockSize];
+    int   n = 0;
+    auto runBlock = [&]() {
+        for (int i = 0; i < kBlockSize; ++i) dry[i] = a[i] = b[i] = input(n + i);
+        fading.process(a, kBlockSize);
+        reference.process(b, kBlockSize);
+        n += kBlockSize;
+    };
+
+    for (int i = 0; i < 10; ++i) runBlock();
+    CHECK(std::fabs(a[0] - b[0]) < kTolerance, "Identical stages diverged before the swap");
+
+    fading.unloadModel();
+
+    const int fadeLength = static_cast<int>(kFadeMs * 0.001f * kSampleRate + 0.5f);
+    const int fadeBlocks = (fadeLength + kBlockSize - 1) / kBlockSize;
+    bool matches = true;
+    for (int blk = 0; blk <= fadeBlocks; ++blk) {
+        runBlock();
+        for (int i = 0; i < kBlockSize; ++i) {
+            const int   pos   = blk * kBlockSize + i;
+            const float theta = 1.57079632679f * static_cast<float>(pos) / fadeLength;
+            const float want  = pos < fadeLength
+                ? b[i] * std::cos(theta) + dry[i] * std::sin(theta)
+                : dry[i];
+            matches = matches && std::fabs(a[i] - want) < kTolerance;
+        }
+    }
+    CHECK(matches, "Crossfade output is not the equal-power mix of model and dry");
+
+    std::printf("testNamCrossfade:      %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: NamModelBank selection
+//   Bank loads in the background; NamStage switches slots by index and
+//   rejects empty or out-of-range slots without disturbing the active one.
+// ----------------------------------------------------------------------------
+static void testNamModelBank()
+{
+    static constexpr int   kBlockSize  = 64;
+    static constexpr float kSampleRate = 48000.f;
+
+    const std::string wavenet = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_wavenet.nam";
+    const std::string lstm    = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_lstm.nam";
+
+    hexcaster::NamModelBank bank;
+    bank.loadAsync({ wavenet, lstm + ".missing", lstm }, kBlockSize);
+    const bool allLoaded = bank.wait();
+    CHECK(!allLoaded, "Bank with a missing file should report failure");
+    CHECK(bank.size() == 3, "Bank size mismatch");
+    CHECK(bank.model(0) && bank.model(2), "Bank slots 0 and 2 should be loaded");
+    CHECK(bank.model(1) == nullptr, "Failed bank slot should be empty");
+
+    hexcaster::NamStage nam;
+    nam.prepare(kSampleRate, kBlockSize);
+    nam.setCrossfadeMs(0.f);
+
+    float buffer[kBlockSize] = {};
+
+    CHECK(nam.selectBankModel(bank, 0), "Selecting bank slot 0 failed");
+    nam.process(buffer, kBlockSize);
+    CHECK(nam.hasModel() && nam.modelPath() == wavenet, "Bank slot 0 not active");
+
+    CHECK(!nam.selectBankModel(bank, 1), "Selecting an empty slot should fail");
+    CHECK(!nam.selectBankModel(bank, 99), "Selecting out of range should fail");
+    CHECK(nam.modelPath() == wavenet, "Failed selection changed modelPath()");
+
+    CHECK(nam.selectBankModel(bank, 2), "Selecting bank slot 2 failed");
+    nam.process(buffer, kBlockSize);
+    CHECK(nam.modelPath() == lstm, "Bank slot 2 not selected");
+
+    // Re-selecting the running model is a no-op, not a self-crossfade.
+    nam.setCrossfadeMs(50.f);
+    CHECK(nam.selectBankModel(bank, 2), "Re-selecting bank slot 2 failed");
+    for (int b = 0; b < 4; ++b) nam.process(buffer, kBlockSize);
+    CHECK(nam.hasModel(), "Re-selecting the active model dropped it");
+
+    std::printf("testNamModelBank:      %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: DualAmpStage blend
+//   Amp B runs on the worker thread. The blended output must equal
+//   (1 - mix) * A + mix * B, using standalone stages on the same input as
+//   the references for A and B.
+// ----------------------------------------------------------------------------
+static void testDualAmp()
+{
+    static constexpr int   kBlockSize  = 64;
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr float kTolerance  = 1e-4f;
+    static constexpr float kMix        = 0.25f;
+
+    const std::string wavenet = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_wavenet.nam";
+    const std::string lstm    = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_lstm.nam";
+
+    hexcaster::NamStage ampA, ampB, refA, refB;
+    hexcaster::DualAmpStage dual(ampA, ampB);
+    dual.setMix(kMix);
+    dual.setWorkerPriority(0);  // tests run unprivileged
+    dual.prepare(kSampleRate, kBlockSize);
+    refA.prepare(kSampleRate, kBlockSize);
+    refB.prepare(kSampleRate, kBlockSize);
+    CHECK(dual.workerRunning(), "DualAmpStage worker not started by prepare()");
+
+    CHECK(ampA.loadModel(wavenet) && refA.loadModel(wavenet), "Failed to load tiny WaveNet model");
+    CHECK(ampB.loadModel(lstm)    && refB.loadModel(lstm),    "Failed to load tiny LSTM model");
+
+    float out[kBlockSize], a[kBlockSize], b[kBlockSize];
+    bool matches = true;
+    for (int blk = 0; blk < 50; ++blk) {
+        for (int i = 0; i < kBlockSize; ++i) {
+            out[i] = a[i] = b[i] = 0.3f * std::sin(0.017f * static_cast<float>(blk * kBlockSize + i));
+        }
+        dual.process(out, kBlockSize);
+        refA.process(a, kBlockSize);
+        refB.process(b, kBlockSize);
+        for (int i = 0; i < kBlockSize; ++i) {
+            const float want = (1.f - kMix) * a[i] + kMix * b[i];
+            matches = matches && std::fabs(out[i] - want) < kTolerance;
+        }
+    }
+    CHECK(matches, "DualAmpStage output is not the mix of both amps");
+
+    std::printf("testDualAmp:           %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: Pipelined execution
+//   Three gain stages split across three threads must produce the serial
+//   chain's output, delayed by latencyBlocks() blocks, with silence while
+//   the pipeline fills.
+// ----------------------------------------------------------------------------
+static void testPipelinedExecution()
+{
+    static constexpr int   kBlockSize  = 32;
+    static constexpr int   kNumBlocks  = 200;
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr float kTolerance  = 1e-6f;
+
+    hexcaster::GainStage serialGains[3], splitGains[3];
+    const float gainsDb[3] = { 6.f, -3.f, 2.f };
+
+    hexcaster::Pipeline serial, split;
+    for (int i = 0; i < 3; ++i) {
+        serialGains[i].setGainDb(gainsDb[i]);
+        splitGains[i].setGainDb(gainsDb[i]);
+        serial.addStage(&serialGains[i]);
+        split.addStage(&splitGains[i]);
+    }
+
+    // Records where betweenStages() is called from: controllers must stay
+    // on the audio thread, with segment 0.
+    struct ThreadProbe : hexcaster::PipelineController {
+        std::thread::id   audioThread = std::this_thread::get_id();
+        std::atomic<bool> offThread{ false };
+        std::atomic<int>  lastStage{ -1 };
+        void preProcess(const float*, int) override { check(); }
+        void betweenStages(int stageIndex, float*, int) override
+        {
+            check();
+            lastStage.store(std::max(lastStage.load(), stageIndex));
+        }
+        void check()
+        {
+            if (std::this_thread::get_id() != audioThread) offThread.store(true);
+        }
+    } probe;
+    split.addController(&probe);
+
+    const int badCuts[] = { 2, 1 };
+    CHECK(!split.setCutPoints(badCuts, 2), "Non-increasing cut points accepted");
+
+    const int cuts[] = { 1, 2 };
+    CHECK(split.setCutPoints(cuts, 2), "Valid cut points rejected");
+    split.setWorkerPriority(0);  // tests run unprivileged
+    serial.prepare(kSampleRate, kBlockSize);
+    split.prepare(kSampleRate, kBlockSize);
+    CHECK(split.numSegments() == 3 && split.latencyBlocks() == 2, "Segment count mismatch");
+
+    static float expected[kNumBlocks][kBlockSize];
+    bool matches = true;
+    for (int blk = 0; blk < kNumBlocks; ++blk) {
+        float a[kBlockSize], b[kBlockSize];
+        for (int i = 0; i < kBlockSize; ++i) {
+            a[i] = b[i] = std::sin(0.01f * static_cast<float>(blk * kBlockSize + i));
+        }
+        serial.process(a, kBlockSize);
+        split.process(b, kBlockSize);
+        std::memcpy(expected[blk], a, sizeof(a));
+
+        const int from = blk - split.latencyBlocks();
+        for (int i = 0; i < kBlockSize; ++i) {
+            const float want = from < 0 ? 0.f : expected[from][i];
+            matches = matches && std::fabs(b[i] - want) < kTolerance;
+        }
+    }
+    CHECK(matches, "Pipelined output is not the serial output delayed by latencyBlocks()");
+    CHECK(!probe.offThread.load(), "Controller called from a segment worker thread");
+    CHECK(probe.lastStage.load() == 0, "Controller called for a stage past the first cut");
+
+    std::printf("testPipelinedExecution: %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: Micro-block slicing
+//   With a micro-block size set, stages are prepared for it and never see a
+//   larger block; an odd host block leaves a short final slice. Output
+//   matches running the same chain on whole blocks.
+// ----------------------------------------------------------------------------
+static void testMicroBlocks()
+{
+    static constexpr int   kHostBlock  = 100;
+    static constexpr int   kMicroBlock = 32;
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr float kTolerance  = 1e-6f;
+
+    struct BlockSizeProbe : hexcaster::ProcessorStage {
+        int preparedSize = 0, largest = 0, calls = 0;
+        void prepare(float, int maxBlockSize) override { preparedSize = maxBlockSize; }
+        void process(float*, int numSamples) override
+        {
+            largest = std::max(largest, numSamples);
+            ++calls;
+        }
+        void reset() override {}
+    };
+
+    BlockSizeProbe probe;
+    hexcaster::GainStage slicedGain, wholeGain;
+    slicedGain.setGainDb(-6.f);
+    wholeGain.setGainDb(-6.f);
+
+    hexcaster::Pipeline sliced, whole;
+    sliced.addStage(&probe);
+    sliced.addStage(&slicedGain);
+    whole.addStage(&wholeGain);
+    sliced.setMicroBlockSize(kMicroBlock);
+    sliced.prepare(kSampleRate, kHostBlock);
+    whole.prepare(kSampleRate, kHostBlock);
+
+    CHECK(probe.preparedSize == kMicroBlock && sliced.stageBlockSize() == kMicroBlock,
+          "Stages not prepared with the micro-block size");
+
+    float a[kHostBlock], b[kHostBlock];
+    for (int i = 0; i < kHostBlock; ++i) a[i] = b[i] = std::sin(0.05f * static_cast<float>(i));
+    sliced.process(a, kHostBlock);
+    whole.process(b, kHostBlock);
+
+    CHECK(probe.largest == kMicroBlock, "A stage saw more than one micro-block");
+    CHECK(probe.calls == (kHostBlock + kMicroBlock - 1) / kMicroBlock, "Unexpected slice count");
+
+    bool matches = true;
+    for (int i = 0; i < kHostBlock; ++i) matches = matches && std::fabs(a[i] - b[i]) < kTolerance;
+    CHECK(matches, "Micro-block output differs from whole-block output");
+
+    std::printf("testMicroBlocks:       %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: ParametricEQ cascade
+//   The skewed multi-band cascade must match running the same biquads one
+//   after another, across odd block sizes; a single Peak band must match
+//   MidSweepEQ.
+// ----------------------------------------------------------------------------
+static void testParametricEQ()
+{
+    using hexcaster::BiquadType;
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr float kTolerance  = 1e-4f;
+    static constexpr int   kMaxBlock   = 67;
+    static const int       kBlocks[]   = { 67, 1, 5, 64, 3, 33 };
+
+    // Band 2 left Off: an identity lane inside the active range.
+    const hexcaster::ParametricEQ::Band bands[] = {
+        { BiquadType::HighPass,  90.f,    0.f, 0.707f },
+        { BiquadType::Peak,      700.f,   5.f, 1.2f   },
+        { BiquadType::Off,       1000.f,  0.f, 0.707f },
+        { BiquadType::HighShelf, 4000.f, -3.f, 0.707f },
+    };
+    static constexpr int kNumBands = 4;
+
+    hexcaster::ParametricEQ eq;
+    eq.prepare(kSampleRate, kMaxBlock);
+    for (int k = 0; k < kNumBands; ++k) eq.setBand(k, bands[k]);
+
+    struct Ref { hexcaster::BiquadCoeffs c; float z1 = 0.f, z2 = 0.f; };
+    Ref ref[kNumBands];
+    for (int k = 0; k < kNumBands; ++k) {
+        ref[k].c = hexcaster::designBiquad(bands[k].type, kSampleRate,
+                                           bands[k].freqHz, bands[k].gainDb, bands[k].q);
+    }
+
+    bool matches = true;
+    int  t = 0;
+    for (int n : kBlocks) {
+        float buffer[kMaxBlock], expected[kMaxBlock];
+        for (int i = 0; i < n; ++i, ++t) {
+            buffer[i] = expected[i] = 0.5f * std::sin(0.03f * static_cast<float>(t))
+                                    + 0.3f * std::sin(0.71f * static_cast<float>(t));
+        }
+        eq.process(buffer, n);
+
+        for (Ref& r : ref) {
+            for (int i = 0; i < n; ++i) {
+                const float x = expected[i];
+                const float y = r.c.b0 * x + r.z1;
+                r.z1 = r.c.b1 * x - r.c.a1 * y + r.z2;
+                r.z2 = r.c.b2 * x - r.c.a2 * y;
+                expected[i] = y;
+            }
+        }
+        for (int i = 0; i < n; ++i) matches = matches && std::fabs(buffer[i] - expected[i]) < kTolerance;
+    }
+    CHECK(matches, "ParametricEQ differs from a serial biquad cascade");
+
+    hexcaster::ParametricEQ single;
+    hexcaster::MidSweepEQ   mid;
+    single.setBand(0, BiquadType::Peak, 1200.f, 6.f, 1.5f);
+    mid.setSweepHz(1200.f);
+    mid.setGainDb(6.f);
+    mid.setQ(1.5f);
+    single.prepare(kSampleRate, kMaxBlock);
+    mid.prepare(kSampleRate, kMaxBlock);
+
+    float a[kMaxBlock], b[kMaxBlock];
+    for (int i = 0; i < kMaxBlock; ++i) a[i] = b[i] = std::sin(0.2f * static_cast<float>(i));
+    single.process(a, kMaxBlock);
+    mid.process(b, kMaxBlock);
+    bool sameAsMid = true;
+    for (int i = 0; i < kMaxBlock; ++i) sameAsMid = sameAsMid && std::fabs(a[i] - b[i]) < kTolerance;
+    CHECK(sameAsMid, "Single Peak band differs from MidSweepEQ");
+
+    std::printf("testParametricEQ:      %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: ToneEQ bands
+//   At the defaults every band is Off and the stage is an identity. Set
+//   controls must land on the documented ParametricEQ bands (clamped), and
+//   a cut at the open end of its range or a 0 dB shelf switches its band Off.
+// ----------------------------------------------------------------------------
+static void testToneEQ()
+{
+    using hexcaster::BiquadType;
+    using hexcaster::ToneEQ;
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kBlock      = 64;
+
+    ToneEQ tone;
+    tone.prepare(kSampleRate, kBlock);
+    CHECK(tone.isIdentity(), "ToneEQ at defaults is not an identity");
+
+    tone.setLowCutHz (1000.f);   // clamped to 300
+    tone.setBassDb   (4.f);
+    tone.setBassHz   (200.f);
+    tone.setTrebleDb (-3.f);
+    tone.setTrebleHz (5000.f);
+    tone.setHighCutHz(8000.f);
+    CHECK(!tone.isIdentity(), "ToneEQ with bands set reports identity");
+
+    hexcaster::ParametricEQ ref;
+    ref.prepare(kSampleRate, kBlock);
+    ref.setBand(ToneEQ::kLowCutBand,  BiquadType::HighPass,  300.f,  0.f, ToneEQ::kCutQ);
+    ref.setBand(ToneEQ::kBassBand,    BiquadType::LowShelf,  200.f,  4.f, ToneEQ::kShelfQ);
+    ref.setBand(ToneEQ::kTrebleBand,  BiquadType::HighShelf, 5000.f, -3.f, ToneEQ::kShelfQ);
+    ref.setBand(ToneEQ::kHighCutBand, BiquadType::LowPass,   8000.f, 0.f, ToneEQ::kCutQ);
+
+    float a[kBlock], b[kBlock];
+    for (int i = 0; i < kBlock; ++i) a[i] = b[i] = std::sin(0.2f * static_cast<float>(i));
+    tone.process(a, kBlock);
+    ref.process(b, kBlock);
+    bool sameAsRef = true;
+    for (int i = 0; i < kBlock; ++i) sameAsRef = sameAsRef && a[i] == b[i];
+    CHECK(sameAsRef, "ToneEQ differs from the equivalent ParametricEQ bands");
+
+    tone.setLowCutHz (ToneEQ::kMinLowCutHz);
+    tone.setBassDb   (0.f);
+    CHECK(tone.getBand(ToneEQ::kLowCutBand).type == BiquadType::Off, "Low cut at 20 Hz not Off");
+    CHECK(tone.getBand(ToneEQ::kBassBand).type   == BiquadType::Off, "Bass at 0 dB not Off");
+    CHECK(tone.getBand(ToneEQ::kTrebleBand).type == BiquadType::HighShelf, "Treble band changed");
+
+    tone.setTrebleDb (0.f);
+    tone.setHighCutHz(ToneEQ::kMaxHighCutHz);
+    CHECK(tone.isIdentity(), "ToneEQ with every band off is not an identity");
+
+    std::printf("testToneEQ:            %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: MidSweepEQ sweep
+//   A full-range parameter jump must not step the output (coefficients
+//   glide per sample), and once settled the table-driven filter must match
+//   one prepared directly at the new settings.
+// ----------------------------------------------------------------------------
+static void testMidSweepEQ()
+{
+    static constexpr int   kBlockSize  = 128;
+    static constexpr float kSampleRate = 48000.f;
+
+    hexcaster::MidSweepEQ swept, still, fresh;
+    for (auto* eq : { &swept, &still }) {
+        eq->setSweepHz(300.f);
+        eq->setGainDb(-12.f);
+        eq->setQ(0.5f);
+        eq->prepare(kSampleRate, kBlockSize);
+    }
+    fresh.setSweepHz(2500.f);
+    fresh.setGainDb(12.f);
+    fresh.setQ(2.f);
+    fresh.prepare(kSampleRate, kBlockSize);
+
+    auto signal = [](int t) { return 0.5f * std::sin(0.13f * static_cast<float>(t)); };
+
+    int t = 0;
+    for (int b = 0; b < 4; ++b) {
+        float a[kBlockSize], s[kBlockSize], f[kBlockSize];
+        for (int i = 0; i < kBlockSize; ++i, ++t) a[i] = s[i] = f[i] = signal(t);
+        swept.process(a, kBlockSize);
+        still.process(s, kBlockSize);
+        fresh.process(f, kBlockSize);
+    }
+
+    swept.setSweepHz(2500.f);
+    swept.setGainDb(12.f);
+    swept.setQ(2.f);
+
+    // First samples after the jump: still on (almost) the old response.
+    float maxStep = 0.f, maxDiff = 0.f;
+    for (int b = 0; b < 200; ++b) {
+        float a[kBlockSize], s[kBlockSize], f[kBlockSize];
+        for (int i = 0; i < kBlockSize; ++i, ++t) a[i] = s[i] = f[i] = signal(t);
+        swept.process(a, kBlockSize);
+        still.process(s, kBlockSize);
+        fresh.process(f, kBlockSize);
+        if (b == 0) maxStep = std::max(std::fabs(a[0] - s[0]), std::fabs(a[1] - s[1]));
+        if (b == 199) {
+            for (int i = 0; i < kBlockSize; ++i) maxDiff = std::max(maxDiff, std::fabs(a[i] - f[i]));
+        }
+    }
+    CHECK(maxStep < 1e-3f, "Parameter jump stepped the output (zipper)");
+    CHECK(maxDiff < 1e-4f, "Swept EQ did not settle on the target response");
+
+    std::printf("testMidSweepEQ:        %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: NoiseGate fast paths
+//   Burst / near-silence / burst. Output must not depend on how the signal
+//   is cut into blocks; the steady open part must pass bit-identical and
+//   the closed part must be exact zeros.
+// ----------------------------------------------------------------------------
+static void testNoiseGate()
+{
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kLength     = 24000;
+    static constexpr int   kMaxBlock   = 128;
+
+    // 0.5 s loud, 0.25 s hiss at -90 dB, then loud again
+    static float input[kLength];
+    for (int t = 0; t < kLength; ++t) {
+        const bool loud = t < 12000 || t >= 18000;
+        input[t] = (loud ? 0.5f : 3e-5f) * std::sin(0.07f * static_cast<float>(t));
+    }
+
+    static float out[3][kLength];
+    const int blockSizes[3] = { kMaxBlock, 37, 1 };
+    for (int r = 0; r < 3; ++r) {
+        hexcaster::NoiseGate gate;
+        gate.setThresholdDb(-50.f);
+        gate.setReleaseMs(5.f);
+        gate.prepare(kSampleRate, kMaxBlock);
+        std::memcpy(out[r], input, sizeof(input));
+        for (int t = 0; t < kLength; t += blockSizes[r]) {
+            gate.process(out[r] + t, std::min(blockSizes[r], kLength - t));
+        }
+    }
+
+    bool sameAcrossBlocks = true;
+    for (int t = 0; t < kLength; ++t) {
+        sameAcrossBlocks = sameAcrossBlocks && std::fabs(out[0][t] - out[1][t]) < 1e-6f
+                                            && std::fabs(out[0][t] - out[2][t]) < 1e-6f;
+    }
+    CHECK(sameAcrossBlocks, "Gate output depends on block size");
+
+    CHECK(std::memcmp(out[0] + 4000, input + 4000, 8000 * sizeof(float)) == 0,
+          "Open gate modified the signal");
+
+    bool silent = true;
+    for (int t = 17000; t < 18000; ++t) silent = silent && out[0][t] == 0.f;
+    CHECK(silent, "Closed gate let signal through");
+
+    float reopened = 0.f;
+    for (int t = 19000; t < kLength; ++t) reopened = std::max(reopened, std::fabs(out[0][t]));
+    CHECK(reopened > 0.4f, "Gate did not reopen");
+
+    std::printf("testNoiseGate:         %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: NoiseGate lookahead
+//   The gain is applied to a delayed copy: the output is the input shifted
+//   by latencySamples(), and with a fast attack a burst from silence comes
+//   through whole instead of having its front chopped. The ring buffer
+//   must give the same result for blocks shorter and longer than the delay.
+// ----------------------------------------------------------------------------
+static void testGateLookahead()
+{
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kLength     = 4096;
+    static constexpr int   kOnset      = 1000;
+    static constexpr int   kMaxBlock   = 128;
+
+    static float input[kLength];
+    for (int t = 0; t < kLength; ++t) {
+        input[t] = t < kOnset ? 0.f : 0.5f * std::sin(0.05f * static_cast<float>(t - kOnset) + 0.3f);
+    }
+
+    static float out[3][kLength];
+    const int blockSizes[3] = { kMaxBlock, 37, 1 };
+    int latency = 0;
+    for (int r = 0; r < 3; ++r) {
+        hexcaster::NoiseGate gate;
+        gate.setThresholdDb(-40.f);
+        gate.setAttackMs(0.1f);
+        gate.setLookaheadMs(2.f);
+        gate.prepare(kSampleRate, kMaxBlock);
+        latency = gate.latencySamples();
+        std::memcpy(out[r], input, sizeof(input));
+        for (int t = 0; t < kLength; t += blockSizes[r]) {
+            gate.process(out[r] + t, std::min(blockSizes[r], kLength - t));
+        }
+    }
+    CHECK(latency == 96, "2 ms lookahead at 48 kHz should report 96 samples");
+
+    bool sameAcrossBlocks = true;
+    for (int t = 0; t < kLength; ++t) {
+        sameAcrossBlocks = sameAcrossBlocks && out[0][t] == out[1][t] && out[0][t] == out[2][t];
+    }
+    CHECK(sameAcrossBlocks, "Lookahead output depends on block size");
+
+    bool leading = true;
+    for (int t = kOnset + latency; t < kLength; ++t) {
+        leading = leading && out[0][t] == input[t - latency];
+    }
+    CHECK(leading, "Lookahead gate did not pass the burst onset intact");
+
+    hexcaster::Pipeline pipeline;
+    hexcaster::NoiseGate gate;
+    hexcaster::GainStage gain;
+    gate.setLookaheadMs(1.f);
+    pipeline.addStage(&gate);
+    pipeline.addStage(&gain);
+    pipeline.prepare(kSampleRate, kMaxBlock);
+    CHECK(pipeline.latencySamples() == 48, "Pipeline did not report the gate's lookahead");
+
+    std::printf("testGateLookahead:     %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: EnvelopeFollower
+//   Peak and RMS levels of a steady 1 kHz sine through the detector
+//   filters; a 30 Hz sine is mostly removed by the detector HPF. The
+//   per-sample buffer ends on the returned value, and delayAudio() shifts
+//   by latencySamples().
+// ----------------------------------------------------------------------------
+static void testEnvelopeFollower()
+{
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kBlockSize  = 100;   // not a multiple of the chunk sizes
+
+    auto settle = [](hexcaster::EnvelopeFollower& f, float hz, float* perSample) {
+        float value = 0.f;
+        for (int b = 0, t = 0; b < 200; ++b) {
+            float block[kBlockSize];
+            for (int i = 0; i < kBlockSize; ++i, ++t) {
+                block[i] = 0.5f * std::sin(kTwoPi * hz * static_cast<float>(t) / kSampleRate);
+            }
+            value = f.process(block, kBlockSize, perSample);
+        }
+        return value;
+    };
+
+    hexcaster::EnvelopeFollower::Config config;
+    config.enableLpf = true;
+
+    hexcaster::EnvelopeFollower peak, rms, low;
+    peak.prepare(kSampleRate, kBlockSize, config);
+    low.prepare(kSampleRate, kBlockSize, config);
+    config.detector = hexcaster::EnvelopeFollower::Detector::Rms;
+    rms.prepare(kSampleRate, kBlockSize, config);
+
+    float perSample[kBlockSize];
+    const float peakValue = settle(peak, 1000.f, perSample);
+    CHECK(std::fabs(peakValue - 0.5f) < 0.02f, "Peak envelope of a 0.5 sine is not ~0.5");
+    CHECK(perSample[kBlockSize - 1] == peakValue, "Per-sample envelope does not end on the block value");
+
+    const float rmsValue = settle(rms, 1000.f, nullptr);
+    CHECK(std::fabs(rmsValue - 0.3536f) < 0.02f, "RMS envelope of a 0.5 sine is not ~0.354");
+
+    const float lowValue = settle(low, 30.f, nullptr);
+    CHECK(lowValue < 0.1f, "Detector HPF did not attenuate 30 Hz");
+
+    hexcaster::EnvelopeFollower ahead;
+    config.lookaheadMs = 2;
+    ahead.prepare(kSampleRate, kBlockSize, config);
+    CHECK(ahead.latencySamples() == 96, "2 ms lookahead at 48 kHz should be 96 samples");
+
+    bool delayed = true;
+    for (int b = 0, t = 0; b < 5; ++b) {
+        float block[kBlockSize];
+        for (int i = 0; i < kBlockSize; ++i) block[i] = static_cast<float>(t + i + 1);
+        ahead.delayAudio(block, kBlockSize);
+        for (int i = 0; i < kBlockSize; ++i, ++t) {
+            const float expected = t < 96 ? 0.f : static_cast<float>(t - 96 + 1);
+            delayed = delayed && block[i] == expected;
+        }
+    }
+    CHECK(delayed, "delayAudio() did not delay by latencySamples()");
+
+    // The state-space block filter against the DF2T recurrence it unrolls,
+    // in double, on noise fed in runs that mix whole 8-sample steps with
+    // remainders so the state passes between both paths. A float DF2T is
+    // itself ~3e-5 off for the 100 Hz HPF (poles near z = 1); a wrong
+    // matrix entry is off by orders of magnitude more.
+    const hexcaster::BiquadCoeffs designs[] = {
+        hexcaster::designBiquad(hexcaster::BiquadType::HighPass, kSampleRate, 100.f,  0.f, 0.7071f),
+        hexcaster::designBiquad(hexcaster::BiquadType::LowPass,  kSampleRate, 6000.f, 0.f, 0.7071f),
+        hexcaster::designBiquad(hexcaster::BiquadType::Peak,     kSampleRate, 800.f,  12.f, 8.f),
+    };
+    const int runs[] = { 8, 37, 64, 3, 100, 16, 1, 29 };
+    float maxError = 0.f;
+    for (const hexcaster::BiquadCoeffs& c : designs) {
+        hexcaster::EnvelopeFollower::BlockBiquad block;
+        block.design(c);
+
+        double   z1 = 0.0, z2 = 0.0;
+        uint32_t rng = 1;
+        for (int r = 0; r < 40; ++r) {
+            const int n = runs[r % 8];
+            float in[100], out[100];
+            for (int i = 0; i < n; ++i) {
+                rng = rng * 1664525u + 1013904223u;
+                in[i] = static_cast<float>(rng >> 8) / 8388608.f - 1.f;
+            }
+            block.run(in, out, n);
+            for (int i = 0; i < n; ++i) {
+                const double y = c.b0 * in[i] + z1;
+                z1 = c.b1 * in[i] - c.a1 * y + z2;
+                z2 = c.b2 * in[i] - c.a2 * y;
+                maxError = std::max(maxError, static_cast<float>(std::fabs(out[i] - y)));
+            }
+        }
+    }
+    CHECK(maxError < 2e-4f, "BlockBiquad::run() deviates from the DF2T reference");
+
+    std::printf("testEnvelopeFollower:  %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: BloomController
+//   A stage ahead of the pre gain replaces the audio with 1.0 (the
+//   controller has already seen the real input), so the pre gain's output is
+//   its gain trajectory. Silence, then a loud sine: the trajectory must move
+//   in small per-sample steps across block and micro-block boundaries, and
+//   pre * post must settle on the Bloom law.
+// ----------------------------------------------------------------------------
+
+static void testBloomController()
+{
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kHostBlock  = 100;
+    static constexpr int   kMicroBlock = 32;
+    static constexpr int   kBlocks     = 100;
+
+    struct OnesStage : hexcaster::ProcessorStage {
+        void prepare(float, int) override {}
+        void process(float* buffer, int numSamples) override { std::fill(buffer, buffer + numSamples, 1.f); }
+        void reset() override {}
+    };
+    struct RecordStage : hexcaster::ProcessorStage {
+        std::vector<float> samples;
+        void prepare(float, int) override {}
+        void process(float* buffer, int numSamples) override { samples.insert(samples.end(), buffer, buffer + numSamples); }
+        void reset() override {}
+    };
+
+    hexcaster::ParamRegistry params;   // defaults: pre depth 6 dB, post depth 3 dB
+
+    OnesStage            ones;
+    RecordStage          preGainOut;
+    hexcaster::GainStage preGain, postGain;
+
+    hexcaster::Pipeline pipeline;
+    pipeline.addStage(&ones);         // 0
+    pipeline.addStage(&preGain);      // 1
+    pipeline.addStage(&preGainOut);   // 2
+    pipeline.addStage(&postGain);     // 3
+    hexcaster::BloomController bloom(preGain, postGain, 1, 3, params);
+    pipeline.addController(&bloom);
+    pipeline.setMicroBlockSize(kMicroBlock);
+    pipeline.prepare(kSampleRate, kHostBlock);
+    bloom.prepare(kSampleRate, pipeline.stageBlockSize());
+
+    float block[kHostBlock];
+    for (int b = 0, t = 0; b < kBlocks; ++b) {
+        for (int i = 0; i < kHostBlock; ++i, ++t) {
+            block[i] = b < 10 ? 0.f : 0.8f * std::sin(kTwoPi * 1000.f * static_cast<float>(t) / kSampleRate);
+        }
+        pipeline.process(block, kHostBlock);
+    }
+
+    const std::vector<float>& g = preGainOut.samples;
+    CHECK(g.size() == static_cast<std::size_t>(kBlocks * kHostBlock), "Pre gain did not see every sample");
+
+    float maxStep = 0.f;
+    for (std::size_t i = 1; i < g.size(); ++i) maxStep = std::max(maxStep, std::fabs(g[i] - g[i - 1]));
+    CHECK(g.front() == 1.f, "Pre gain moved during silence");
+    CHECK(g.back() < 0.8f, "Pre gain did not duck under a loud input");
+    CHECK(maxStep < 0.005f, "Pre gain trajectory steps instead of ramping");
+
+    const float env      = bloom.envelope();
+    const float expected = std::pow(10.f, -6.f * env / 20.f);
+    CHECK(std::fabs(g.back() - expected) < 1e-5f * expected, "Pre gain is not BasePre - PreDepth * envelope");
+    CHECK(std::fabs(block[kHostBlock - 1] - std::pow(10.f, -3.f * env / 20.f)) < 1e-4f,
+          "Pre * post gain does not follow the Bloom law");
+
+    std::printf("testBloomController:   %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: StaticPipeline
+//   gate -> gain -> EQ -> gain as a StaticPipeline (both gains fused into
+//   the stage before them) must match the same chain run by Pipeline,
+//   through gate transitions and gain ramps.
+// ----------------------------------------------------------------------------
+
+static void testStaticPipeline()
+{
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kHostBlock  = 100;
+    static constexpr int   kMicroBlock = 64;
+    static constexpr int   kBlocks     = 200;
+
+    TestChain::Settings settings;
+    settings.gateThresholdDb = -30.f;
+    settings.gateReleaseMs   = 5.f;
+    settings.gateHoldMs      = 0.f;
+    settings.inputGainDb     = 6.f;
+    settings.eqGainDb        = 6.f;
+    settings.masterDb        = -3.f;
+
+    TestChain dyn(settings), fused(settings);
+    hexcaster::Pipeline& pipeline = dyn.pipeline;
+    pipeline.setMicroBlockSize(kMicroBlock);
+    pipeline.prepare(kSampleRate, kHostBlock);
+
+    auto& chain = fused.staticPipeline;
+    static_assert(decltype(fused.staticPipeline)::numStages() == 4);
+    chain.setMicroBlockSize(kMicroBlock);
+    chain.prepare(kSampleRate, kHostBlock);
+    CHECK(chain.stageBlockSize() == kMicroBlock, "StaticPipeline ignored the micro-block size");
+
+    float maxErr = 0.f;
+    for (int b = 0, t = 0; b < kBlocks; ++b) {
+        if (b == 50) {   // gain ramps on both fused gains
+            dyn.inputGain.setGainDb(-6.f);  fused.inputGain.setGainDb(-6.f);
+            dyn.master.setGainDb(3.f);      fused.master.setGainDb(3.f);
+        }
+
+        float a[kHostBlock], c[kHostBlock];
+        fillBursts(a, kHostBlock, t, 440.f, 0.5f);
+        std::copy(a, a + kHostBlock, c);
+        t += kHostBlock;
+        pipeline.process(a, kHostBlock);
+        chain.process(c, kHostBlock);
+        for (int i = 0; i < kHostBlock; ++i) maxErr = std::max(maxErr, std::fabs(a[i] - c[i]));
+    }
+    CHECK(maxErr < 1e-5f, "StaticPipeline output differs from Pipeline");
+
+    std::printf("testStaticPipeline:    %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: identity bypass
+//   A unity GainStage and a flat MidSweepEQ are skipped and leave the signal
+//   untouched. A stage leaving identity is crossfaded in from the dry signal
+//   over kBypassFadeMs, across block boundaries.
+// ----------------------------------------------------------------------------
+
+static void testIdentityBypass()
+{
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kBlockSize  = 100;
+
+    hexcaster::GainStage  master;
+    hexcaster::MidSweepEQ eq;
+    hexcaster::Pipeline   pipeline;
+    pipeline.addStage(&eq);
+    pipeline.addStage(&master);
+    pipeline.prepare(kSampleRate, kBlockSize);
+
+    float block[kBlockSize], input[kBlockSize];
+    float maxErr = 0.f;
+    for (int b = 0, t = 0; b < 10; ++b) {
+        for (int i = 0; i < kBlockSize; ++i, ++t) {
+            input[i] = block[i] = 0.5f * std::sin(kTwoPi * 440.f * static_cast<float>(t) / kSampleRate);
+        }
+        pipeline.process(block, kBlockSize);
+        for (int i = 0; i < kBlockSize; ++i) maxErr = std::max(maxErr, std::fabs(block[i] - input[i]));
+    }
+    CHECK(pipeline.isBypassed(0) && pipeline.isBypassed(1), "Flat EQ / unity gain not bypassed");
+    CHECK(maxErr == 0.f, "Bypassed stages changed the signal");
+
+    eq.setGainDb(6.f);
+    pipeline.process(block, kBlockSize);
+    CHECK(!pipeline.isBypassed(0) && pipeline.isBypassed(1), "EQ did not leave bypass on a gain change");
+
+    // A stage whose wet output is 1.0: the dry 0.0 must ramp into it.
+    struct OnesWhenActive : hexcaster::ProcessorStage {
+        bool identity = true;
+        void prepare(float, int) override {}
+        void process(float* buffer, int numSamples) override { std::fill(buffer, buffer + numSamples, 1.f); }
+        void reset() override {}
+        bool isIdentity() const override { return identity; }
+    };
+
+    OnesWhenActive     toggle;
+    hexcaster::Pipeline fade;
+    fade.addStage(&toggle);
+    fade.prepare(kSampleRate, kBlockSize);
+
+    const int fadeLen = static_cast<int>(hexcaster::Pipeline::kBypassFadeMs * 0.001f * kSampleRate);
+    std::vector<float> out;
+    for (int b = 0; b < 4; ++b) {
+        if (b == 1) toggle.identity = false;
+        std::fill(block, block + kBlockSize, 0.f);
+        fade.process(block, kBlockSize);
+        out.insert(out.end(), block, block + kBlockSize);
+    }
+
+    bool ramp = true;
+    for (int i = 0; i < kBlockSize; ++i) ramp = ramp && out[static_cast<std::size_t>(i)] == 0.f;
+    for (int i = 0; i < fadeLen; ++i) {
+        const float expected = static_cast<float>(i + 1) / static_cast<float>(fadeLen);
+        ramp = ramp && std::fabs(out[static_cast<std::size_t>(kBlockSize + i)] - expected) < 1e-5f;
+    }
+    ramp = ramp && out.back() == 1.f;
+    CHECK(fadeLen > kBlockSize, "Fade should span more than one block for this test");
+    CHECK(ramp, "Stage leaving bypass was not crossfaded in linearly");
+
+    std::printf("testIdentityBypass:    %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: multichannel
+//   gate (with lookahead) -> gain -> EQ -> gain over 2, 3 and 8 planar
+//   channels through one Pipeline must match one mono Pipeline per channel,
+//   through gate transitions, gain ramps and an EQ sweep. A mono-only stage
+//   or cut points rule out a multichannel layout.
+// ----------------------------------------------------------------------------
+
+static void testMultichannel()
+{
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kHostBlock  = 100;
+    static constexpr int   kMicroBlock = 64;
+    static constexpr int   kBlocks     = 200;
+
+    TestChain::Settings settings;
+    settings.gateThresholdDb = -30.f;
+    settings.gateReleaseMs   = 5.f;
+    settings.gateHoldMs      = 1.f;
+    settings.gateLookaheadMs = 1.f;
+    settings.inputGainDb     = 6.f;
+    settings.eqGainDb        = 6.f;
+    settings.masterDb        = -3.f;
+
+    auto update = [](TestChain& chain, int block) {
+        if (block == 60) { chain.inputGain.setGainDb(-6.f); chain.master.setGainDb(0.f); }
+        if (block == 90) { chain.eq.setSweepHz(2000.f); chain.eq.setGainDb(-9.f); }
+    };
+
+    for (const int channels : { 2, 3, 8 }) {
+        TestChain planar(settings);
+        planar.pipeline.setMicroBlockSize(kMicroBlock);
+        CHECK(planar.pipeline.setNumChannels(channels), "setNumChannels() refused gate/gain/EQ");
+        planar.pipeline.prepare(kSampleRate, kHostBlock);
+
+        std::vector<std::unique_ptr<TestChain>> mono;
+        for (int c = 0; c < channels; ++c) {
+            mono.push_back(std::make_unique<TestChain>(settings));
+            mono.back()->pipeline.setMicroBlockSize(kMicroBlock);
+            mono.back()->pipeline.prepare(kSampleRate, kHostBlock);
+        }
+
+        std::vector<float> planes(static_cast<std::size_t>(channels * kHostBlock));
+        std::vector<float> reference(planes.size());
+        hexcaster::AudioBlock block;
+        block.numChannels = channels;
+        block.numSamples  = kHostBlock;
+        for (int c = 0; c < channels; ++c) block.channels[c] = planes.data() + c * kHostBlock;
+
+        float maxErr = 0.f;
+        for (int b = 0, t = 0; b < kBlocks; ++b, t += kHostBlock) {
+            update(planar, b);
+            for (auto& m : mono) update(*m, b);
+
+            // Each channel: its own pitch, level and burst phase. Between
+            // bursts a -40 dB hum, so the gate's closing ramp is audible.
+            for (int c = 0; c < channels; ++c) {
+                fillBursts(planes.data() + c * kHostBlock, kHostBlock, t + c * 700,
+                           220.f + 110.f * static_cast<float>(c), 0.2f + 0.1f * static_cast<float>(c), 0.01f);
+            }
+            reference = planes;
+
+            planar.pipeline.process(block);
+            for (int c = 0; c < channels; ++c) {
+                mono[static_cast<std::size_t>(c)]->pipeline.process(reference.data() + c * kHostBlock, kHostBlock);
+            }
+            for (std::size_t i = 0; i < planes.size(); ++i) {
+                maxErr = std::max(maxErr, std::fabs(planes[i] - reference[i]));
+            }
+        }
+        CHECK(maxErr < 1e-5f, "Multichannel Pipeline differs from one mono Pipeline per channel");
+    }
+
+    struct MonoOnly : hexcaster::ProcessorStage {
+        void prepare(float, int) override {}
+        void process(float*, int) override {}
+        void reset() override {}
+    };
+    MonoOnly            monoOnly;
+    hexcaster::GainStage gain;
+    hexcaster::Pipeline  mixed;
+    mixed.addStage(&gain);
+    mixed.addStage(&monoOnly);
+    CHECK(!mixed.setNumChannels(2) && mixed.numChannels() == 1, "Mono-only stage accepted in a stereo chain");
+
+    hexcaster::Pipeline split;
+    hexcaster::GainStage a, b;
+    split.addStage(&a);
+    split.addStage(&b);
+    CHECK(split.setNumChannels(2), "Gain stages refused two channels");
+    const int cut = 1;
+    CHECK(!split.setCutPoints(&cut, 1), "Cut points accepted on a multichannel chain");
+
+    std::printf("testMultichannel:      %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: ChainScheduler runs every job exactly once per period, on the
+// caller and the workers, and rack chains come out as if run serially.
+// A caller blocked on its home job gets that job's partner stolen.
+// ----------------------------------------------------------------------------
+static void testChainScheduler()
+{
+    static constexpr float kSampleRate = 48000.f;
+    static constexpr int   kHostBlock  = 128;
+    static constexpr int   kChains     = 4;
+    static constexpr int   kPeriods    = 300;
+
+    // Chain c: its own input gain and EQ frequency, bursts offset by c.
+    auto makeChain = [](int c) {
+        TestChain::Settings settings;
+        settings.gateThresholdDb = -40.f;
+        settings.inputGainDb     = 3.f * static_cast<float>(c);
+        settings.eqGainDb        = 6.f;
+        settings.eqSweepHz       = 500.f + 400.f * static_cast<float>(c);
+        auto chain = std::make_unique<TestChain>(settings);
+        chain->staticPipeline.prepare(kSampleRate, kHostBlock);
+        return chain;
+    };
+    auto fill = [](float* block, int chain, int period) {
+        fillBursts(block, kHostBlock, period * kHostBlock + chain * 2400,
+                   110.f * static_cast<float>(chain + 1), 0.4f);
+    };
+
+    std::vector<std::unique_ptr<TestChain>> rack, serial;
+    for (int c = 0; c < kChains; ++c) {
+        rack.push_back(makeChain(c));
+        serial.push_back(makeChain(c));
+    }
+
+    // One job closure for both runs: with -ffast-math, separately inlined
+    // copies of the chain need not round identically.
+    static float rackOut[kChains][kHostBlock], serialOut[kChains][kHostBlock];
+    std::vector<std::unique_ptr<TestChain>>* chains = nullptr;
+    float (*outputs)[kHostBlock] = nullptr;
+    std::atomic<int> runs[kChains] = {};
+    auto job = [&](int j) {
+        (*chains)[j]->staticPipeline.process(outputs[j], kHostBlock);
+        runs[j].fetch_add(1, std::memory_order_relaxed);
+    };
+
+    hexcaster::ChainScheduler scheduler, reference;
+    scheduler.setWorkerPriority(0);  // tests run unprivileged
+    CHECK(!scheduler.start(hexcaster::ChainScheduler::kMaxWorkers + 1, job),
+          "Worker count past kMaxWorkers accepted");
+    CHECK(scheduler.start(2, job), "start() refused two workers");
+    CHECK(reference.start(0, job) && reference.numWorkers() == 0, "start() refused zero workers");
+
+    float maxErr   = 0.f;
+    bool  onceEach = true;
+    for (int p = 0; p < kPeriods; ++p) {
+        for (int c = 0; c < kChains; ++c) {
+            fill(rackOut[c], c, p);
+            fill(serialOut[c], c, p);
+        }
+        chains  = &rack;
+        outputs = rackOut;
+        scheduler.run(kChains);
+        for (int c = 0; c < kChains; ++c)
+            onceEach = onceEach && runs[c].load(std::memory_order_relaxed) == 2 * p + 1;
+
+        chains  = &serial;
+        outputs = serialOut;
+        reference.run(kChains);
+
+        for (int c = 0; c < kChains; ++c)
+            for (int i = 0; i < kHostBlock; ++i)
+                maxErr = std::max(maxErr, std::fabs(rackOut[c][i] - serialOut[c][i]));
+    }
+    CHECK(onceEach, "A job ran more or less than once in a period");
+    CHECK(maxErr == 0.f, "Scheduled chains differ from serial processing");
+
+    // Two workers: jobs 0 and 3 are the caller's. The caller takes job 0
+    // first and holds it until job 3 is done, so a worker must steal job 3.
+    std::atomic<bool> stolenDone{ false };
+    std::atomic<int>  stolen{ 0 };
+    const std::thread::id caller = std::this_thread::get_id();
+    scheduler.start(2, [&](int j) {
+        if (j == 0) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+            while (!stolenDone.load(std::memory_order_acquire)
+                   && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        } else if (j == 3) {
+            if (std::this_thread::get_id() != caller) stolen.fetch_add(1, std::memory_order_relaxed);
+            stolenDone.store(true, std::memory_order_release);
+        }
+    });
+    for (int p = 0; p < 5; ++p) {
+        stolenDone.store(false, std::memory_order_relaxed);
+        scheduler.run(kChains);
+    }
+    CHECK(stolen.load() == 5, "Idle workers did not steal the blocked caller's job");
+
+    std::printf("testChainScheduler:    %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: sample-format converters. Int16 and both 24-bit formats survive
+// capture -> playback bit-exact at every stride kernel (and the generic
+// one), playback writes only its own channel, out-of-range input
+// saturates, and TPDF dither averages out to the sub-LSB input it is
+// added to.
+// ----------------------------------------------------------------------------
+static void testSampleConvert()
+{
+    using hexcaster::SampleFormat;
+    static constexpr int kFrames = 131;   // > one 64-frame chunk, not a multiple of 8
+
+    // Round trip over specialised strides, the generic stride, and a raw
+    // stride other than the set-up one.
+    const int strides[][2] = { { 1, 1 }, { 2, 2 }, { 4, 4 }, { 8, 8 }, { 11, 11 }, { 2, 3 } };
+    for (const auto& st : strides) {
+        const int setUp = st[0];
+        const int raw   = st[1];
+        std::vector<int16_t> in(static_cast<std::size_t>(kFrames) * raw);
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            in[i] = static_cast<int16_t>(static_cast<int32_t>(i * 2654435761u) >> 16);
+        }
+        in[0] = -32768;
+        in[static_cast<std::size_t>(raw)] = 32767;
+
+        hexcaster::CaptureConverter  capture;
+        hexcaster::PlaybackConverter playback;
+        capture.setUp(SampleFormat::Int16, setUp);
+        playback.setUp(SampleFormat::Int16, setUp, false);
+
+        std::vector<float>   plane(kFrames);
+        std::vector<int16_t> out(in.size(), 0x5a5a);
+        capture.convert({ in.data(), raw }, plane.data(), kFrames);
+        playback.convert(plane.data(), { out.data(), raw }, kFrames);
+
+        bool exact = true, untouched = true;
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            if (i % static_cast<std::size_t>(raw) == 0) exact     &= out[i] == in[i];
+            else                                        untouched &= out[i] == 0x5a5a;
+        }
+        CHECK(exact, "Int16 capture -> playback is not bit-exact");
+        CHECK(untouched, "Playback wrote outside its channel");
+    }
+
+    // 24-bit, packed (S24_3LE) and in four bytes (S24_LE): the same round
+    // trip, with sign-extended input so the S24_LE padding byte matches.
+    // Strides 4 and 6 take the packed kernels' two-window path.
+    for (const SampleFormat fmt : { SampleFormat::Int24Packed, SampleFormat::Int24 }) {
+        for (const int stride : { 1, 2, 4, 6, 11 }) {
+            const int            bytes = hexcaster::bytesPerSample(fmt);
+            std::vector<uint8_t> in(static_cast<std::size_t>(kFrames) * stride * bytes);
+            for (std::size_t i = 0; i < in.size(); i += static_cast<std::size_t>(bytes)) {
+                const int32_t v = static_cast<int32_t>(static_cast<uint32_t>(i) * 2654435761u) >> 8;
+                std::memcpy(&in[i], &v, static_cast<std::size_t>(bytes));
+            }
+
+            hexcaster::CaptureConverter  capture;
+            hexcaster::PlaybackConverter playback;
+            capture.setUp(fmt, stride);
+            playback.setUp(fmt, stride, false);
+
+            std::vector<float>   plane(kFrames);
+            std::vector<uint8_t> out(in.size(), 0x5a);
+            for (int ch = 0; ch < stride; ch += 3) {
+                const std::size_t offset = static_cast<std::size_t>(ch * bytes);
+                capture.convert({ in.data() + offset, stride }, plane.data(), kFrames);
+                playback.convert(plane.data(), { out.data() + offset, stride }, kFrames);
+            }
+
+            bool exact = true, untouched = true;
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                const int ch = static_cast<int>(i / static_cast<std::size_t>(bytes)) % stride;
+                if (ch % 3 == 0) exact     &= out[i] == in[i];
+                else             untouched &= out[i] == 0x5a;
+            }
+            CHECK(exact, "24-bit capture -> playback is not bit-exact");
+            CHECK(untouched, "24-bit playback wrote outside its channel");
+        }
+    }
+
+    // Saturation and rounding.
+    {
+        hexcaster::PlaybackConverter p16, p32;
+        p16.setUp(SampleFormat::Int16, 1, false);
+        p32.setUp(SampleFormat::Int32, 2, false);
+
+        const float x[] = { 1.5f, -1.5f, 1.f, -1.f, 0.5f / 32768.f, -0.49f / 32768.f, 0.25f };
+        int16_t s16[std::size(x)];
+        int32_t s32[std::size(x) * 2];
+        p16.convert(x, { s16, 1 }, static_cast<int>(std::size(x)));
+        p32.convert(x, { s32, 2 }, static_cast<int>(std::size(x)));
+
+        CHECK(s16[0] == 32767 && s16[1] == -32768, "Int16 output does not saturate");
+        CHECK(s16[2] == 32767 && s16[3] == -32768, "Int16 full scale is wrong");
+        CHECK(s16[4] == 1 && s16[5] == 0, "Int16 output does not round to nearest");
+        CHECK(s16[6] == 8192, "Int16 scaling is wrong");
+        CHECK(s32[0] > 2147483000 && s32[2 * 2] > 2147483000, "Int32 output wraps at +full scale");
+        CHECK(s32[1 * 2] == INT32_MIN && s32[3 * 2] == INT32_MIN, "Int32 output does not saturate");
+        CHECK(s32[6 * 2] == 536870912, "Int32 scaling is wrong");
+
+        hexcaster::PlaybackConverter p24;
+        p24.setUp(SampleFormat::Int24Packed, 1, false);
+        uint8_t s24[std::size(x) * 3];
+        p24.convert(x, { s24, 1 }, static_cast<int>(std::size(x)));
+        const uint8_t max24[] = { 0xff, 0xff, 0x7f }, min24[] = { 0x00, 0x00, 0x80 };
+        CHECK(std::memcmp(s24, max24, 3) == 0 && std::memcmp(s24 + 3, min24, 3) == 0,
+              "Int24Packed output does not saturate");
+    }
+
+    // Dither: a constant 0.3 LSB comes out as -1/0/+1 LSB averaging 0.3,
+    // instead of a constant 0; silence() stays digital silence.
+    {
+        static constexpr int kDitherFrames = 8192;
+        std::vector<float>   x(kDitherFrames, 0.3f / 32768.f);
+        std::vector<int16_t> a(kDitherFrames), b(kDitherFrames);
+
+        hexcaster::PlaybackConverter pa, pb;
+        pa.setUp(SampleFormat::Int16, 1, true, 1);
+        pb.setUp(SampleFormat::Int16, 1, true, 2);
+        pa.convert(x.data(), { a.data(), 1 }, kDitherFrames);
+        pb.convert(x.data(), { b.data(), 1 }, kDitherFrames);
+
+        double sum = 0.0;
+        bool   inRange = true, differ = false;
+        for (int i = 0; i < kDitherFrames; ++i) {
+            sum     += a[static_cast<std::size_t>(i)];
+            inRange &= a[static_cast<std::size_t>(i)] >= -1 && a[static_cast<std::size_t>(i)] <= 1;
+            differ  |= a[static_cast<std::size_t>(i)] != b[static_cast<std::size_t>(i)];
+        }
+        CHECK(inRange, "TPDF dither exceeds +-1 LSB");
+        CHECK(std::fabs(sum / kDitherFrames - 0.3) < 0.05, "Dithered output does not average to the input");
+        CHECK(differ, "Different dither seeds give the same noise");
+
+        pa.silence({ a.data(), 1 }, kDitherFrames);
+        CHECK(std::all_of(a.begin(), a.end(), [](int16_t v) { return v == 0; }),
+              "silence() is not digital silence");
+    }
+
+    // Float32 passes through; Int32 capture scales by 2^-31.
+    {
+        hexcaster::CaptureConverter  c32;
+        hexcaster::PlaybackConverter pf;
+        c32.setUp(SampleFormat::Int32, 2);
+        pf.setUp(SampleFormat::Float32, 2, true);
+
+        const int32_t raw32[] = { 1 << 30, 0, INT32_MIN, 0 };
+        float         y[2];
+        c32.convert({ const_cast<int32_t*>(raw32), 2 }, y, 2);
+        CHECK(y[0] == 0.5f && y[1] == -1.f, "Int32 capture scaling is wrong");
+
+        const float x[] = { 1.25f, -0.125f };
+        float       f[4] = {};
+        pf.convert(x, { f, 2 }, 2);
+        CHECK(f[0] == 1.25f && f[2] == -0.125f, "Float32 playback is not a pass-through");
+    }
+
+    std::printf("testSampleConvert:     %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
 // ----------------------------------------------------------------------------
 
 int main()
@@ -122,7 +1759,29 @@ int main()
 
     testUnityPassthrough();
     testGainScaling();
+    testGainRamp();
     testParamRegistry();
+    testParallelRender();
+    testWavRoundTrip();
+    testPipelineStats();
+    testNamModelSwap();
+    testNamCrossfade();
+    testNamModelBank();
+    testDualAmp();
+    testPipelinedExecution();
+    testMicroBlocks();
+    testParametricEQ();
+    testToneEQ();
+    testMidSweepEQ();
+    testNoiseGate();
+    testGateLookahead();
+    testEnvelopeFollower();
+    testBloomController();
+    testStaticPipeline();
+    testIdentityBypass();
+    testMultichannel();
+    testChainScheduler();
+    testSampleConvert();
 
     std::printf("---\n");
     if (gFailures == 0) {
@@ -0,0 +1,203 @@
+#include "hexcaster/pipeline.h"
+#include "hexcaster/bloom_controller.h"
+#include "hexcaster/chain_scheduler.h"
+#include "hexcaster/eq.h"
+#include "hexcaster/gain_stage.h"
+#include "hexcaster/nam_stage.h"
+#include "hexcaster/noise_gate.h"
+#include "hexcaster/param_registry.h"
+#include "hexcaster/rt_sanitizer.h"
+#include "hexcaster/static_pipeline.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#ifndef HEXCASTER_TEST_MODELS_DIR
+#define HEXCASTER_TEST_MODELS_DIR "models"
+#endif
+
+// HEXCASTER_RT_SANITIZE builds only (see tests/CMakeLists.txt). Runs the
+// processing chains with the sanitizer interposed; any allocation, lock or
+// syscall inside an RtScope fails the test and prints its backtrace.
+
+static constexpr float kSampleRate = 48000.f;
+static constexpr int   kHostBlock  = 128;
+static constexpr int   kBlocks     = 2000;
+
+// Bursts, so the gate opens and closes and Bloom moves.
+static void fillBlock(float* block, int blockIndex)
+{
+    fillBursts(block, kHostBlock, blockIndex * kHostBlock, 440.f, 0.5f);
+}
+
+// Run-time checks must see clean chains, and clean chains must come from
+// the code, not from a sanitizer that sees nothing.
+static bool expectViolations(int expected, const char* what)
+{
+    const int count = hexcaster::rtsanViolationCount();
+    if (count != expected) {
+        std::fprintf(stderr, "%s: %d violation(s), expected %d\n", what, count, expected);
+        hexcaster::rtsanReport(stderr);
+    }
+    hexcaster::rtsanClear();
+    return count == expected;
+}
+
+// ----------------------------------------------------------------------------
+// Test: the sanitizer catches calls inside an RtScope, and only there.
+// ----------------------------------------------------------------------------
+static void testSanitizerCatches()
+{
+    // Through a volatile pointer so the allocation is not elided.
+    void* (*volatile allocate)(std::size_t) = std::malloc;
+
+    hexcaster::rtsanClear();
+    std::free(allocate(16));
+    CHECK(expectViolations(0, "outside a scope"), "Sanitizer counted a call outside an RtScope");
+
+    {
+        const hexcaster::RtScope scope;
+        CHECK(hexcaster::rtsanInScope(), "RtScope did not mark the thread");
+        std::free(allocate(16));                       // malloc + free
+        std::FILE* f = std::fopen("/dev/null", "r");   // fopen (+ its malloc, open)
+        if (f) std::fclose(f);
+    }
+    CHECK(!hexcaster::rtsanInScope(), "RtScope left the thread marked");
+    CHECK(hexcaster::rtsanViolationCount() >= 3, "Sanitizer missed malloc/free/fopen in an RtScope");
+    hexcaster::rtsanClear();
+
+    std::printf("testSanitizerCatches:  %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: gate -> gain -> EQ -> gain through Pipeline (with Bloom, micro-blocks
+// and auto-bypass) and StaticPipeline: no violations over many blocks,
+// parameter changes included.
+// ----------------------------------------------------------------------------
+static void testChainsAreClean()
+{
+    hexcaster::ParamRegistry params;
+
+    // Bloom drives the input gain (stage 1) and master (stage 3).
+    TestChain dyn;
+    hexcaster::Pipeline& pipeline = dyn.pipeline;
+    hexcaster::BloomController bloom(dyn.inputGain, dyn.master, 1, 3, params);
+    pipeline.addController(&bloom);
+    pipeline.setMicroBlockSize(32);
+    pipeline.setAutoBypass(true);
+    pipeline.prepare(kSampleRate, kHostBlock);
+    bloom.prepare(kSampleRate, pipeline.stageBlockSize());
+
+    TestChain fused;
+    auto&     chain = fused.staticPipeline;
+    chain.prepare(kSampleRate, kHostBlock);
+
+    hexcaster::rtsanClear();
+
+    float block[kHostBlock];
+    for (int b = 0; b < kBlocks; ++b) {
+        if (b % 250 == 0) {   // setters are audio-thread safe too
+            const float db = (b / 250) % 2 == 0 ? 6.f : 0.f;
+            const hexcaster::RtScope scope;
+            dyn.eq.setGainDb(db);
+            fused.eq.setGainDb(db);
+            fused.inputGain.setGainDb(-db);
+            params.set(hexcaster::ParamId::BloomPreDepth, db);
+        }
+        fillBlock(block, b);
+        pipeline.process(block, kHostBlock);
+        fillBlock(block, b);
+        chain.process(block, kHostBlock);
+    }
+
+    CHECK(expectViolations(0, "Pipeline/StaticPipeline"), "Processing chain is not real-time safe");
+
+    std::printf("testChainsAreClean:    %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: NamStage, including model swaps. Loading happens off the RT
+// thread; installing the loaded model (applyPendingModel) and the
+// crossfade are on it and must stay clean.
+// ----------------------------------------------------------------------------
+static void testNamStageIsClean()
+{
+    const std::string lstm    = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_lstm.nam";
+    const std::string wavenet = std::string(HEXCASTER_TEST_MODELS_DIR) + "/tiny_wavenet.nam";
+
+    hexcaster::NamStage nam;
+    nam.prepare(kSampleRate, kHostBlock);
+    CHECK(nam.loadModel(wavenet), "Failed to load tiny WaveNet model");
+
+    hexcaster::Pipeline pipeline;
+    pipeline.addStage(&nam);
+    pipeline.prepare(kSampleRate, kHostBlock);
+
+    hexcaster::rtsanClear();
+
+    float block[kHostBlock];
+    for (int b = 0; b < kBlocks / 4; ++b) {
+        if (b % 100 == 50) {
+            // Control thread, outside any scope.
+            CHECK(nam.loadModel((b / 100) % 2 == 0 ? lstm : wavenet), "Model swap failed to load");
+        }
+        fillBlock(block, b);
+        pipeline.process(block, kHostBlock);
+    }
+
+    CHECK(expectViolations(0, "NamStage"), "NamStage is not real-time safe");
+
+    std::printf("testNamStageIsClean:   %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+// ----------------------------------------------------------------------------
+// Test: ChainScheduler -- dispatch, the workers' chains and the join stay
+// clean, on the workers as well as the calling audio thread.
+// ----------------------------------------------------------------------------
+static void testSchedulerIsClean()
+{
+    static constexpr int kChains = 3;
+
+    static TestChain chains[kChains];
+    static float     blocks[kChains][kHostBlock];
+    for (TestChain& c : chains) c.staticPipeline.prepare(kSampleRate, kHostBlock);
+
+    hexcaster::ChainScheduler scheduler;
+    scheduler.setWorkerPriority(0);  // tests run unprivileged
+    scheduler.start(2, [](int j) { chains[j].staticPipeline.process(blocks[j], kHostBlock); });
+
+    hexcaster::rtsanClear();
+
+    for (int b = 0; b < kBlocks; ++b) {
+        for (int c = 0; c < kChains; ++c) fillBlock(blocks[c], b + c * 7);
+        const hexcaster::RtScope scope;   // the ALSA loop's scope
+        scheduler.run(kChains);
+    }
+    scheduler.stop();
+
+    CHECK(expectViolations(0, "ChainScheduler"), "ChainScheduler is not real-time safe");
+
+    std::printf("testSchedulerIsClean:  %s\n", gFailures == 0 ? "PASS" : "FAIL");
+}
+
+int main()
+{
+    std::printf("--- HexCaster RT sanitizer tests ---\n");
+
+    testSanitizerCatches();
+    testChainsAreClean();
+    testNamStageIsClean();
+    testSchedulerIsClean();
+
+    std::printf("---\n");
+    if (gFailures == 0) {
+        std::printf("All tests PASSED.\n");
+        return 0;
+    } else {
+        std::printf("%d test(s) FAILED.\n", gFailures);
+        return 1;
+    }
+}
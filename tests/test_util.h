@@ -0,0 +1,88 @@
+#pragma once
+
+// Shared by the test executables: the CHECK helper, test signals and the
+// gate -> gain -> EQ -> gain fixture most chain tests run.
+
+#include "hexcaster/pipeline.h"
+#include "hexcaster/eq.h"
+#include "hexcaster/gain_stage.h"
+#include "hexcaster/noise_gate.h"
+#include "hexcaster/static_pipeline.h"
+
+#include <cmath>
+#include <cstdio>
+
+// Simple assertion helper -- no external test framework.
+static int gFailures = 0;
+
+#define CHECK(expr, msg)                                                \
+    do {                                                                \
+        if (!(expr)) {                                                  \
+            std::fprintf(stderr, "FAIL [%s:%d]: %s\n",                 \
+                         __FILE__, __LINE__, msg);                      \
+            ++gFailures;                                                \
+        }                                                               \
+    } while (0)
+
+static constexpr float kTwoPi = 6.2831853f;
+
+// n samples of a hz sine (at 48 kHz) from stream position t0, in 50 ms
+// bursts: level, then offLevel, repeating. The bursts open and close a
+// gate; a non-zero offLevel leaves a hum that its closing ramp shapes.
+static inline void fillBursts(float* out, int n, int t0, float hz, float level, float offLevel = 0.f)
+{
+    for (int i = 0; i < n; ++i) {
+        const int t = t0 + i;
+        out[i] = ((t / 2400) % 2 == 0 ? level : offLevel)
+               * std::sin(kTwoPi * hz * static_cast<float>(t) / 48000.f);
+    }
+}
+
+// The standalone host's chain without the amp: gate -> input gain -> mid
+// EQ -> master. The same stages are wired into a Pipeline and a
+// StaticPipeline; a test prepares and runs one of the two.
+// Settings left alone keep the stages' defaults.
+struct TestChain {
+    struct Settings {
+        float gateThresholdDb = -60.f;
+        float gateReleaseMs   = 50.f;
+        float gateHoldMs      = 50.f;
+        float gateLookaheadMs = 0.f;
+        float inputGainDb     = 0.f;
+        float eqGainDb        = 0.f;
+        float eqSweepHz       = 1000.f;
+        float masterDb        = 0.f;
+    };
+
+    hexcaster::NoiseGate  gate;
+    hexcaster::GainStage  inputGain;
+    hexcaster::MidSweepEQ eq;
+    hexcaster::GainStage  master;
+
+    hexcaster::Pipeline pipeline;
+    hexcaster::StaticPipeline<hexcaster::NoiseGate, hexcaster::GainStage,
+                              hexcaster::MidSweepEQ, hexcaster::GainStage>
+        staticPipeline{ gate, inputGain, eq, master };
+
+    TestChain() : TestChain(Settings()) {}
+
+    explicit TestChain(const Settings& s)
+    {
+        gate.setThresholdDb(s.gateThresholdDb);
+        gate.setReleaseMs(s.gateReleaseMs);
+        gate.setHoldMs(s.gateHoldMs);
+        gate.setLookaheadMs(s.gateLookaheadMs);
+        inputGain.setGainDb(s.inputGainDb);
+        eq.setGainDb(s.eqGainDb);
+        eq.setSweepHz(s.eqSweepHz);
+        master.setGainDb(s.masterDb);
+
+        pipeline.addStage(&gate);
+        pipeline.addStage(&inputGain);
+        pipeline.addStage(&eq);
+        pipeline.addStage(&master);
+    }
+
+    TestChain(const TestChain&)            = delete;
+    TestChain& operator=(const TestChain&) = delete;
+};